@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace sds::Utilities
+{
+	/// <summary>
+	/// Activity driven polling delay policy, used by the input pollers.
+	///	Call Update() once per poll with whether the input changed since the last poll, then sleep for the returned delay.
+	///	Changing input snaps the delay to the fast (minimum) value, after a number of idle polls the delay
+	///	grows geometrically toward the slow (maximum) value.
+	///	The current delay is readable from any thread for telemetry.
+	/// </summary>
+	class AdaptivePollDelay
+	{
+		//fast and slow bounds packed into one atomic, min in the low half, so Update() never reads a min from one SetBounds() and a max from another
+		std::atomic<std::uint64_t> m_bounds_us;
+		std::atomic<size_t> m_current_us;
+		size_t m_idle_polls_before_decay;
+		size_t m_idle_count{ 0 };
+	public:
+		/// <param name="minDelayUs">delay in microseconds used while input is changing</param>
+		/// <param name="maxDelayUs">delay in microseconds the policy decays to while idle</param>
+		/// <param name="idlePollsBeforeDecay">number of unchanged polls before the delay starts growing</param>
+		AdaptivePollDelay(const size_t minDelayUs, const size_t maxDelayUs, const size_t idlePollsBeforeDecay) noexcept
+			: m_bounds_us(PackBounds(minDelayUs, maxDelayUs)),
+			m_current_us(UnpackBounds(m_bounds_us).second),
+			m_idle_polls_before_decay(idlePollsBeforeDecay)
+		{
+		}
+		AdaptivePollDelay(const AdaptivePollDelay& other) = delete;
+		AdaptivePollDelay(AdaptivePollDelay&& other) = delete;
+		AdaptivePollDelay& operator=(const AdaptivePollDelay& other) = delete;
+		AdaptivePollDelay& operator=(AdaptivePollDelay&& other) = delete;
+		~AdaptivePollDelay() = default;
+
+		/// <summary>Advances the policy by one poll.</summary>
+		/// <param name="isInputChanged">true if the polled input differed from the previous poll</param>
+		/// <returns>delay in microseconds to wait before the next poll</returns>
+		size_t Update(const bool isInputChanged) noexcept
+		{
+			const auto [minUs, maxUs] = UnpackBounds(m_bounds_us);
+			size_t current = m_current_us;
+			if (isInputChanged)
+			{
+				m_idle_count = 0;
+				current = minUs;
+			}
+			else if (m_idle_count < m_idle_polls_before_decay)
+			{
+				m_idle_count++;
+			}
+			else
+			{
+				//double the delay each idle poll past the hold period, bounded by the slow rate
+				current = std::min(current * 2, maxUs);
+			}
+			current = std::clamp(current, minUs, maxUs);
+			m_current_us = current;
+			return current;
+		}
+		/// <summary>Sets the fast and slow delay bounds, picked up on the next Update().</summary>
+		void SetBounds(const size_t minDelayUs, const size_t maxDelayUs) noexcept
+		{
+			m_bounds_us = PackBounds(minDelayUs, maxDelayUs);
+		}
+		/// <summary>Returns the delay, in microseconds, the poller is currently using.</summary>
+		[[nodiscard]] size_t GetCurrentDelay() const noexcept
+		{
+			return m_current_us;
+		}
+		/// <summary>Returns the current polling rate in polls per second.</summary>
+		[[nodiscard]] double GetCurrentRate() const noexcept
+		{
+			return 1'000'000.0 / static_cast<double>(GetCurrentDelay());
+		}
+		[[nodiscard]] size_t GetMinDelay() const noexcept
+		{
+			return UnpackBounds(m_bounds_us).first;
+		}
+		[[nodiscard]] size_t GetMaxDelay() const noexcept
+		{
+			return UnpackBounds(m_bounds_us).second;
+		}
+	private:
+		/// <summary>Normalises the bounds, min at least 1 and max at least min, and packs them into one value.</summary>
+		static std::uint64_t PackBounds(const size_t minDelayUs, const size_t maxDelayUs) noexcept
+		{
+			constexpr size_t LargestUs = UINT32_MAX;
+			const size_t minUs = std::clamp<size_t>(minDelayUs, 1, LargestUs);
+			const size_t maxUs = std::clamp<size_t>(maxDelayUs, minUs, LargestUs);
+			return (static_cast<std::uint64_t>(maxUs) << 32) | static_cast<std::uint64_t>(minUs);
+		}
+		static std::pair<size_t, size_t> UnpackBounds(const std::uint64_t bounds) noexcept
+		{
+			return { static_cast<size_t>(bounds & UINT32_MAX), static_cast<size_t>(bounds >> 32) };
+		}
+	};
+}
@@ -0,0 +1,268 @@
+#pragma once
+#include "stdafx.h"
+#include "XELog.h"
+#include "CPPRunnerGeneric.h"
+
+namespace sds::Utilities
+{
+	/// <summary>Message ids for AsyncLogger, one per logging site. The text for each is in GetLogMessageText().</summary>
+	enum class LogMessageId : std::uint16_t
+	{
+		KEYSTROKE_BUFFER_DROP = 0,
+		STATE_FEED_BUFFER_DROP,
+		SEND_INPUT_FAILED,
+		NUMLOCK_DOWN_FAILED,
+		NUMLOCK_UP_FAILED,
+		BAD_SENSITIVITY_INDEX,
+		BAD_MAPPED_VALUE,
+		UINPUT_SETUP_FAILED,
+		UINPUT_WRITE_FAILED,
+		COUNT
+	};
+	/// <summary>Format string for each message id, "{}" fields are filled with the record's arguments in order.</summary>
+	[[nodiscard]] constexpr std::string_view GetLogMessageText(const LogMessageId id) noexcept
+	{
+		switch (id)
+		{
+		case LogMessageId::KEYSTROKE_BUFFER_DROP: return "KeyboardInputPoller::addElement(): State buffer dropping states.";
+		case LogMessageId::STATE_FEED_BUFFER_DROP: return "KeyboardInputPoller::FeedState(): State buffer dropping states.";
+		case LogMessageId::SEND_INPUT_FAILED: return "SendInput returned 0, GetLastError(): {}";
+		case LogMessageId::NUMLOCK_DOWN_FAILED: return "Error sending numlock keypress down.";
+		case LogMessageId::NUMLOCK_UP_FAILED: return "Error sending numlock keypress up.";
+		case LogMessageId::BAD_SENSITIVITY_INDEX: return "ThumbstickToDelay::GetMappedValue(): Index {} outside the sensitivity table of size {}.";
+		case LogMessageId::BAD_MAPPED_VALUE: return "ThumbstickToDelay::GetMappedValue(): Failed to acquire mapped value with key: {}";
+		case LogMessageId::UINPUT_SETUP_FAILED: return "SendUinput: Creating the uinput device failed, errno: {}";
+		case LogMessageId::UINPUT_WRITE_FAILED: return "SendUinput::Flush(): write() failed, errno: {}, events: {}";
+		default: return "AsyncLogger: Unknown message id {}.";
+		}
+	}
+
+	/// <summary>
+	/// Logger for hot paths, logging a message is a message id and two integer arguments written to a fixed size
+	///	lock-free ring buffer, the text is formatted and written out later by a background sink thread.
+	///	Each message id is rate limited, messages logged sooner than the rate limit after the last one are counted
+	///	as suppressed, and messages logged while the ring buffer is full are counted as dropped.
+	///	Both counts are reported by the sink. Log() doesn't allocate, block or throw.
+	///	Use for errors that can repeat at the polling rate, LogError() remains for one-off errors on cold paths.
+	/// </summary>
+	class AsyncLogger
+	{
+	public:
+		using SinkType = std::function<void(std::string_view)>;
+		using ClockType = std::chrono::steady_clock;
+		static constexpr size_t BUFFER_CAPACITY{ 1024 }; // power of two
+		static constexpr size_t MESSAGE_ID_COUNT{ static_cast<size_t>(LogMessageId::COUNT) };
+		static constexpr std::chrono::microseconds DEFAULT_RATE_LIMIT{ 1'000'000 }; // per message id
+		static constexpr std::chrono::milliseconds SINK_INTERVAL{ 10 };
+		static_assert((BUFFER_CAPACITY & (BUFFER_CAPACITY - 1)) == 0, "BUFFER_CAPACITY must be a power of two.");
+		struct LogRecord
+		{
+			LogMessageId Id{};
+			std::int64_t Arg1{};
+			std::int64_t Arg2{};
+		};
+	private:
+		using InternalType = int;
+		using LambdaRunnerType = sds::CPPRunnerGeneric<InternalType>;
+		//Bounded multi-producer queue cell, the sequence number tells producers and the consumer whose turn it is.
+		struct Cell
+		{
+			std::atomic<size_t> Sequence{ 0 };
+			LogRecord Record{};
+		};
+		struct SiteCounters
+		{
+			std::atomic<ClockType::rep> NextAllowed{ 0 };
+			std::atomic<std::uint64_t> Suppressed{ 0 };
+			std::atomic<std::uint64_t> Dropped{ 0 };
+		};
+		std::array<Cell, BUFFER_CAPACITY> m_cells{};
+		alignas(64) std::atomic<size_t> m_enqueue_pos{ 0 };
+		alignas(64) size_t m_dequeue_pos{ 0 }; // sink thread only
+		std::array<SiteCounters, MESSAGE_ID_COUNT> m_sites{};
+		//counts already reported, sink thread only
+		std::array<std::uint64_t, MESSAGE_ID_COUNT> m_reported_suppressed{};
+		std::array<std::uint64_t, MESSAGE_ID_COUNT> m_reported_dropped{};
+		const SinkType m_sink;
+		const ClockType::rep m_rate_limit_ticks;
+		std::unique_ptr<LambdaRunnerType> m_workThread{};
+		void InitWorkThread() noexcept
+		{
+			m_workThread =
+				std::make_unique<LambdaRunnerType>
+				([this](const sds::LambdaArgs::LambdaArg1& stopCondition, sds::LambdaArgs::LambdaArg2& mut, auto& protectedData) { workThread(stopCondition, mut, protectedData); });
+		}
+	public:
+		/// <param name="sink">receives each formatted message on the sink thread, LogError() by default</param>
+		/// <param name="rateLimit">minimum time between two messages with the same id, zero for no limit</param>
+		explicit AsyncLogger(SinkType sink = [](std::string_view s) { LogError(s); }, const std::chrono::microseconds rateLimit = DEFAULT_RATE_LIMIT)
+			: m_sink(std::move(sink)), m_rate_limit_ticks(std::chrono::duration_cast<ClockType::duration>(rateLimit).count())
+		{
+			for (size_t i = 0; i < m_cells.size(); i++)
+				m_cells[i].Sequence.store(i, std::memory_order_relaxed);
+			InitWorkThread();
+			m_workThread->StartThread();
+		}
+		AsyncLogger(const AsyncLogger& other) = delete;
+		AsyncLogger(AsyncLogger&& other) = delete;
+		AsyncLogger& operator=(const AsyncLogger& other) = delete;
+		AsyncLogger& operator=(AsyncLogger&& other) = delete;
+		/// <summary>Stops the sink thread, after it writes out the messages remaining in the buffer.</summary>
+		~AsyncLogger()
+		{
+			Stop();
+		}
+		/// <summary>Records a message for the sink thread, or counts it as suppressed or dropped. Callable from any thread.</summary>
+		void Log(const LogMessageId id, const std::int64_t arg1 = 0, const std::int64_t arg2 = 0) noexcept
+		{
+			const auto index = static_cast<size_t>(id);
+			if (index >= MESSAGE_ID_COUNT)
+				return;
+			SiteCounters& site = m_sites[index];
+			if (m_rate_limit_ticks > 0)
+			{
+				const auto now = ClockType::now().time_since_epoch().count();
+				auto nextAllowed = site.NextAllowed.load(std::memory_order_relaxed);
+				if (now < nextAllowed || !site.NextAllowed.compare_exchange_strong(nextAllowed, now + m_rate_limit_ticks, std::memory_order_relaxed))
+				{
+					site.Suppressed.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+			}
+			if (!TryPush(LogRecord{ id, arg1, arg2 }))
+				site.Dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+		/// <summary>Total messages with the id not recorded because of the rate limit.</summary>
+		[[nodiscard]] std::uint64_t GetSuppressedCount(const LogMessageId id) const noexcept
+		{
+			const auto index = static_cast<size_t>(id);
+			return index < MESSAGE_ID_COUNT ? m_sites[index].Suppressed.load(std::memory_order_relaxed) : 0;
+		}
+		/// <summary>Total messages with the id not recorded because the buffer was full.</summary>
+		[[nodiscard]] std::uint64_t GetDroppedCount(const LogMessageId id) const noexcept
+		{
+			const auto index = static_cast<size_t>(id);
+			return index < MESSAGE_ID_COUNT ? m_sites[index].Dropped.load(std::memory_order_relaxed) : 0;
+		}
+		/// <summary>Starts the sink thread, messages logged while it is stopped are kept in the buffer.</summary>
+		void Start() const noexcept
+		{
+			m_workThread->StartThread();
+		}
+		void Stop() const noexcept
+		{
+			m_workThread->StopThread();
+		}
+		[[nodiscard]] bool IsRunning() const noexcept
+		{
+			return m_workThread->IsRunning();
+		}
+	protected:
+		/// <summary>Sink thread, drains the buffer every SINK_INTERVAL, and once more when stopping, with the suppressed counts not reported yet.</summary>
+		void workThread(const sds::LambdaArgs::LambdaArg1& stopCondition, sds::LambdaArgs::LambdaArg2&, InternalType&)
+		{
+			while (!stopCondition)
+			{
+				Drain();
+				std::this_thread::sleep_for(SINK_INTERVAL);
+			}
+			Drain(true);
+		}
+	private:
+		bool TryPush(const LogRecord& record) noexcept
+		{
+			size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+			Cell* cell;
+			for (;;)
+			{
+				cell = &m_cells[pos & (BUFFER_CAPACITY - 1)];
+				const size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+				const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+				if (diff == 0)
+				{
+					if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (diff < 0)
+					return false; // full
+				else
+					pos = m_enqueue_pos.load(std::memory_order_relaxed);
+			}
+			cell->Record = record;
+			cell->Sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+		bool TryPop(LogRecord& record) noexcept
+		{
+			Cell& cell = m_cells[m_dequeue_pos & (BUFFER_CAPACITY - 1)];
+			if (cell.Sequence.load(std::memory_order_acquire) != m_dequeue_pos + 1)
+				return false;
+			record = cell.Record;
+			cell.Sequence.store(m_dequeue_pos + BUFFER_CAPACITY, std::memory_order_release);
+			m_dequeue_pos++;
+			return true;
+		}
+		/// <summary>Fills the "{}" fields of the message text with the record's arguments, in order.</summary>
+		[[nodiscard]] static std::string FormatRecord(const LogRecord& record)
+		{
+			const std::string_view text = GetLogMessageText(record.Id);
+			const std::array<std::int64_t, 2> args{ record.Arg1, record.Arg2 };
+			std::string result;
+			size_t argIndex = 0;
+			size_t pos = 0;
+			for (size_t field = text.find("{}"); field != std::string_view::npos; field = text.find("{}", pos))
+			{
+				result += text.substr(pos, field - pos);
+				result += argIndex < args.size() ? std::to_string(args[argIndex++]) : "{}";
+				pos = field + 2;
+			}
+			result += text.substr(pos);
+			return result;
+		}
+		/// <summary>Formats and writes out the buffered messages, then any new drop counts. Sink thread only.</summary>
+		/// <param name="isFinal">true to also write out suppressed counts, which are otherwise appended to the next message with the id</param>
+		void Drain(const bool isFinal = false)
+		{
+			LogRecord record;
+			while (TryPop(record))
+			{
+				const auto index = static_cast<size_t>(record.Id);
+				std::string text = FormatRecord(record);
+				const std::uint64_t suppressed = m_sites[index].Suppressed.load(std::memory_order_relaxed);
+				if (suppressed != m_reported_suppressed[index])
+				{
+					text += " (" + std::to_string(suppressed - m_reported_suppressed[index]) + " similar messages suppressed)";
+					m_reported_suppressed[index] = suppressed;
+				}
+				m_sink(text);
+			}
+			for (size_t i = 0; i < MESSAGE_ID_COUNT; i++)
+			{
+				const std::uint64_t dropped = m_sites[i].Dropped.load(std::memory_order_relaxed);
+				if (dropped != m_reported_dropped[i])
+				{
+					m_sink("AsyncLogger: " + std::to_string(dropped - m_reported_dropped[i]) + " messages dropped, buffer full. Message id " + std::to_string(i) + ".");
+					m_reported_dropped[i] = dropped;
+				}
+				const std::uint64_t suppressed = m_sites[i].Suppressed.load(std::memory_order_relaxed);
+				if (isFinal && suppressed != m_reported_suppressed[i])
+				{
+					m_sink("AsyncLogger: " + std::to_string(suppressed - m_reported_suppressed[i]) + " similar messages suppressed. Message id " + std::to_string(i) + ".");
+					m_reported_suppressed[i] = suppressed;
+				}
+			}
+		}
+	};
+
+	/// <summary>The process wide AsyncLogger, created with its sink thread on first use.</summary>
+	[[nodiscard]] inline AsyncLogger& GetAsyncLogger()
+	{
+		static AsyncLogger logger;
+		return logger;
+	}
+	/// <summary>Logs a message on the process wide AsyncLogger, see AsyncLogger::Log().</summary>
+	inline void LogAsync(const LogMessageId id, const std::int64_t arg1 = 0, const std::int64_t arg2 = 0) noexcept
+	{
+		GetAsyncLogger().Log(id, arg1, arg2);
+	}
+}
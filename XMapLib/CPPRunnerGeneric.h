@@ -1,7 +1,9 @@
 ﻿#pragma once
 #include "stdafx.h"
+#include "ThreadPolicy.h"
 #include <ranges>
 #include <concepts>
+#include <condition_variable>
 namespace sds
 {
 	/// <summary>Contains using declarations for first two args of the user-supplied lambda function.</summary>
@@ -14,6 +16,8 @@ namespace sds
 	///	as well as stopping and starting the running thread.
 	///	If you want to use this class, make a function (or lambda function) with parameters
 	///	of the form [void] function_name( const LambdaArgs::LambdaArg1 stopCondition, LambdaArgs::LambdaArg2 theMutex, UserType protectedDataYouWantToAccess )
+	///	The thread is created by the first StartThread() and kept until destruction, when stopped it parks on a condition variable,
+	///	so stopping and starting again costs a wakeup instead of a thread creation and join.
 	/// </summary>
 	template<typename InternalData>
 	requires std::is_default_constructible_v<InternalData>
@@ -31,62 +35,96 @@ namespace sds
 		~CPPRunnerGeneric()
 		{
 			StopThread();
+			{
+				std::lock_guard runLock(m_run_mutex);
+				m_is_exiting = true;
+			}
+			m_run_cv.notify_all();
+			if (m_local_thread != nullptr && m_local_thread->joinable())
+				m_local_thread->join();
 			ScopedLockType tempLock(this->m_state_mutex);
 		}
 	protected:
 		const LambdaType m_lambda;
 		InternalData m_local_state{}; // default constructed type InternalData
 		std::atomic<bool> m_is_stop_requested{ false };
+		std::atomic<bool> m_is_active{ false }; // between a StartThread() and a stop
 		std::unique_ptr<std::thread> m_local_thread{};
 		std::mutex m_state_mutex{};
+		//Run control of the parked thread, and the policy applied when it runs, guarded by m_run_mutex.
+		mutable std::mutex m_run_mutex{};
+		Utilities::ThreadPolicy m_thread_policy{};
+		std::condition_variable m_run_cv{};
+		bool m_is_run_requested{ false };
+		bool m_is_lambda_running{ false };
+		bool m_is_exiting{ false };
+		Utilities::ThreadPolicy m_run_policy{};
 	public:
-		/// <summary>Starts running a new thread for the lambda.</summary>
-		///	<returns>true on success, false on failure.</returns>
+		/// <summary>Starts running the lambda on the thread, creating the thread on first use and waking it after.
+		///	After a RequestStop(), blocks until the running lambda has returned, then runs it again.</summary>
+		///	<returns>true on success, false on failure or if already running.</returns>
 		bool StartThread() noexcept
 		{
-			if (m_local_thread != nullptr)
+			std::unique_lock runLock(m_run_mutex);
+			if ((m_is_lambda_running || m_is_run_requested) && !m_is_stop_requested)
 				return false;
+			m_run_cv.wait(runLock, [this]() { return !m_is_run_requested && !m_is_lambda_running; });
 			m_is_stop_requested = false;
-			m_local_thread = std::make_unique<std::thread>(m_lambda, std::cref(m_is_stop_requested), std::ref(m_state_mutex), std::ref(m_local_state));
-			return m_local_thread->joinable();
+			m_is_run_requested = true;
+			m_run_policy = m_thread_policy;
+			m_is_active = true;
+			if (m_local_thread == nullptr)
+			{
+				try
+				{
+					m_local_thread = std::make_unique<std::thread>([this]() { ParkedLoop(); });
+				}
+				catch (const std::exception& e)
+				{
+					Utilities::LogError(std::string("CPPRunnerGeneric::StartThread(): ") + e.what());
+					m_is_run_requested = false;
+					m_is_active = false;
+					return false;
+				}
+			}
+			runLock.unlock();
+			m_run_cv.notify_all();
+			return true;
+		}
+		/// <summary>Sets the scheduling policy applied to the thread, takes effect the next time the thread is started.</summary>
+		void SetThreadPolicy(const Utilities::ThreadPolicy& policy)
+		{
+			std::lock_guard runLock(m_run_mutex);
+			m_thread_policy = policy;
+		}
+		[[nodiscard]] Utilities::ThreadPolicy GetThreadPolicy() const
+		{
+			std::lock_guard runLock(m_run_mutex);
+			return m_thread_policy;
 		}
 		/// <summary>Returns true if thread is running.</summary>
 		bool IsRunning() const noexcept
 		{
-			if (m_local_thread != nullptr)
-				return m_local_thread->joinable() && !m_is_stop_requested;
-			return false;
+			return m_is_active && !m_is_stop_requested;
 		}
-		/// <summary>Non-blocking way to stop a running thread.</summary>
+		/// <summary>Non-blocking way to stop a running thread, the lambda returns on its own and the thread parks.
+		///	A StartThread() before the lambda has returned blocks until it does.</summary>
 		void RequestStop() noexcept
 		{
 			//Get this setting out of the way.
 			this->m_is_stop_requested = true;
-			//If there is a thread obj..
-			if (this->m_local_thread != nullptr)
-			{
-				this->m_local_thread->detach();
-				this->m_local_thread.reset();
-			}
+			this->m_is_active = false;
 		}
-		/// <summary>Blocking way to stop a running thread, joins to current thread and waits.</summary>
+		/// <summary>Blocking way to stop a running thread, waits for the lambda to return, the thread is parked, not joined.
+		///	A started lambda always runs, if it has not been picked up by the thread yet it runs with the stop already requested.
+		///	Must not be called from the lambda.</summary>
 		void StopThread() noexcept
 		{
 			//Get this setting out of the way.
 			this->m_is_stop_requested = true;
-			//If there is a thread obj..
-			if (this->m_local_thread != nullptr)
-			{
-				if (this->m_local_thread->joinable())
-				{
-					//join to wait for thread to stop, then reset to a nullptr.
-					this->m_local_thread->join();
-					this->m_local_thread.reset();
-				}
-				else
-					//if it is not joinable, set to nullptr
-					this->m_local_thread.reset();
-			}
+			this->m_is_active = false;
+			std::unique_lock runLock(m_run_mutex);
+			m_run_cv.wait(runLock, [this]() { return !m_is_run_requested && !m_is_lambda_running; });
 		}
 		/// <summary>Container type function, adds an element to say, a vector.</summary>
 		void AddState(const auto& state) requires std::ranges::range<InternalData>
@@ -94,14 +132,43 @@ namespace sds
 			ScopedLockType tempLock(this->m_state_mutex);
 			this->m_local_state.push_back(state);
 		}
-		/// <summary>Container type function, returns copy and clears internal one.</summary>
-		auto GetAndClearCurrentStates() requires std::ranges::range<InternalData>
+		/// <summary>Container type function, adds an element if the container holds fewer than maxCount elements.</summary>
+		/// <returns>true if added, false if the container is full.</returns>
+		bool TryAddState(const auto& state, const size_t maxCount) requires std::ranges::sized_range<InternalData>
 		{
 			ScopedLockType tempLock(this->m_state_mutex);
-			auto temp = this->m_local_state;
-			this->m_local_state.clear();
+			if (std::ranges::size(this->m_local_state) >= maxCount)
+				return false;
+			this->m_local_state.push_back(state);
+			return true;
+		}
+		/// <summary>Container type function, returns the internal container and leaves an empty one.
+		///	The lock is only held for the swap, the internal storage is handed out rather than copied,
+		///	prefer the overload taking a buffer to keep reusing the storage of both.</summary>
+		auto GetAndClearCurrentStates() requires std::ranges::range<InternalData>
+		{
+			InternalData temp{};
+			{
+				ScopedLockType tempLock(this->m_state_mutex);
+				std::swap(temp, this->m_local_state);
+			}
 			return temp;
 		}
+		/// <summary>Container type function, swaps the internal container with the cleared one given,
+		///	so both buffers keep their storage and no allocation is made once they have grown.</summary>
+		/// <param name="out">receives the elements, its previous contents are discarded</param>
+		void GetAndClearCurrentStates(InternalData& out) requires std::ranges::range<InternalData>
+		{
+			out.clear();
+			ScopedLockType tempLock(this->m_state_mutex);
+			std::swap(out, this->m_local_state);
+		}
+		/// <summary>Container type function, reserves storage in the internal container.</summary>
+		void ReserveStates(const size_t count) requires requires(InternalData d) { d.reserve(count); }
+		{
+			ScopedLockType tempLock(this->m_state_mutex);
+			this->m_local_state.reserve(count);
+		}
 		/// <summary>Utility function to update the InternalData with mutex locking thread safety.</summary>
 		/// <param name="state">InternalData obj to be copied to the internal one.</param>
 		void UpdateState(const InternalData& state)
@@ -115,5 +182,35 @@ namespace sds
 			ScopedLockType tempLock(this->m_state_mutex);
 			return this->m_local_state;
 		}
+	private:
+		/// <summary>The thread body, waits for a run request, applies the policy and runs the lambda, until destruction.
+		///	The policy is only applied when it has changed, what it set stays in effect until another policy is applied.</summary>
+		void ParkedLoop()
+		{
+			Utilities::ThreadPolicy applied{};
+			std::unique_lock runLock(m_run_mutex);
+			for (;;)
+			{
+				m_run_cv.wait(runLock, [this]() { return m_is_run_requested || m_is_exiting; });
+				if (m_is_exiting)
+					return;
+				m_is_run_requested = false;
+				m_is_lambda_running = true;
+				const Utilities::ThreadPolicy policy = m_run_policy;
+				runLock.unlock();
+				//the policy is applied by the thread itself, before running the lambda
+				if (policy != applied)
+				{
+					const std::string er = policy.ApplyToCurrentThread();
+					if (!er.empty())
+						Utilities::LogError(er);
+					applied = policy;
+				}
+				m_lambda(m_is_stop_requested, m_state_mutex, m_local_state);
+				runLock.lock();
+				m_is_lambda_running = false;
+				m_run_cv.notify_all();
+			}
+		}
 	};
 }
@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace sds::Utilities
+{
+	/// <summary>
+	/// Multiple producer, single consumer queue of commands, used to apply configuration changes on the worker thread
+	///	owning the state they change, instead of stopping the worker or locking the state.
+	///	Any thread may Post(), only the owning worker thread may Drain(), which runs the commands in posting order.
+	///	Lock-free intrusive linked list (Vyukov), a push is one allocation and an atomic exchange,
+	///	an empty Drain() is two loads, cheap enough for the top of every tick.
+	/// </summary>
+	class CommandQueue
+	{
+	public:
+		using CommandType = std::function<void()>;
+	private:
+		struct Node
+		{
+			CommandType Command{};
+			std::atomic<Node*> Next{ nullptr };
+		};
+		Node m_stub{};
+		std::atomic<Node*> m_head{ &m_stub }; // most recently pushed, producers
+		Node* m_tail{ &m_stub }; // next to pop, consumer only
+		std::atomic<size_t> m_posted_count{ 0 };
+	public:
+		CommandQueue() = default;
+		CommandQueue(const CommandQueue& other) = delete;
+		CommandQueue(CommandQueue&& other) = delete;
+		CommandQueue& operator=(const CommandQueue& other) = delete;
+		CommandQueue& operator=(CommandQueue&& other) = delete;
+		/// <summary>Commands not yet drained are destroyed without running.</summary>
+		~CommandQueue()
+		{
+			while (std::unique_ptr<Node> node{ Pop() }) { }
+		}
+		/// <summary>Queues a command for the next Drain(), callable from any thread.</summary>
+		void Post(CommandType command)
+		{
+			auto node = std::make_unique<Node>();
+			node->Command = std::move(command);
+			Push(node.release());
+			m_posted_count.fetch_add(1, std::memory_order_relaxed);
+		}
+		/// <summary>Runs the commands posted so far, in order, consumer thread only.
+		///	A command posted while draining may run now or on the next Drain().</summary>
+		/// <returns>the number of commands run</returns>
+		size_t Drain()
+		{
+			size_t count = 0;
+			while (std::unique_ptr<Node> node{ Pop() })
+			{
+				if (node->Command)
+					node->Command();
+				count++;
+			}
+			return count;
+		}
+		/// <summary>Telemetry, the number of commands posted so far.</summary>
+		[[nodiscard]] size_t GetPostedCount() const noexcept
+		{
+			return m_posted_count.load(std::memory_order_relaxed);
+		}
+	private:
+		void Push(Node* node) noexcept
+		{
+			node->Next.store(nullptr, std::memory_order_relaxed);
+			Node* previous = m_head.exchange(node, std::memory_order_acq_rel);
+			previous->Next.store(node, std::memory_order_release);
+		}
+		/// <returns>the oldest node, owned by the caller, or nullptr if empty, or if the oldest push is not complete yet.</returns>
+		[[nodiscard]] Node* Pop() noexcept
+		{
+			Node* tail = m_tail;
+			Node* next = tail->Next.load(std::memory_order_acquire);
+			if (tail == &m_stub)
+			{
+				if (next == nullptr)
+					return nullptr;
+				m_tail = next;
+				tail = next;
+				next = next->Next.load(std::memory_order_acquire);
+			}
+			if (next != nullptr)
+			{
+				m_tail = next;
+				return tail;
+			}
+			//tail is the last node, a producer may be between its exchange and its link
+			if (tail != m_head.load(std::memory_order_acquire))
+				return nullptr;
+			//put the stub back behind the last node, so the last node can be handed out
+			Push(&m_stub);
+			next = tail->Next.load(std::memory_order_acquire);
+			if (next != nullptr)
+			{
+				m_tail = next;
+				return tail;
+			}
+			return nullptr;
+		}
+	};
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+#include <bit>
+
+namespace sds
+{
+	/// <summary>
+	/// Fixed-width bitmask layout for the complete digital state of a controller.
+	///	Bits 0-15 are the XINPUT_GAMEPAD wButtons bits verbatim, followed by the two trigger thresholds
+	///	and the 8-way direction of each thumbstick. Every set bit corresponds to one VK_PAD_* virtual key,
+	///	the same codes XInputGetKeystroke() reports.
+	/// </summary>
+	struct ControllerBits
+	{
+		using MaskType = std::uint64_t;
+		//Number of bits taken by the XINPUT_GAMEPAD wButtons member.
+		static constexpr int BUTTON_BIT_COUNT{ 16 };
+		static constexpr int LTRIGGER_BIT{ 16 };
+		static constexpr int RTRIGGER_BIT{ 17 };
+		//First of 8 direction bits for each thumbstick, in KeyboardSettings::THUMBSTICK_*_VK_LIST order.
+		static constexpr int LTHUMB_FIRST_BIT{ 18 };
+		static constexpr int RTHUMB_FIRST_BIT{ LTHUMB_FIRST_BIT + 8 };
+		//Number of bits in use, the remaining upper bits are free for synthesized inputs.
+		static constexpr int USED_BIT_COUNT{ RTHUMB_FIRST_BIT + 8 };
+		static constexpr int MAX_BIT_COUNT{ std::numeric_limits<MaskType>::digits };
+		static constexpr MaskType BUTTONS_MASK{ 0xFFFF };
+		static constexpr MaskType LTHUMB_MASK{ MaskType{ 0xFF } << LTHUMB_FIRST_BIT };
+		static constexpr MaskType RTHUMB_MASK{ MaskType{ 0xFF } << RTHUMB_FIRST_BIT };
+		static constexpr MaskType USED_MASK{ (MaskType{ 1 } << USED_BIT_COUNT) - 1 };
+		//Virtual key of the first bit above USED_BIT_COUNT, such bits are synthesized inputs (like chords)
+		//and are given consecutive virtual keys outside of the VK_PAD_* range.
+		static constexpr int SYNTHESIZED_VK_FIRST{ 0x5900 };
+		static constexpr int SYNTHESIZED_BIT_COUNT{ MAX_BIT_COUNT - USED_BIT_COUNT };
+		//Bit index to VK_PAD_* virtual key, 0 for an unused bit.
+		static constexpr std::array<int, MAX_BIT_COUNT> BIT_TO_VK
+		{
+			VK_PAD_DPAD_UP, VK_PAD_DPAD_DOWN, VK_PAD_DPAD_LEFT, VK_PAD_DPAD_RIGHT,
+			VK_PAD_START, VK_PAD_BACK, VK_PAD_LTHUMB_PRESS, VK_PAD_RTHUMB_PRESS,
+			VK_PAD_LSHOULDER, VK_PAD_RSHOULDER, 0, 0,
+			VK_PAD_A, VK_PAD_B, VK_PAD_X, VK_PAD_Y,
+			VK_PAD_LTRIGGER, VK_PAD_RTRIGGER,
+			VK_PAD_LTHUMB_UP, VK_PAD_LTHUMB_DOWN, VK_PAD_LTHUMB_RIGHT, VK_PAD_LTHUMB_LEFT,
+			VK_PAD_LTHUMB_UPLEFT, VK_PAD_LTHUMB_UPRIGHT, VK_PAD_LTHUMB_DOWNRIGHT, VK_PAD_LTHUMB_DOWNLEFT,
+			VK_PAD_RTHUMB_UP, VK_PAD_RTHUMB_DOWN, VK_PAD_RTHUMB_RIGHT, VK_PAD_RTHUMB_LEFT,
+			VK_PAD_RTHUMB_UPLEFT, VK_PAD_RTHUMB_UPRIGHT, VK_PAD_RTHUMB_DOWNRIGHT, VK_PAD_RTHUMB_DOWNLEFT
+		};
+		/// <summary>Thumbstick direction offsets from the first direction bit of a stick.</summary>
+		enum class StickDirection : int
+		{
+			UP = 0,
+			DOWN = 1,
+			RIGHT = 2,
+			LEFT = 3,
+			UPLEFT = 4,
+			UPRIGHT = 5,
+			DOWNRIGHT = 6,
+			DOWNLEFT = 7
+		};
+		/// <summary>Returns the VK_PAD_* (or synthesized) virtual key for a bit index, or 0 if the bit is unused or out of range.</summary>
+		[[nodiscard]] static constexpr int GetVirtualKey(const int bitIndex) noexcept
+		{
+			if (bitIndex < 0 || bitIndex >= MAX_BIT_COUNT)
+				return 0;
+			if (bitIndex >= USED_BIT_COUNT)
+				return SYNTHESIZED_VK_FIRST + (bitIndex - USED_BIT_COUNT);
+			return BIT_TO_VK[static_cast<size_t>(bitIndex)];
+		}
+		/// <summary>Returns the bit index for a VK_PAD_* (or synthesized) virtual key, or -1 if the key has no bit.</summary>
+		[[nodiscard]] static constexpr int GetBitIndex(const int virtualKey) noexcept
+		{
+			if (virtualKey == 0)
+				return -1;
+			if (virtualKey >= SYNTHESIZED_VK_FIRST && virtualKey < SYNTHESIZED_VK_FIRST + SYNTHESIZED_BIT_COUNT)
+				return USED_BIT_COUNT + (virtualKey - SYNTHESIZED_VK_FIRST);
+			for (size_t i = 0; i < BIT_TO_VK.size(); i++)
+			{
+				if (BIT_TO_VK[i] == virtualKey)
+					return static_cast<int>(i);
+			}
+			return -1;
+		}
+		/// <summary>Returns the single bit mask for a bit index, or 0 if out of range.</summary>
+		[[nodiscard]] static constexpr MaskType ToMask(const int bitIndex) noexcept
+		{
+			if (bitIndex < 0 || bitIndex >= MAX_BIT_COUNT)
+				return 0;
+			return MaskType{ 1 } << bitIndex;
+		}
+		static_assert(USED_BIT_COUNT <= MAX_BIT_COUNT);
+	};
+	static_assert(ControllerBits::GetBitIndex(VK_PAD_RTHUMB_DOWNLEFT) == ControllerBits::USED_BIT_COUNT - 1);
+
+	/// <summary>
+	/// Press and release edges between two controller bitmasks, computed with a single XOR.
+	/// </summary>
+	struct ControllerStateDiff
+	{
+		using MaskType = ControllerBits::MaskType;
+		MaskType Previous{ 0 };
+		MaskType Current{ 0 };
+		MaskType Pressed{ 0 };
+		MaskType Released{ 0 };
+		[[nodiscard]] static constexpr ControllerStateDiff Build(const MaskType previous, const MaskType current) noexcept
+		{
+			const MaskType changed = previous ^ current;
+			return ControllerStateDiff{ previous, current, changed & current, changed & previous };
+		}
+		[[nodiscard]] constexpr bool IsChanged() const noexcept
+		{
+			return (Pressed | Released) != 0;
+		}
+	};
+}
@@ -6,7 +6,10 @@ namespace sds::Utilities
 {
 	class DelayManager
 	{
+	public:
+		/// <summary>Time points of the system clock, or of a VirtualClock, given to the overloads taking the current time.</summary>
 		using TimeType = std::chrono::time_point<std::chrono::high_resolution_clock>;
+	private:
 		TimeType m_start_time{ std::chrono::high_resolution_clock::now() };
 		size_t m_duration{ 1 };
 		bool m_has_fired{ false };
@@ -14,6 +17,9 @@ namespace sds::Utilities
 		//us is microseconds
 		DelayManager() = delete;
 		explicit DelayManager(size_t duration_us) : m_duration(duration_us) { }
+		/// <param name="duration_us">delay in microseconds</param>
+		/// <param name="startTime">time the delay starts at</param>
+		DelayManager(size_t duration_us, const TimeType startTime) : m_start_time(startTime), m_duration(duration_us) { }
 		DelayManager(const DelayManager& other) = default;
 		DelayManager(DelayManager&& other) = default;
 		DelayManager& operator=(const DelayManager& other) = default;
@@ -36,7 +42,12 @@ namespace sds::Utilities
 		/// <summary>Check for elapsed.</summary>
 		bool IsElapsed() noexcept
 		{
-			if (std::chrono::high_resolution_clock::now() > (m_start_time + std::chrono::microseconds(m_duration)))
+			return IsElapsed(std::chrono::high_resolution_clock::now());
+		}
+		/// <summary>Check for elapsed at the given time.</summary>
+		bool IsElapsed(const TimeType now) noexcept
+		{
+			if (now > GetDeadline())
 			{
 				m_has_fired = true;
 				return true;
@@ -46,10 +57,35 @@ namespace sds::Utilities
 		/// <summary>Reset delay for elapsing.</summary>
 		void Reset(size_t microsec_delay) noexcept
 		{
-			m_start_time = std::chrono::high_resolution_clock::now();
+			Reset(microsec_delay, std::chrono::high_resolution_clock::now());
+		}
+		/// <summary>Reset delay for elapsing, starting at the given time.</summary>
+		void Reset(size_t microsec_delay, const TimeType now) noexcept
+		{
+			m_start_time = now;
+			m_has_fired = false;
+			m_duration = microsec_delay;
+		}
+		/// <summary>Restarts the delay from the previous deadline instead of the current time,
+		///	so a series of delays doesn't accumulate the time taken to notice each one elapsing.
+		///	When the previous deadline is more than the new delay behind, as after an idle period,
+		///	restarts from the current time instead of catching up in a burst.</summary>
+		void Advance(size_t microsec_delay) noexcept
+		{
+			Advance(microsec_delay, std::chrono::high_resolution_clock::now());
+		}
+		/// <summary>Advance() with the given current time.</summary>
+		void Advance(size_t microsec_delay, const TimeType now) noexcept
+		{
+			const TimeType deadline = GetDeadline();
+			m_start_time = (now - deadline) > std::chrono::microseconds(microsec_delay) ? now : deadline;
 			m_has_fired = false;
 			m_duration = microsec_delay;
 		}
+		/// <summary>Time the delay ends, IsElapsed() is true for any time after it.</summary>
+		[[nodiscard]] TimeType GetDeadline() const noexcept
+		{
+			return m_start_time + std::chrono::microseconds(m_duration);
+		}
 	};
 }
-
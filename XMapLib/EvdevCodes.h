@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+
+namespace sds::Evdev
+{
+	/// <summary>
+	/// Layout of the Linux 'struct input_event' read from an evdev device node, on 64-bit targets,
+	///	defined here so the translation builds and can be tested without the Linux headers,
+	///	<linux/input.h> is not included, it defines macros such as KEY_DOWN that collide with names in this library.
+	///	A recorded event stream or a pipe carrying these records is read the same as a device.
+	/// </summary>
+	struct EvdevEvent
+	{
+		int64_t Seconds{ 0 };
+		int64_t Microseconds{ 0 };
+		uint16_t Type{ 0 };
+		uint16_t Code{ 0 };
+		int32_t Value{ 0 };
+	};
+	static_assert(sizeof(EvdevEvent) == 24, "EvdevEvent must match the 64-bit input_event layout.");
+	/// <summary>Layout of the Linux 'struct input_absinfo', the range of an absolute axis read with EVIOCGABS.</summary>
+	struct EvdevAbsInfo
+	{
+		int32_t Value{ 0 };
+		int32_t Minimum{ 0 };
+		int32_t Maximum{ 0 };
+		int32_t Fuzz{ 0 };
+		int32_t Flat{ 0 };
+		int32_t Resolution{ 0 };
+	};
+
+	//Event types
+	constexpr uint16_t EV_TYPE_SYN{ 0x00 };
+	constexpr uint16_t EV_TYPE_KEY{ 0x01 };
+	constexpr uint16_t EV_TYPE_REL{ 0x02 };
+	constexpr uint16_t EV_TYPE_ABS{ 0x03 };
+	//EV_SYN codes
+	constexpr uint16_t SYN_CODE_REPORT{ 0 };
+	constexpr uint16_t SYN_CODE_DROPPED{ 3 };
+	//EV_KEY mouse button codes
+	constexpr uint16_t BTN_CODE_LEFT{ 0x110 };
+	constexpr uint16_t BTN_CODE_RIGHT{ 0x111 };
+	constexpr uint16_t BTN_CODE_MIDDLE{ 0x112 };
+	constexpr uint16_t BTN_CODE_SIDE{ 0x113 };
+	constexpr uint16_t BTN_CODE_EXTRA{ 0x114 };
+	//EV_KEY gamepad codes, the names are the xpad driver's, BTN_X and BTN_Y are the codes it reports for the X and Y buttons
+	constexpr uint16_t BTN_CODE_A{ 0x130 };
+	constexpr uint16_t BTN_CODE_B{ 0x131 };
+	constexpr uint16_t BTN_CODE_X{ 0x133 };
+	constexpr uint16_t BTN_CODE_Y{ 0x134 };
+	constexpr uint16_t BTN_CODE_TL{ 0x136 };
+	constexpr uint16_t BTN_CODE_TR{ 0x137 };
+	constexpr uint16_t BTN_CODE_TL2{ 0x138 };
+	constexpr uint16_t BTN_CODE_TR2{ 0x139 };
+	constexpr uint16_t BTN_CODE_SELECT{ 0x13a };
+	constexpr uint16_t BTN_CODE_START{ 0x13b };
+	constexpr uint16_t BTN_CODE_THUMBL{ 0x13d };
+	constexpr uint16_t BTN_CODE_THUMBR{ 0x13e };
+	constexpr uint16_t BTN_CODE_DPAD_UP{ 0x220 };
+	constexpr uint16_t BTN_CODE_DPAD_DOWN{ 0x221 };
+	constexpr uint16_t BTN_CODE_DPAD_LEFT{ 0x222 };
+	constexpr uint16_t BTN_CODE_DPAD_RIGHT{ 0x223 };
+	//EV_REL codes, the high resolution wheels are in 1/120 notch units, as WHEEL_DELTA
+	constexpr uint16_t REL_CODE_X{ 0x00 };
+	constexpr uint16_t REL_CODE_Y{ 0x01 };
+	constexpr uint16_t REL_CODE_HWHEEL{ 0x06 };
+	constexpr uint16_t REL_CODE_WHEEL{ 0x08 };
+	constexpr uint16_t REL_CODE_WHEEL_HI_RES{ 0x0b };
+	constexpr uint16_t REL_CODE_HWHEEL_HI_RES{ 0x0c };
+	//EV_ABS codes
+	constexpr uint16_t ABS_CODE_X{ 0x00 };
+	constexpr uint16_t ABS_CODE_Y{ 0x01 };
+	constexpr uint16_t ABS_CODE_Z{ 0x02 };
+	constexpr uint16_t ABS_CODE_RX{ 0x03 };
+	constexpr uint16_t ABS_CODE_RY{ 0x04 };
+	constexpr uint16_t ABS_CODE_RZ{ 0x05 };
+	constexpr uint16_t ABS_CODE_HAT0X{ 0x10 };
+	constexpr uint16_t ABS_CODE_HAT0Y{ 0x11 };
+}
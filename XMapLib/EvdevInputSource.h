@@ -0,0 +1,247 @@
+#pragma once
+#include "stdafx.h"
+#include "CPPRunnerGeneric.h"
+#include "EvdevTranslator.h"
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace sds
+{
+#ifdef __linux__
+	/// <summary>
+	/// Reads an evdev event stream from a file descriptor in it's worker thread function, and translates it
+	///	into XINPUT_STATE frames with an EvdevTranslator, for the Linux clients without XInput.
+	///	The descriptor may be a gamepad device node, a pipe, or a recorded event file.
+	///	The worker blocks in poll() until events arrive, so latency is event-driven instead of a polling interval,
+	///	Stop() wakes it through an internal pipe.
+	///	Every completed frame is published as the current state and passed to the optional state listener,
+	///	so it can feed KeyboardMapper::FeedState() for keystrokes, as with MouseMapper::SetStateListener().
+	///	The stream ending (end of file, closed pipe, removed device) ends the worker, see IsEndOfStream().
+	/// </summary>
+	class EvdevInputSource
+	{
+		using InternalType = XINPUT_STATE;
+		using LambdaRunnerType = sds::CPPRunnerGeneric<InternalType>;
+		using lock = LambdaRunnerType::ScopedLockType;
+	public:
+		using StateListenerType = std::function<void(const XINPUT_STATE&)>;
+		/// <summary>Events read per read() call.</summary>
+		static constexpr size_t READ_EVENT_COUNT{ 64 };
+	private:
+		int m_fd{ -1 };
+		bool m_is_owned{ false };
+		std::array<int, 2> m_wake_pipe{ -1, -1 };
+		EvdevTranslator m_translator{};
+		StateListenerType m_state_listener{};
+		std::mutex m_listener_mutex{};
+		std::atomic<bool> m_is_end_of_stream{ false };
+		std::atomic<size_t> m_frame_count{ 0 };
+		std::unique_ptr<LambdaRunnerType> m_workThread{};
+		void InitWorkThread()
+		{
+			if (pipe2(m_wake_pipe.data(), O_CLOEXEC | O_NONBLOCK) != 0)
+				m_wake_pipe = { -1, -1 };
+			m_workThread =
+				std::make_unique<LambdaRunnerType>
+				([this](const sds::LambdaArgs::LambdaArg1& stopCondition, sds::LambdaArgs::LambdaArg2& mut, auto& protectedData) { workThread(stopCondition, mut, protectedData); });
+			m_workThread->SetThreadPolicy(Utilities::ThreadPolicy::ForPolling());
+		}
+	public:
+		/// <summary>Ctor reads from an open descriptor, which is not closed by this object.
+		///	The listener is set before the worker starts, so no frame of a recorded stream is missed.</summary>
+		EvdevInputSource(const int fd, StateListenerType listener, const EvdevAxisRanges& ranges = {})
+			: m_fd(fd), m_translator(ranges), m_state_listener(std::move(listener))
+		{
+			InitWorkThread();
+			Start();
+		}
+		/// <summary>Ctor opens a device node, and reads the axis ranges from the device, see IsOpen().</summary>
+		EvdevInputSource(const std::string& devicePath, StateListenerType listener)
+			: m_fd(open(devicePath.c_str(), O_RDONLY | O_CLOEXEC)), m_is_owned(true), m_state_listener(std::move(listener))
+		{
+			if (m_fd >= 0)
+				m_translator = EvdevTranslator(QueryAxisRanges(m_fd));
+			InitWorkThread();
+			Start();
+		}
+		EvdevInputSource(const EvdevInputSource& other) = delete;
+		EvdevInputSource(EvdevInputSource&& other) = delete;
+		EvdevInputSource& operator=(const EvdevInputSource& other) = delete;
+		EvdevInputSource& operator=(EvdevInputSource&& other) = delete;
+		~EvdevInputSource()
+		{
+			Stop();
+			m_workThread.reset();
+			for (const int end : m_wake_pipe)
+			{
+				if (end >= 0)
+					close(end);
+			}
+			if (m_is_owned && m_fd >= 0)
+				close(m_fd);
+		}
+
+		/// <summary>Returns the state of the last completed frame.</summary>
+		[[nodiscard]] XINPUT_STATE GetUpdatedState() const noexcept
+		{
+			if (m_workThread)
+				return m_workThread->GetCurrentState();
+			return XINPUT_STATE{};
+		}
+		/// <summary>Sets a function called by the worker thread with every completed frame.
+		///	Pass an empty function to remove it.</summary>
+		void SetStateListener(StateListenerType listener)
+		{
+			lock listenerLock(m_listener_mutex);
+			m_state_listener = std::move(listener);
+		}
+		/// <summary>Sets the scheduling policy of the reading thread, takes effect the next time it is started.</summary>
+		void SetThreadPolicy(const Utilities::ThreadPolicy& policy)
+		{
+			m_workThread->SetThreadPolicy(policy);
+		}
+		/// <summary>Start reading events.</summary>
+		void Start() noexcept
+		{
+			if (m_workThread && m_fd >= 0 && m_wake_pipe[0] >= 0)
+			{
+				m_is_end_of_stream = false;
+				m_workThread->StartThread();
+			}
+		}
+		/// <summary>Stop reading events, wakes the worker if it is waiting for one.</summary>
+		void Stop() noexcept
+		{
+			if (!m_workThread)
+				return;
+			m_workThread->RequestStop();
+			Wake();
+			m_workThread->StopThread();
+		}
+		/// <summary>Gets the running status of the worker thread</summary>
+		/// <returns> true if thread is running, false otherwise</returns>
+		[[nodiscard]] bool IsRunning() const noexcept
+		{
+			if (m_workThread)
+				return m_workThread->IsRunning() && !m_is_end_of_stream;
+			return false;
+		}
+		/// <returns>true if the descriptor was opened.</returns>
+		[[nodiscard]] bool IsOpen() const noexcept
+		{
+			return m_fd >= 0;
+		}
+		/// <returns>true if the stream has ended, no more frames will be read.</returns>
+		[[nodiscard]] bool IsEndOfStream() const noexcept
+		{
+			return m_is_end_of_stream;
+		}
+		/// <summary>Telemetry, the number of frames read so far.</summary>
+		[[nodiscard]] size_t GetFrameCount() const noexcept
+		{
+			return m_frame_count.load(std::memory_order_relaxed);
+		}
+		/// <summary>Reads the stick and trigger axis ranges reported by a device, keeping the given range for an axis that can't be read.</summary>
+		[[nodiscard]] static EvdevAxisRanges QueryAxisRanges(const int fd, EvdevAxisRanges ranges = {}) noexcept
+		{
+			const auto query = [fd](const uint16_t code, EvdevAxisRange& range)
+			{
+				Evdev::EvdevAbsInfo info{};
+				//EVIOCGABS(code)
+				if (ioctl(fd, _IOR('E', 0x40 + code, Evdev::EvdevAbsInfo), &info) == 0 && info.Maximum > info.Minimum)
+				{
+					range.Minimum = info.Minimum;
+					range.Maximum = info.Maximum;
+				}
+			};
+			query(Evdev::ABS_CODE_X, ranges.LeftX);
+			query(Evdev::ABS_CODE_Y, ranges.LeftY);
+			query(Evdev::ABS_CODE_RX, ranges.RightX);
+			query(Evdev::ABS_CODE_RY, ranges.RightY);
+			query(Evdev::ABS_CODE_Z, ranges.LeftTrigger);
+			query(Evdev::ABS_CODE_RZ, ranges.RightTrigger);
+			return ranges;
+		}
+	protected:
+		/// <summary>Worker thread used by m_workThread. Updates the protectedData with mutex protection.</summary>
+		void workThread(const sds::LambdaArgs::LambdaArg1& stopCondition, sds::LambdaArgs::LambdaArg2& mut, InternalType& protectedData)
+		{
+			{
+				lock first(mut);
+				protectedData = m_translator.GetState();
+			}
+			std::array<Evdev::EvdevEvent, READ_EVENT_COUNT> events{};
+			auto* bytes = reinterpret_cast<char*>(events.data());
+			//bytes of a partial event carried over to the next read, a pipe may split an event
+			size_t pending = 0;
+			while (!stopCondition)
+			{
+				std::array<pollfd, 2> fds{ { { m_fd, POLLIN, 0 }, { m_wake_pipe[0], POLLIN, 0 } } };
+				if (poll(fds.data(), fds.size(), -1) < 0)
+				{
+					if (errno == EINTR)
+						continue;
+					break;
+				}
+				if (fds[1].revents & POLLIN)
+				{
+					DrainWake();
+					continue;
+				}
+				if ((fds[0].revents & (POLLIN | POLLHUP | POLLERR)) == 0)
+					continue;
+				const ssize_t count = read(m_fd, bytes + pending, sizeof(events) - pending);
+				if (count < 0 && (errno == EINTR || errno == EAGAIN))
+					continue;
+				if (count <= 0)
+				{
+					m_is_end_of_stream = true;
+					break;
+				}
+				const size_t total = pending + static_cast<size_t>(count);
+				const size_t whole = total / sizeof(Evdev::EvdevEvent);
+				for (size_t i = 0; i < whole; i++)
+				{
+					if (m_translator.Process(events[i]))
+						PublishFrame(mut, protectedData);
+				}
+				pending = total % sizeof(Evdev::EvdevEvent);
+				if (pending != 0)
+					std::memmove(bytes, bytes + whole * sizeof(Evdev::EvdevEvent), pending);
+			}
+		}
+	private:
+		void PublishFrame(sds::LambdaArgs::LambdaArg2& mut, InternalType& protectedData)
+		{
+			const XINPUT_STATE& state = m_translator.GetState();
+			{
+				lock frameLock(mut);
+				protectedData = state;
+			}
+			m_frame_count.fetch_add(1, std::memory_order_relaxed);
+			lock listenerLock(m_listener_mutex);
+			if (m_state_listener)
+				m_state_listener(state);
+		}
+		void Wake() const noexcept
+		{
+			if (m_wake_pipe[1] >= 0)
+			{
+				constexpr char WakeByte{ 1 };
+				[[maybe_unused]] const auto written = write(m_wake_pipe[1], &WakeByte, 1);
+			}
+		}
+		void DrainWake() const noexcept
+		{
+			std::array<char, 16> drained{};
+			while (read(m_wake_pipe[0], drained.data(), drained.size()) > 0) { }
+		}
+	};
+#endif
+}
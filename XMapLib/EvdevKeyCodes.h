@@ -0,0 +1,114 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "EvdevCodes.h"
+
+namespace sds::Evdev
+{
+	namespace Detail
+	{
+		consteval std::array<uint16_t, 256> BuildVirtualKeyTable()
+		{
+			std::array<uint16_t, 256> table{};
+			//mouse buttons, VK_LBUTTON VK_RBUTTON VK_MBUTTON VK_XBUTTON1 VK_XBUTTON2
+			table[0x01] = BTN_CODE_LEFT;
+			table[0x02] = BTN_CODE_RIGHT;
+			table[0x04] = BTN_CODE_MIDDLE;
+			table[0x05] = BTN_CODE_SIDE;
+			table[0x06] = BTN_CODE_EXTRA;
+			table[0x08] = 14; // VK_BACK
+			table[0x09] = 15; // VK_TAB
+			table[0x0D] = 28; // VK_RETURN
+			table[0x10] = 42; // VK_SHIFT, as the left key
+			table[0x11] = 29; // VK_CONTROL
+			table[0x12] = 56; // VK_MENU
+			table[0x13] = 119; // VK_PAUSE
+			table[0x14] = 58; // VK_CAPITAL
+			table[0x1B] = 1; // VK_ESCAPE
+			table[0x20] = 57; // VK_SPACE
+			table[0x21] = 104; // VK_PRIOR
+			table[0x22] = 109; // VK_NEXT
+			table[0x23] = 107; // VK_END
+			table[0x24] = 102; // VK_HOME
+			table[0x25] = 105; // VK_LEFT
+			table[0x26] = 103; // VK_UP
+			table[0x27] = 106; // VK_RIGHT
+			table[0x28] = 108; // VK_DOWN
+			table[0x2C] = 99; // VK_SNAPSHOT
+			table[0x2D] = 110; // VK_INSERT
+			table[0x2E] = 111; // VK_DELETE
+			//'1' to '9' then '0', the top row is ordered 1..0
+			for (int i = 1; i <= 9; i++)
+				table[0x30 + i] = static_cast<uint16_t>(1 + i);
+			table[0x30] = 11;
+			//'A' to 'Z', in keyboard row order
+			constexpr std::array<uint16_t, 26> Letters{ 30, 48, 46, 32, 18, 33, 34, 35, 23, 36, 37, 38, 50,
+				49, 24, 25, 16, 19, 31, 20, 22, 47, 17, 45, 21, 44 };
+			for (size_t i = 0; i < Letters.size(); i++)
+				table[0x41 + i] = Letters[i];
+			table[0x5B] = 125; // VK_LWIN
+			table[0x5C] = 126; // VK_RWIN
+			table[0x5D] = 127; // VK_APPS
+			//VK_NUMPAD0 to VK_NUMPAD9
+			constexpr std::array<uint16_t, 10> Numpad{ 82, 79, 80, 81, 75, 76, 77, 71, 72, 73 };
+			for (size_t i = 0; i < Numpad.size(); i++)
+				table[0x60 + i] = Numpad[i];
+			table[0x6A] = 55; // VK_MULTIPLY
+			table[0x6B] = 78; // VK_ADD
+			table[0x6D] = 74; // VK_SUBTRACT
+			table[0x6E] = 83; // VK_DECIMAL
+			table[0x6F] = 98; // VK_DIVIDE
+			//VK_F1 to VK_F24
+			for (int i = 0; i < 10; i++)
+				table[0x70 + i] = static_cast<uint16_t>(59 + i);
+			table[0x7A] = 87;
+			table[0x7B] = 88;
+			for (int i = 0; i < 12; i++)
+				table[0x7C + i] = static_cast<uint16_t>(183 + i);
+			table[0x90] = 69; // VK_NUMLOCK
+			table[0x91] = 70; // VK_SCROLL
+			table[0xA0] = 42; // VK_LSHIFT
+			table[0xA1] = 54; // VK_RSHIFT
+			table[0xA2] = 29; // VK_LCONTROL
+			table[0xA3] = 97; // VK_RCONTROL
+			table[0xA4] = 56; // VK_LMENU
+			table[0xA5] = 100; // VK_RMENU
+			table[0xAD] = 113; // VK_VOLUME_MUTE
+			table[0xAE] = 114; // VK_VOLUME_DOWN
+			table[0xAF] = 115; // VK_VOLUME_UP
+			table[0xB0] = 163; // VK_MEDIA_NEXT_TRACK
+			table[0xB1] = 165; // VK_MEDIA_PREV_TRACK
+			table[0xB2] = 166; // VK_MEDIA_STOP
+			table[0xB3] = 164; // VK_MEDIA_PLAY_PAUSE
+			table[0xBA] = 39; // VK_OEM_1 ;
+			table[0xBB] = 13; // VK_OEM_PLUS =
+			table[0xBC] = 51; // VK_OEM_COMMA
+			table[0xBD] = 12; // VK_OEM_MINUS
+			table[0xBE] = 52; // VK_OEM_PERIOD
+			table[0xBF] = 53; // VK_OEM_2 /
+			table[0xC0] = 41; // VK_OEM_3 `
+			table[0xDB] = 26; // VK_OEM_4 [
+			table[0xDC] = 43; // VK_OEM_5 backslash
+			table[0xDD] = 27; // VK_OEM_6 ]
+			table[0xDE] = 40; // VK_OEM_7 '
+			table[0xE2] = 86; // VK_OEM_102
+			return table;
+		}
+	}
+	/// <summary>
+	/// Compile-time table from Windows virtual keys to Linux evdev key codes, for the uinput output.
+	///	The virtual keys are the numeric values, so the table builds without the Windows headers.
+	///	Keys without a Linux equivalent map to 0, and are not sent.
+	/// </summary>
+	inline constexpr std::array<uint16_t, 256> VIRTUAL_KEY_TO_EVDEV{ Detail::BuildVirtualKeyTable() };
+
+	/// <summary>Returns the evdev key code for a virtual key, or 0 if there is none.</summary>
+	[[nodiscard]] constexpr uint16_t ToEvdevKeyCode(const int vk) noexcept
+	{
+		if (vk <= 0 || vk >= static_cast<int>(VIRTUAL_KEY_TO_EVDEV.size()))
+			return 0;
+		return VIRTUAL_KEY_TO_EVDEV[static_cast<size_t>(vk)];
+	}
+	static_assert(ToEvdevKeyCode(0x41) == 30 && ToEvdevKeyCode(0x5A) == 44 && ToEvdevKeyCode(0x30) == 11);
+	static_assert(ToEvdevKeyCode(0x7B) == 88 && ToEvdevKeyCode(0x87) == 194 && ToEvdevKeyCode(0xFF) == 0);
+}
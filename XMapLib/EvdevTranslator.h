@@ -0,0 +1,192 @@
+#pragma once
+#include "stdafx.h"
+#include "EvdevCodes.h"
+
+namespace sds
+{
+	/// <summary>Range reported by an evdev absolute axis, and whether it runs opposite to the XInput axis.</summary>
+	struct EvdevAxisRange
+	{
+		int Minimum{ -32768 };
+		int Maximum{ 32767 };
+		bool IsInverted{ false };
+		[[nodiscard]] bool IsValid() const noexcept { return Maximum > Minimum; }
+	};
+	/// <summary>Ranges of the axes mapped to the XINPUT_GAMEPAD sticks and triggers, the defaults are the xpad driver's.
+	///	evdev reports stick Y increasing downward, XInput upward, so the Y axes are inverted.</summary>
+	struct EvdevAxisRanges
+	{
+		EvdevAxisRange LeftX{};
+		EvdevAxisRange LeftY{ -32768, 32767, true };
+		EvdevAxisRange RightX{};
+		EvdevAxisRange RightY{ -32768, 32767, true };
+		EvdevAxisRange LeftTrigger{ 0, 255, false };
+		EvdevAxisRange RightTrigger{ 0, 255, false };
+	};
+
+	/// <summary>
+	/// Maps an evdev gamepad event stream (EV_KEY buttons, EV_ABS sticks, triggers and hat) into an XINPUT_STATE.
+	///	Events accumulate into the state, and a SYN_REPORT completes a frame: Process() returns true and
+	///	the packet number is advanced, as XInputGetState() does for a changed state.
+	///	After a SYN_DROPPED the device state is unknown, events are ignored up to the next SYN_REPORT
+	///	and that frame is reported neutral, so no button is left held.
+	///	Not thread-safe, intended to be used by the single thread reading the device.
+	/// </summary>
+	class EvdevTranslator
+	{
+		EvdevAxisRanges m_ranges{};
+		XINPUT_STATE m_state{};
+		bool m_is_dropping{ false };
+	public:
+		EvdevTranslator() = default;
+		explicit EvdevTranslator(const EvdevAxisRanges& ranges) noexcept : m_ranges(ranges) { }
+		EvdevTranslator(const EvdevTranslator& other) = default;
+		EvdevTranslator(EvdevTranslator&& other) = default;
+		EvdevTranslator& operator=(const EvdevTranslator& other) = default;
+		EvdevTranslator& operator=(EvdevTranslator&& other) = default;
+		~EvdevTranslator() = default;
+
+		/// <summary>Applies one event to the state.</summary>
+		/// <returns>true if the event completed a frame, the state is then ready to be consumed.</returns>
+		bool Process(const Evdev::EvdevEvent& ev) noexcept
+		{
+			using namespace Evdev;
+			if (ev.Type == EV_TYPE_SYN)
+			{
+				if (ev.Code == SYN_CODE_DROPPED)
+				{
+					m_is_dropping = true;
+					return false;
+				}
+				if (ev.Code != SYN_CODE_REPORT)
+					return false;
+				if (m_is_dropping)
+				{
+					m_is_dropping = false;
+					m_state.Gamepad = {};
+				}
+				m_state.dwPacketNumber++;
+				return true;
+			}
+			if (m_is_dropping)
+				return false;
+			if (ev.Type == EV_TYPE_KEY)
+				ProcessKey(ev.Code, ev.Value != 0);
+			else if (ev.Type == EV_TYPE_ABS)
+				ProcessAbs(ev.Code, ev.Value);
+			return false;
+		}
+		/// <summary>The state as of the last completed frame, and any events since.</summary>
+		[[nodiscard]] const XINPUT_STATE& GetState() const noexcept
+		{
+			return m_state;
+		}
+		[[nodiscard]] const EvdevAxisRanges& GetAxisRanges() const noexcept
+		{
+			return m_ranges;
+		}
+		/// <summary>Returns the state to neutral, the packet number is kept.</summary>
+		void Reset() noexcept
+		{
+			m_state.Gamepad = {};
+			m_is_dropping = false;
+		}
+		/// <summary>Scales an axis value to the XInput thumbstick range, clamped to the axis range.</summary>
+		[[nodiscard]] static SHORT ScaleStick(const int value, const EvdevAxisRange& range) noexcept
+		{
+			if (!range.IsValid())
+				return 0;
+			const long long offset = std::clamp(value, range.Minimum, range.Maximum) - static_cast<long long>(range.Minimum);
+			const long long span = static_cast<long long>(range.Maximum) - range.Minimum;
+			constexpr long long OutSpan{ 65535 };
+			long long out = (offset * OutSpan + span / 2) / span - 32768;
+			if (range.IsInverted)
+				out = -1 - out;
+			return static_cast<SHORT>(out);
+		}
+		/// <summary>Scales an axis value to the XInput trigger range, clamped to the axis range.</summary>
+		[[nodiscard]] static BYTE ScaleTrigger(const int value, const EvdevAxisRange& range) noexcept
+		{
+			if (!range.IsValid())
+				return 0;
+			const long long offset = std::clamp(value, range.Minimum, range.Maximum) - static_cast<long long>(range.Minimum);
+			const long long span = static_cast<long long>(range.Maximum) - range.Minimum;
+			long long out = (offset * 255 + span / 2) / span;
+			if (range.IsInverted)
+				out = 255 - out;
+			return static_cast<BYTE>(out);
+		}
+	private:
+		void ProcessKey(const uint16_t code, const bool isDown) noexcept
+		{
+			using namespace Evdev;
+			XINPUT_GAMEPAD& pad = m_state.Gamepad;
+			//some pads report the triggers as buttons only
+			if (code == BTN_CODE_TL2)
+			{
+				pad.bLeftTrigger = isDown ? 255 : 0;
+				return;
+			}
+			if (code == BTN_CODE_TR2)
+			{
+				pad.bRightTrigger = isDown ? 255 : 0;
+				return;
+			}
+			const WORD bit = ButtonForCode(code);
+			if (bit == 0)
+				return;
+			if (isDown)
+				pad.wButtons |= bit;
+			else
+				pad.wButtons &= static_cast<WORD>(~bit);
+		}
+		void ProcessAbs(const uint16_t code, const int value) noexcept
+		{
+			using namespace Evdev;
+			XINPUT_GAMEPAD& pad = m_state.Gamepad;
+			switch (code)
+			{
+			case ABS_CODE_X: pad.sThumbLX = ScaleStick(value, m_ranges.LeftX); break;
+			case ABS_CODE_Y: pad.sThumbLY = ScaleStick(value, m_ranges.LeftY); break;
+			case ABS_CODE_RX: pad.sThumbRX = ScaleStick(value, m_ranges.RightX); break;
+			case ABS_CODE_RY: pad.sThumbRY = ScaleStick(value, m_ranges.RightY); break;
+			case ABS_CODE_Z: pad.bLeftTrigger = ScaleTrigger(value, m_ranges.LeftTrigger); break;
+			case ABS_CODE_RZ: pad.bRightTrigger = ScaleTrigger(value, m_ranges.RightTrigger); break;
+			case ABS_CODE_HAT0X: SetHat(value, XINPUT_GAMEPAD_DPAD_LEFT, XINPUT_GAMEPAD_DPAD_RIGHT); break;
+			case ABS_CODE_HAT0Y: SetHat(value, XINPUT_GAMEPAD_DPAD_UP, XINPUT_GAMEPAD_DPAD_DOWN); break;
+			default: break;
+			}
+		}
+		void SetHat(const int value, const WORD negativeBit, const WORD positiveBit) noexcept
+		{
+			WORD& buttons = m_state.Gamepad.wButtons;
+			buttons &= static_cast<WORD>(~(negativeBit | positiveBit));
+			if (value < 0)
+				buttons |= negativeBit;
+			else if (value > 0)
+				buttons |= positiveBit;
+		}
+		[[nodiscard]] static WORD ButtonForCode(const uint16_t code) noexcept
+		{
+			using namespace Evdev;
+			switch (code)
+			{
+			case BTN_CODE_A: return XINPUT_GAMEPAD_A;
+			case BTN_CODE_B: return XINPUT_GAMEPAD_B;
+			case BTN_CODE_X: return XINPUT_GAMEPAD_X;
+			case BTN_CODE_Y: return XINPUT_GAMEPAD_Y;
+			case BTN_CODE_TL: return XINPUT_GAMEPAD_LEFT_SHOULDER;
+			case BTN_CODE_TR: return XINPUT_GAMEPAD_RIGHT_SHOULDER;
+			case BTN_CODE_SELECT: return XINPUT_GAMEPAD_BACK;
+			case BTN_CODE_START: return XINPUT_GAMEPAD_START;
+			case BTN_CODE_THUMBL: return XINPUT_GAMEPAD_LEFT_THUMB;
+			case BTN_CODE_THUMBR: return XINPUT_GAMEPAD_RIGHT_THUMB;
+			case BTN_CODE_DPAD_UP: return XINPUT_GAMEPAD_DPAD_UP;
+			case BTN_CODE_DPAD_DOWN: return XINPUT_GAMEPAD_DPAD_DOWN;
+			case BTN_CODE_DPAD_LEFT: return XINPUT_GAMEPAD_DPAD_LEFT;
+			case BTN_CODE_DPAD_RIGHT: return XINPUT_GAMEPAD_DPAD_RIGHT;
+			default: return 0;
+			}
+		}
+	};
+}
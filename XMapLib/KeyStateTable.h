@@ -0,0 +1,62 @@
+#pragma once
+#include "stdafx.h"
+
+namespace sds
+{
+	/// <summary>
+	/// Output side state of the keyboard keys, the number of key maps holding each virtual key down.
+	///	Several maps may send the same virtual key, so a key is sent down only by its first holder
+	///	and up only by its last, instead of one map releasing a key another map still holds.
+	///	Virtual keys outside of [1,255] are not tracked, each press and release of them is sent.
+	///	Not thread safe, owned by one keystroke processing thread.
+	/// </summary>
+	class KeyStateTable
+	{
+	public:
+		static constexpr int VK_COUNT{ 256 };
+		using CountType = std::uint16_t;
+	private:
+		std::array<CountType, VK_COUNT> m_holders{};
+	public:
+		/// <summary>Adds a holder of the key.</summary>
+		/// <returns>true if the key-down should be sent, it was the first holder.</returns>
+		bool Press(const int vk) noexcept
+		{
+			if (!IsTracked(vk))
+				return true;
+			CountType& holders = m_holders[static_cast<size_t>(vk)];
+			if (holders < std::numeric_limits<CountType>::max())
+				holders++;
+			return holders == 1;
+		}
+		/// <summary>Removes a holder of the key.</summary>
+		/// <returns>true if the key-up should be sent, it was the last holder.</returns>
+		bool Release(const int vk) noexcept
+		{
+			if (!IsTracked(vk))
+				return true;
+			CountType& holders = m_holders[static_cast<size_t>(vk)];
+			if (holders == 0)
+				return false;
+			holders--;
+			return holders == 0;
+		}
+		[[nodiscard]] CountType GetHolderCount(const int vk) const noexcept
+		{
+			return IsTracked(vk) ? m_holders[static_cast<size_t>(vk)] : CountType{ 0 };
+		}
+		[[nodiscard]] bool IsDown(const int vk) const noexcept
+		{
+			return GetHolderCount(vk) > 0;
+		}
+		[[nodiscard]] static constexpr bool IsTracked(const int vk) noexcept
+		{
+			return vk > 0 && vk < VK_COUNT;
+		}
+		/// <summary>Forgets every holder, without sending anything.</summary>
+		void Clear() noexcept
+		{
+			m_holders.fill(0);
+		}
+	};
+}
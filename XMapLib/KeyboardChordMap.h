@@ -0,0 +1,72 @@
+#pragma once
+#include "stdafx.h"
+#include "ControllerBits.h"
+#include <syncstream>
+
+namespace sds
+{
+	/// <summary>
+	/// Utility class for holding a controller chord to keyboard map, N controller inputs held together
+	///	are mapped to a single keyboard/mouse input. While the chord is active the individual maps of its
+	///	inputs are suppressed, until each input is released.
+	/// </summary>
+	struct KeyboardChordMap
+	{
+		//Struct members
+		std::vector<int> SendingElementVKs{}; // VKs of the controller buttons held together
+		int MappedToVK{ 0 }; // VK of mapped-to input (key or mouse button)
+		bool UsesRepeat{ true }; // Uses the key-repeat behavior when held down
+		//Ctor
+		KeyboardChordMap(std::vector<int> controllerElementVKs, const int keyboardMouseElementVK, const bool useRepeat)
+			: SendingElementVKs(std::move(controllerElementVKs)), MappedToVK(keyboardMouseElementVK), UsesRepeat(useRepeat)
+		{
+		}
+		KeyboardChordMap() = default;
+		KeyboardChordMap(const KeyboardChordMap& other) = default;
+		KeyboardChordMap(KeyboardChordMap&& other) = default;
+		KeyboardChordMap& operator=(const KeyboardChordMap& other) = default;
+		KeyboardChordMap& operator=(KeyboardChordMap&& other) = default;
+		~KeyboardChordMap() = default;
+		/// <summary>Returns the ControllerBits mask of the chord inputs, or 0 if any input has no bit.</summary>
+		[[nodiscard]] ControllerBits::MaskType GetSendingMask() const noexcept
+		{
+			ControllerBits::MaskType mask{ 0 };
+			for (const int vk : SendingElementVKs)
+			{
+				const int bit = ControllerBits::GetBitIndex(vk);
+				if (bit < 0 || bit >= ControllerBits::USED_BIT_COUNT)
+					return 0;
+				mask |= ControllerBits::ToMask(bit);
+			}
+			return mask;
+		}
+		/// <summary>
+		/// Operator<< overload for std::ostream specialization,
+		///	writes more detailed map details for debugging.
+		///	Thread-safe, provided all writes to the ostream object
+		///	are wrapped with std::osyncstream!
+		/// </summary>
+		friend std::ostream& operator<<(std::ostream& os, const KeyboardChordMap& obj)
+		{
+			std::osyncstream ss(os);
+			ss << "[KeyboardChordMap]" << " ";
+			ss << "SendingElementVKs:";
+			for (const int vk : obj.SendingElementVKs)
+				ss << vk << ",";
+			ss << " ";
+			ss << "MappedToVK:" << obj.MappedToVK << " ";
+			ss << "UsesRepeat:" << obj.UsesRepeat << " ";
+			ss << "[/KeyboardChordMap]" << " ";
+			return os;
+		}
+		friend bool operator==(const KeyboardChordMap& lhs, const KeyboardChordMap& rhs)
+		{
+			return lhs.GetSendingMask() == rhs.GetSendingMask()
+				&& lhs.MappedToVK == rhs.MappedToVK;
+		}
+		friend bool operator!=(const KeyboardChordMap& lhs, const KeyboardChordMap& rhs)
+		{
+			return !(lhs == rhs);
+		}
+	};
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include "stdafx.h"
+#include "ControllerBits.h"
+
+namespace sds
+{
+	/// <summary>
+	/// Chord maps compiled into a decision table, so resolving the active chords for a controller bitmask
+	///	is constant-time no matter how many chords are defined.
+	///	The bits used by any chord are compacted into a table index with one byte-wise lookup per mask byte,
+	///	each table entry holds the chord bits active for that combination and the input bits they suppress.
+	///	Larger chords win over smaller ones sharing inputs, chords with disjoint inputs may be active together.
+	///	Chord i is reported as the synthesized bit ControllerBits::USED_BIT_COUNT + i.
+	///	Immutable once compiled, so one table may be shared by threads.
+	/// </summary>
+	class KeyboardChordTable
+	{
+	public:
+		using MaskType = ControllerBits::MaskType;
+		using IndexType = std::uint32_t;
+		struct Entry
+		{
+			MaskType Suppressed{ 0 };
+			MaskType Chords{ 0 };
+		};
+	private:
+		static constexpr int LUT_BYTE_COUNT{ (ControllerBits::USED_BIT_COUNT + 7) / 8 };
+		const std::string ERR_COUNT{ "KeyboardChordTable::Compile(): Too many chords." };
+		const std::string ERR_INPUT_BITS{ "KeyboardChordTable::Compile(): Too many distinct controller inputs used by chords." };
+		const std::string ERR_BAD_CHORD{ "KeyboardChordTable::Compile(): A chord must have at least two valid, distinct controller inputs." };
+		const std::string ERR_DUP_CHORD{ "KeyboardChordTable::Compile(): Duplicate chord." };
+		//Per mask byte, the contribution of that byte's value to the compacted table index.
+		std::array<std::array<IndexType, 256>, LUT_BYTE_COUNT> m_index_lut{};
+		std::vector<Entry> m_table{ Entry{} };
+		std::vector<MaskType> m_chord_masks{};
+		MaskType m_input_mask{ 0 };
+	public:
+		KeyboardChordTable() = default;
+		KeyboardChordTable(const KeyboardChordTable& other) = default;
+		KeyboardChordTable(KeyboardChordTable&& other) = default;
+		KeyboardChordTable& operator=(const KeyboardChordTable& other) = default;
+		KeyboardChordTable& operator=(KeyboardChordTable&& other) = default;
+		~KeyboardChordTable() = default;
+
+		/// <summary>Compiles the decision table from the ControllerBits masks of each chord's inputs.</summary>
+		/// <returns>a std::string containing an error message if there is an error, empty string otherwise.
+		///	On error the table is left unchanged.</returns>
+		std::string Compile(const std::vector<MaskType>& chordMasks)
+		{
+			if (chordMasks.size() > static_cast<size_t>(ControllerBits::SYNTHESIZED_BIT_COUNT))
+				return ERR_COUNT;
+			MaskType relevant{ 0 };
+			for (size_t i = 0; i < chordMasks.size(); i++)
+			{
+				const MaskType m = chordMasks[i];
+				if (std::popcount(m) < 2 || (m & ~ControllerBits::USED_MASK) != 0)
+					return ERR_BAD_CHORD;
+				if (std::find(chordMasks.begin(), chordMasks.begin() + static_cast<std::ptrdiff_t>(i), m) != chordMasks.begin() + static_cast<std::ptrdiff_t>(i))
+					return ERR_DUP_CHORD;
+				relevant |= m;
+			}
+			const int bitCount = std::popcount(relevant);
+			if (bitCount > KeyboardSettings::MAX_CHORD_INPUT_BITS)
+				return ERR_INPUT_BITS;
+			//relevant bit positions in ascending order, the compacted index bit j is relevantBits[j]
+			std::vector<int> relevantBits;
+			for (MaskType r = relevant; r != 0; r &= r - 1)
+				relevantBits.push_back(std::countr_zero(r));
+			decltype(m_index_lut) lut{};
+			for (size_t j = 0; j < relevantBits.size(); j++)
+			{
+				const int pos = relevantBits[j];
+				auto& byteLut = lut[static_cast<size_t>(pos / 8)];
+				for (IndexType v = 0; v < 256; v++)
+				{
+					if ((v >> (pos % 8)) & 1u)
+						byteLut[v] |= IndexType{ 1 } << j;
+				}
+			}
+			//chords tried largest first, ties in definition order
+			std::vector<size_t> order(chordMasks.size());
+			for (size_t i = 0; i < order.size(); i++)
+				order[i] = i;
+			std::ranges::stable_sort(order, [&chordMasks](const size_t a, const size_t b)
+			{
+				return std::popcount(chordMasks[a]) > std::popcount(chordMasks[b]);
+			});
+			std::vector<Entry> table(size_t{ 1 } << bitCount);
+			for (size_t index = 0; index < table.size(); index++)
+			{
+				MaskType held{ 0 };
+				for (size_t j = 0; j < relevantBits.size(); j++)
+				{
+					if ((index >> j) & 1u)
+						held |= ControllerBits::ToMask(relevantBits[j]);
+				}
+				Entry& entry = table[index];
+				for (const size_t chord : order)
+				{
+					const MaskType m = chordMasks[chord];
+					if ((m & ~held) == 0 && (m & entry.Suppressed) == 0)
+					{
+						entry.Suppressed |= m;
+						entry.Chords |= ControllerBits::ToMask(ControllerBits::USED_BIT_COUNT + static_cast<int>(chord));
+					}
+				}
+			}
+			m_index_lut = lut;
+			m_table = std::move(table);
+			m_chord_masks = chordMasks;
+			m_input_mask = relevant;
+			return "";
+		}
+		/// <summary>Returns the decision table entry for a controller bitmask.</summary>
+		[[nodiscard]] const Entry& Resolve(const MaskType held) const noexcept
+		{
+			IndexType index{ 0 };
+			for (size_t b = 0; b < LUT_BYTE_COUNT; b++)
+				index |= m_index_lut[b][static_cast<size_t>((held >> (b * 8)) & 0xFF)];
+			return m_table[index];
+		}
+		/// <summary>Replaces chord inputs with their chord bits. Inputs that took part in a chord stay
+		///	suppressed until released, so letting go of one chord input doesn't fire the other's own map.</summary>
+		/// <param name="held">controller bitmask from XInputTranslater</param>
+		/// <param name="latched">in/out, per-consumer state of the inputs still suppressed, start with 0</param>
+		/// <returns>bitmask with suppressed inputs cleared and active chord bits set</returns>
+		[[nodiscard]] MaskType Apply(const MaskType held, MaskType& latched) const noexcept
+		{
+			const Entry& entry = Resolve(held);
+			const MaskType suppressed = entry.Suppressed | latched;
+			latched = suppressed & held;
+			return (held & ~suppressed) | entry.Chords;
+		}
+		/// <summary>Returns the ControllerBits mask of every input used by a chord.</summary>
+		[[nodiscard]] MaskType GetInputMask() const noexcept
+		{
+			return m_input_mask;
+		}
+		[[nodiscard]] size_t GetChordCount() const noexcept
+		{
+			return m_chord_masks.size();
+		}
+		[[nodiscard]] size_t GetTableSize() const noexcept
+		{
+			return m_table.size();
+		}
+	};
+}
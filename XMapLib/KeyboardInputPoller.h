@@ -1,26 +1,46 @@
 #pragma once
 #include "stdafx.h"
 #include "Utilities.h"
+#include "KeystrokeSynthesizer.h"
 
 namespace sds
 {
+	/// <summary>Used to denote where KeyboardInputPoller gets its XINPUT_KEYSTROKE structs from.</summary>
+	enum class KeystrokeSource : int
+	{
+		//A worker thread polls XInputGetKeystroke()
+		XINPUT_KEYSTROKE = 0,
+		//No worker thread, keystrokes are synthesized from the XINPUT_STATE structs passed to FeedState()
+		STATE_FEED = 1
+	};
+
 	/// <summary>
 	/// Polls for input from the XInput library in it's worker thread function.
 	/// Values are used in KeyboardMapper, the main class for use.
+	///	With KeystrokeSource::STATE_FEED there is no polling thread, another poller (MouseInputPoller) calls FeedState()
+	///	with every XINPUT_STATE it polls and the keystrokes are derived from the state diffs.
 	/// </summary>
 	class KeyboardInputPoller
 	{
 		using InternalType = std::vector<XINPUT_KEYSTROKE>;
 		using LambdaRunnerType = sds::CPPRunnerGeneric<InternalType>;
 		using lock = LambdaRunnerType::ScopedLockType;
+		using ClockType = KeystrokeSynthesizer::ClockType;
 		const int EMPTY_COUNT{ 5000 };
 		KeyboardPlayerInfo m_local_player{};
+		const KeystrokeSource m_source{ KeystrokeSource::XINPUT_KEYSTROKE };
+		KeystrokeSynthesizer m_synthesizer{};
+		std::mutex m_synthesizer_mutex{};
+		KeystrokeSynthesizer::PointInTime m_last_fed_stroke{};
+		mutable std::atomic<bool> m_is_feed_running{ false };
 		std::unique_ptr<LambdaRunnerType> m_workThread{};
 		void InitWorkThread() noexcept
 		{
 			m_workThread =
 				std::make_unique<LambdaRunnerType>
 				([this](auto& stopCondition, auto& mut, auto& protectedData) { workThread(stopCondition, mut, protectedData); });
+			m_workThread->ReserveStates(KeyboardSettings::MAX_STATE_COUNT);
+			m_workThread->SetThreadPolicy(Utilities::ThreadPolicy::ForPolling());
 		}
 	public:
 		KeyboardInputPoller()
@@ -29,50 +49,122 @@ namespace sds
 			Start();
 		}
 		explicit KeyboardInputPoller(const KeyboardPlayerInfo& p) : m_local_player(p) { InitWorkThread(); Start(); }
+		/// <summary>Ctor allows choosing the keystroke source, see KeystrokeSource.</summary>
+		KeyboardInputPoller(const KeyboardPlayerInfo& p, const KeystrokeSource source)
+			: m_local_player(p), m_source(source), m_synthesizer(p.player_id)
+		{
+			InitWorkThread();
+			Start();
+		}
 		KeyboardInputPoller(const KeyboardInputPoller& other) = delete;
 		KeyboardInputPoller(KeyboardInputPoller&& other) = delete;
 		KeyboardInputPoller& operator=(const KeyboardInputPoller& other) = delete;
 		KeyboardInputPoller& operator=(KeyboardInputPoller&& other) = delete;
 		~KeyboardInputPoller() = default;
 
-		/// <summary>Returns copy and clears internal one.</summary>
+		/// <summary>Returns the states and leaves the internal buffer empty.</summary>
 		[[nodiscard]] std::vector<XINPUT_KEYSTROKE> getAndClearStates() const
 		{
 			return m_workThread->GetAndClearCurrentStates();
 		}
+		/// <summary>Moves the states into the given buffer and clears the internal one, without allocating
+		///	when the buffer has storage for KeyboardSettings::MAX_STATE_COUNT states.</summary>
+		void GetAndClearStates(std::vector<XINPUT_KEYSTROKE>& out) const
+		{
+			m_workThread->GetAndClearCurrentStates(out);
+		}
 		/// <summary>Start polling for updated XINPUT_KEYSTROKE info.</summary>
 		void Start() const noexcept
 		{
-			if (m_workThread)
+			if (m_source == KeystrokeSource::STATE_FEED)
+				m_is_feed_running = true;
+			else if (m_workThread)
 				m_workThread->StartThread();
 		}
 		/// <summary>Stop input polling.</summary>
 		void Stop() const noexcept
 		{
-			if (m_workThread)
+			if (m_source == KeystrokeSource::STATE_FEED)
+				m_is_feed_running = false;
+			else if (m_workThread)
 				m_workThread->StopThread();
 		}
 		/// <summary>Gets the running status of the worker thread</summary>
 		/// <returns> true if thread is running, false otherwise</returns>
 		[[nodiscard]] bool IsRunning() const noexcept
 		{
+			if (m_source == KeystrokeSource::STATE_FEED)
+				return m_is_feed_running;
 			if (m_workThread)
 				return m_workThread->IsRunning();
 			return false;
 		}
+		[[nodiscard]] KeystrokeSource GetSource() const noexcept
+		{
+			return m_source;
+		}
+		/// <summary>Used with KeystrokeSource::STATE_FEED, synthesizes keystrokes from the polled state.
+		///	Must be called from a single thread, at the polling rate, whether or not the state has changed,
+		///	as the key repeat behavior is driven by these calls. Does nothing while stopped.</summary>
+		/// <param name="state">state obj retrieved from XInputGetState(), zeroed if the call failed</param>
+		void FeedState(const XINPUT_STATE& state)
+		{
+			if (m_source != KeystrokeSource::STATE_FEED)
+				return;
+			if (!m_is_feed_running)
+			{
+				lock synthLock(m_synthesizer_mutex);
+				m_synthesizer.Reset();
+				return;
+			}
+			const auto now = ClockType::now();
+			lock synthLock(m_synthesizer_mutex);
+			auto addElement = [this](const XINPUT_KEYSTROKE& stroke)
+			{
+				if (!m_workThread->TryAddState(stroke, KeyboardSettings::MAX_STATE_COUNT))
+					Utilities::LogAsync(Utilities::LogMessageId::STATE_FEED_BUFFER_DROP);
+			};
+			const size_t count = m_synthesizer.ProcessState(state, now, addElement);
+			//the translator's key repeat and update loops run once per keystroke,
+			//an empty keystroke is added periodically to keep them running when there is no input.
+			if (count > 0)
+				m_last_fed_stroke = now;
+			else if (now - m_last_fed_stroke >= std::chrono::milliseconds(KeyboardSettings::THREAD_DELAY_POLLER))
+			{
+				m_last_fed_stroke = now;
+				addElement(XINPUT_KEYSTROKE{});
+			}
+		}
+		/// <summary>Used with KeystrokeSource::STATE_FEED, sets the compiled chord maps applied to the fed states.</summary>
+		void SetChordTable(std::shared_ptr<const KeyboardChordTable> chords)
+		{
+			lock synthLock(m_synthesizer_mutex);
+			m_synthesizer.SetChordTable(std::move(chords));
+		}
+		/// <summary>Used with KeystrokeSource::STATE_FEED, sets the time a newly pressed chord input is held back
+		///	waiting for the rest of its chord, zero to send it at once.</summary>
+		void SetChordWindow(const std::chrono::microseconds window)
+		{
+			lock synthLock(m_synthesizer_mutex);
+			m_synthesizer.SetChordWindow(window);
+		}
 		/// <summary>Returns status of XINPUT library detecting a controller.</summary>
 		/// <returns> true if controller is connected, false otherwise</returns>
 		[[nodiscard]] bool IsControllerConnected() const noexcept
 		{
-			XINPUT_KEYSTROKE ss{};
-			const DWORD ret = XInputGetKeystroke(m_local_player.player_id,0, &ss);
-			return ret == ERROR_SUCCESS || ret == ERROR_EMPTY;
+			return IsControllerConnected(m_local_player);
 		}
 		/// <summary>Returns status of XINPUT library detecting a controller.
 		/// This overload uses the player_id value in a KeyboardPlayerInfo struct</summary>
 		/// <returns> true if controller is connected, false otherwise</returns>
 		[[nodiscard]] bool IsControllerConnected(const KeyboardPlayerInfo& p) const noexcept
 		{
+			if (m_source == KeystrokeSource::STATE_FEED)
+			{
+				//XInputGetKeystroke() would dequeue a keystroke, the state query has no side effect.
+				XINPUT_STATE ss{};
+				return XInputGetState(p.player_id, &ss) == ERROR_SUCCESS;
+			}
 			XINPUT_KEYSTROKE ss{};
 			const DWORD ret = XInputGetKeystroke(p.player_id, 0, &ss);
 			return ret == ERROR_SUCCESS || ret == ERROR_EMPTY;
@@ -87,7 +179,7 @@ namespace sds
 				if (protectedData.size() < KeyboardSettings::MAX_STATE_COUNT)
 					protectedData.push_back(state);
 				else
-					Utilities::LogError("KeyboardInputPoller::addElement(): State buffer dropping states.");
+					Utilities::LogAsync(Utilities::LogMessageId::KEYSTROKE_BUFFER_DROP);
 			};
 			XINPUT_KEYSTROKE tempState{};
 			int currentCount = 0;
@@ -0,0 +1,89 @@
+#pragma once
+#include "stdafx.h"
+#include <syncstream>
+
+namespace sds
+{
+	/// <summary>
+	/// One step of a macro, a key down, a key up, or a delay before the following steps.
+	/// </summary>
+	struct MacroStep
+	{
+		enum class StepType : int
+		{
+			KEYDOWN = 0,
+			KEYUP = 1,
+			DELAY = 2
+		};
+		StepType Type{ StepType::DELAY };
+		int MappedToVK{ 0 }; // VK of the key or mouse button, for KEYDOWN and KEYUP
+		size_t DelayUs{ 0 }; // microseconds, for DELAY
+		[[nodiscard]] static constexpr MacroStep Down(const int vk) noexcept { return MacroStep{ StepType::KEYDOWN, vk, 0 }; }
+		[[nodiscard]] static constexpr MacroStep Up(const int vk) noexcept { return MacroStep{ StepType::KEYUP, vk, 0 }; }
+		[[nodiscard]] static constexpr MacroStep Wait(const size_t microseconds) noexcept { return MacroStep{ StepType::DELAY, 0, microseconds }; }
+		friend bool operator==(const MacroStep& lhs, const MacroStep& rhs) = default;
+	};
+
+	/// <summary>
+	/// Utility class for holding a controller button to macro map, a timed sequence of key events
+	///	sent when the button is pressed, e.g. { Down(VK_CONTROL), Down('C'), Wait(20000), Up('C'), Up(VK_CONTROL) }.
+	///	Keys still down at the end of the sequence are released.
+	/// </summary>
+	struct KeyboardMacroMap
+	{
+		//Struct members
+		int SendingElementVK{ 0 }; // VK of controller button
+		std::vector<MacroStep> Steps{};
+		//Ctor
+		KeyboardMacroMap(const int controllerElementVK, std::vector<MacroStep> steps)
+			: SendingElementVK(controllerElementVK), Steps(std::move(steps))
+		{
+		}
+		KeyboardMacroMap() = default;
+		KeyboardMacroMap(const KeyboardMacroMap& other) = default;
+		KeyboardMacroMap(KeyboardMacroMap&& other) = default;
+		KeyboardMacroMap& operator=(const KeyboardMacroMap& other) = default;
+		KeyboardMacroMap& operator=(KeyboardMacroMap&& other) = default;
+		~KeyboardMacroMap() = default;
+		/// <summary>Total of the delay steps, in microseconds.</summary>
+		[[nodiscard]] size_t GetDurationUs() const noexcept
+		{
+			size_t total = 0;
+			for (const auto& step : Steps)
+				total += step.DelayUs;
+			return total;
+		}
+		/// <summary>
+		/// Operator<< overload for std::ostream specialization,
+		///	writes more detailed map details for debugging.
+		///	Thread-safe, provided all writes to the ostream object
+		///	are wrapped with std::osyncstream!
+		/// </summary>
+		friend std::ostream& operator<<(std::ostream& os, const KeyboardMacroMap& obj)
+		{
+			std::osyncstream ss(os);
+			ss << "[KeyboardMacroMap]" << " ";
+			ss << "SendingElementVK:" << obj.SendingElementVK << " ";
+			ss << "Steps:";
+			for (const auto& step : obj.Steps)
+			{
+				if (step.Type == MacroStep::StepType::DELAY)
+					ss << "wait(" << step.DelayUs << "us),";
+				else
+					ss << (step.Type == MacroStep::StepType::KEYDOWN ? "down(" : "up(") << step.MappedToVK << "),";
+			}
+			ss << " ";
+			ss << "[/KeyboardMacroMap]" << " ";
+			return os;
+		}
+		friend bool operator==(const KeyboardMacroMap& lhs, const KeyboardMacroMap& rhs)
+		{
+			return lhs.SendingElementVK == rhs.SendingElementVK
+				&& lhs.Steps == rhs.Steps;
+		}
+		friend bool operator!=(const KeyboardMacroMap& lhs, const KeyboardMacroMap& rhs)
+		{
+			return !(lhs == rhs);
+		}
+	};
+}
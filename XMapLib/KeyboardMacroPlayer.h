@@ -0,0 +1,195 @@
+#pragma once
+#include "stdafx.h"
+#include "Utilities.h"
+#include "TimerQueue.h"
+#include "KeyboardMacroMap.h"
+#include <bitset>
+
+namespace sds
+{
+	/// <summary>
+	/// Plays KeyboardMacroMap sequences on a Utilities::TimerQueue, so a long macro never stalls the
+	///	thread processing keystrokes. Steps with no delay between them are sent by one timer callback.
+	///	Pressing the button of a macro still playing cancels the rest of it, releases the keys it holds down,
+	///	and restarts it. Uses its own Utilities::SendKeyInput, only ever called on the timer thread.
+	///	AddMacroMap() and ClearMacroMaps() must not be called concurrently with ProcessKeystroke().
+	/// </summary>
+	class KeyboardMacroPlayer
+	{
+		using TimerType = Utilities::TimerQueue;
+		using GroupType = TimerType::GroupType;
+		using StepType = MacroStep::StepType;
+		static constexpr size_t VK_COUNT{ 256 };
+		const std::string ERR_BAD_VK{ "KeyboardMacroPlayer::AddMacroMap(): SendingElementVK <= 0, or a step VK outside [1,255]." };
+		const std::string ERR_NO_STEPS{ "KeyboardMacroPlayer::AddMacroMap(): Macro has no key steps." };
+		//Key steps [First,Last) of the macro sent together at Offset from the start.
+		struct Batch
+		{
+			std::chrono::microseconds Offset{ 0 };
+			size_t First{ 0 };
+			size_t Last{ 0 };
+		};
+		struct MacroRuntime
+		{
+			KeyboardMacroMap Map{};
+			std::vector<Batch> Batches{};
+			std::bitset<VK_COUNT> HeldKeys{}; // timer thread only
+		};
+		std::shared_ptr<TimerType> m_timer{};
+		//unique_ptr, timer callbacks hold references to the runtime state
+		std::vector<std::unique_ptr<MacroRuntime>> m_macros{};
+		Utilities::SendKeyInput m_key_send{}; // timer thread only
+	public:
+		inline static const std::string ERR_DUP_MACRO{ "KeyboardMacroPlayer::AddMacroMap(): A macro is already mapped to the SendingElementVK." };
+		KeyboardMacroPlayer() = default;
+		explicit KeyboardMacroPlayer(std::shared_ptr<TimerType> timer) : m_timer(std::move(timer)) { }
+		KeyboardMacroPlayer(const KeyboardMacroPlayer& other) = delete;
+		KeyboardMacroPlayer(KeyboardMacroPlayer&& other) = delete;
+		KeyboardMacroPlayer& operator=(const KeyboardMacroPlayer& other) = delete;
+		KeyboardMacroPlayer& operator=(KeyboardMacroPlayer&& other) = delete;
+		~KeyboardMacroPlayer()
+		{
+			ClearMacroMaps();
+		}
+		/// <summary>Starts the macro mapped to the keystroke's button, on a KEYDOWN that isn't a repeat.</summary>
+		/// <returns>true if a macro was started</returns>
+		bool ProcessKeystroke(const XINPUT_KEYSTROKE& stroke)
+		{
+			if (!(stroke.Flags & XINPUT_KEYSTROKE_KEYDOWN) || (stroke.Flags & XINPUT_KEYSTROKE_REPEAT))
+				return false;
+			for (const auto& macro : m_macros)
+			{
+				if (macro->Map.SendingElementVK == stroke.VirtualKey)
+				{
+					Play(*macro);
+					return true;
+				}
+			}
+			return false;
+		}
+		/// <summary>Checks the macro's virtual keys and steps, without the check for a duplicate SendingElementVK.</summary>
+		/// <returns>a std::string containing an error message if the macro is unusable, empty string otherwise.</returns>
+		[[nodiscard]] std::string CheckMacroMap(const KeyboardMacroMap& macro) const
+		{
+			if (macro.SendingElementVK <= 0)
+				return ERR_BAD_VK;
+			bool hasKeyStep = false;
+			for (const MacroStep& step : macro.Steps)
+			{
+				if (step.Type == StepType::DELAY)
+					continue;
+				if (step.MappedToVK <= 0 || static_cast<size_t>(step.MappedToVK) >= VK_COUNT)
+					return ERR_BAD_VK;
+				hasKeyStep = true;
+			}
+			return hasKeyStep ? "" : ERR_NO_STEPS;
+		}
+		/// <returns>a std::string containing an error message if there is an error, empty string otherwise.</returns>
+		std::string AddMacroMap(KeyboardMacroMap macro)
+		{
+			std::string er = CheckMacroMap(macro);
+			if (!er.empty())
+				return er;
+			if (std::ranges::any_of(m_macros, [&macro](const auto& m) { return m->Map.SendingElementVK == macro.SendingElementVK; }))
+				return ERR_DUP_MACRO;
+			auto runtime = std::make_unique<MacroRuntime>();
+			std::chrono::microseconds offset{ 0 };
+			for (size_t i = 0; i < macro.Steps.size(); i++)
+			{
+				const MacroStep& step = macro.Steps[i];
+				if (step.Type == StepType::DELAY)
+				{
+					offset += std::chrono::microseconds(step.DelayUs);
+					continue;
+				}
+				if (runtime->Batches.empty() || runtime->Batches.back().Offset != offset)
+					runtime->Batches.push_back(Batch{ offset, i, i + 1 });
+				else
+					runtime->Batches.back().Last = i + 1;
+			}
+			runtime->Map = std::move(macro);
+			GetTimerQueue();
+			m_macros.push_back(std::move(runtime));
+			return "";
+		}
+		/// <summary>Cancels macros in progress and releases the keys they hold down, waits for the timer thread to do so.</summary>
+		void CancelAll()
+		{
+			if (!m_timer || m_macros.empty())
+				return;
+			for (const auto& macro : m_macros)
+				m_timer->Cancel(GetGroup(*macro));
+			m_timer->RunAndWait(0, [this]()
+			{
+				for (const auto& macro : m_macros)
+					ReleaseHeld(*macro);
+			});
+		}
+		void ClearMacroMaps()
+		{
+			CancelAll();
+			m_macros.clear();
+		}
+		[[nodiscard]] std::vector<KeyboardMacroMap> GetMacroMaps() const
+		{
+			std::vector<KeyboardMacroMap> maps;
+			for (const auto& macro : m_macros)
+				maps.push_back(macro->Map);
+			return maps;
+		}
+		/// <summary>Returns the timer queue used, creating one if none was set.</summary>
+		std::shared_ptr<TimerType> GetTimerQueue()
+		{
+			if (!m_timer)
+				m_timer = std::make_shared<TimerType>();
+			return m_timer;
+		}
+		/// <summary>Sets the timer queue to share with other timed outputs, macros in progress are cancelled.
+		///	With nullptr a new one is created on the next use.</summary>
+		void SetTimerQueue(std::shared_ptr<TimerType> timer)
+		{
+			CancelAll();
+			m_timer = std::move(timer);
+		}
+	private:
+		[[nodiscard]] static GroupType GetGroup(const MacroRuntime& macro) noexcept
+		{
+			return static_cast<GroupType>(reinterpret_cast<std::uintptr_t>(&macro));
+		}
+		void Play(MacroRuntime& macro)
+		{
+			const GroupType group = GetGroup(macro);
+			const auto start = TimerType::ClockType::now();
+			TimerType& timer = *GetTimerQueue();
+			//a re-press cancels the remaining steps, the release is queued after any callback already running
+			timer.Cancel(group);
+			timer.Schedule(start, group, [this, &macro]() { ReleaseHeld(macro); });
+			for (const Batch& batch : macro.Batches)
+				timer.Schedule(start + batch.Offset, group, [this, &macro, &batch]() { SendBatch(macro, batch); });
+			timer.Schedule(start + macro.Batches.back().Offset, group, [this, &macro]() { ReleaseHeld(macro); });
+		}
+		void SendBatch(MacroRuntime& macro, const Batch& batch) noexcept
+		{
+			for (size_t i = batch.First; i < batch.Last; i++)
+			{
+				const MacroStep& step = macro.Map.Steps[i];
+				if (step.Type == StepType::DELAY)
+					continue;
+				const bool isDown = step.Type == StepType::KEYDOWN;
+				m_key_send.SendScanCode(step.MappedToVK, isDown);
+				macro.HeldKeys.set(static_cast<size_t>(step.MappedToVK), isDown);
+			}
+		}
+		void ReleaseHeld(MacroRuntime& macro) noexcept
+		{
+			for (size_t vk = 0; macro.HeldKeys.any() && vk < VK_COUNT; vk++)
+			{
+				if (macro.HeldKeys.test(vk))
+				{
+					m_key_send.SendScanCode(static_cast<int>(vk), false);
+					macro.HeldKeys.reset(vk);
+				}
+			}
+		}
+	};
+}
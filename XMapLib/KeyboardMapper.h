@@ -2,27 +2,46 @@
 #include "stdafx.h"
 #include "KeyboardInputPoller.h"
 #include "KeyboardTranslator.h"
+#include "KeyboardChordMap.h"
 
 namespace sds
 {
 	/// <summary>
 	/// Main class for use, for mapping controller input to keyboard input.
-	/// Uses KeyboardKeyMap for the details.
+	/// Uses KeyboardKeyMap for the details, KeyboardChordMap for chords (KeystrokeSource::STATE_FEED only),
+	/// and KeyboardMacroMap for timed key sequences.
+	///	Map changes are validated on the calling thread and posted to the worker, which applies them at the top of its next tick,
+	///	so keystroke processing is never stopped or locked for them. The getters return the configured maps.
 	/// </summary>
 	class KeyboardMapper
 	{
 		using InternalType = int;
 		using LambdaRunnerType = sds::CPPRunnerGeneric<InternalType>;
 		using lock = LambdaRunnerType::ScopedLockType;
+		const std::string ERR_CHORD_SOURCE{ "KeyboardMapper::AddChordMap(): Chord maps require KeystrokeSource::STATE_FEED." };
+		const std::string ERR_CHORD_INPUT{ "KeyboardMapper::AddChordMap(): Chord contains a VK without a ControllerBits bit." };
 		sds::KeyboardPlayerInfo m_localPlayerInfo{};
 		sds::KeyboardInputPoller m_poller{};
-		sds::KeyboardTranslator m_translator{};
+		sds::KeyboardTranslator m_translator{}; // worker thread only, once started
+		std::function<void()> m_key_flush{}; // worker thread only
+		//The configured maps, for the getters and validation, written under m_config_mutex by the callers.
+		mutable std::mutex m_config_mutex{};
+		std::vector<KeyboardKeyMap> m_maps{};
+		std::vector<KeyboardMacroMap> m_macro_maps{};
+		std::vector<KeyboardChordMap> m_chords{};
+		std::shared_ptr<Utilities::TimerQueue> m_timer{};
+		//Changes to the translator and poller, applied by the worker.
+		Utilities::CommandQueue m_commands{};
 		std::unique_ptr<LambdaRunnerType> m_workThread{};
 		void InitWorkThread() noexcept
 		{
 			m_workThread =
 				std::make_unique<LambdaRunnerType>
 				([this](auto& stopCondition, auto& mut, auto& protectedData) { workThread(stopCondition, mut, protectedData); });
+			m_workThread->SetThreadPolicy(Utilities::ThreadPolicy::ForPolling());
+#ifdef __linux__
+			SetKeySink({});
+#endif
 		}
 	public:
 		/// <summary>Ctor for default configuration</summary>
@@ -37,6 +56,14 @@ namespace sds
 			InitWorkThread();
 			Start();
 		}
+		/// <summary>Ctor allows setting a custom KeyboardPlayerInfo and the keystroke source.
+		///	With KeystrokeSource::STATE_FEED no keystroke polling thread is used, pass every polled
+		///	XINPUT_STATE to FeedState(), see MouseMapper::SetStateListener().</summary>
+		KeyboardMapper(const sds::KeyboardPlayerInfo& player, const KeystrokeSource source) : m_localPlayerInfo(player), m_poller(player, source)
+		{
+			InitWorkThread();
+			Start();
+		}
 		KeyboardMapper(const KeyboardMapper& other) = delete;
 		KeyboardMapper(KeyboardMapper&& other) = delete;
 		KeyboardMapper& operator=(const KeyboardMapper& other) = delete;
@@ -50,6 +77,30 @@ namespace sds
 		{
 			return m_poller.IsControllerConnected();
 		}
+		/// <summary>Used with KeystrokeSource::STATE_FEED, see KeyboardInputPoller::FeedState().</summary>
+		void FeedState(const XINPUT_STATE& state)
+		{
+			m_poller.FeedState(state);
+		}
+		/// <summary>Sets a function receiving the key events in place of SendInput, and an optional function called
+		///	at the end of each worker tick, so a batching output such as Utilities::SendUinput writes a tick's key events together.
+		///	Applied by the worker on its next tick, pass empty functions to send input.
+		///	On Linux sending input queues the keys to the shared uinput device, flushed once per tick.</summary>
+		void SetKeySink(KeyboardTranslator::KeySinkType sink, std::function<void()> flush = {})
+		{
+#ifdef __linux__
+			if (!sink)
+			{
+				sink = [](const int vk, const bool down) { Utilities::SendUinput::GetShared().QueueKey(vk, down); };
+				flush = []() { Utilities::SendUinput::GetShared().Flush(); };
+			}
+#endif
+			m_commands.Post([this, sink = std::move(sink), flush = std::move(flush)]()
+			{
+				m_translator.SetKeySink(sink);
+				m_key_flush = flush;
+			});
+		}
 		[[nodiscard]] bool IsRunning() const
 		{
 			return m_poller.IsRunning() && m_workThread->IsRunning();
@@ -59,43 +110,151 @@ namespace sds
 			m_poller.Start();
 			m_workThread->StartThread();
 		}
+		/// <summary>Stops the threads, the worker releases the keys held down before it stops.</summary>
 		void Stop() noexcept
 		{
-			m_translator.CleanupInProgressEvents();
 			m_poller.Stop();
 			m_workThread->StopThread();
 		}
+		/// <summary>Adds a key map, applied by the worker on its next tick.</summary>
+		/// <returns>a std::string containing an error message if there is an error, empty string otherwise.</returns>
 		std::string AddMap(KeyboardKeyMap button)
 		{
-			if (IsRunning())
-				Stop();
-			std::string er = m_translator.AddKeyMap(button);
-			if (er.empty())
-				Start();
-			return er;
+			std::string er = m_translator.CheckForVKError(button);
+			if (!er.empty())
+				return er;
+			std::lock_guard configLock(m_config_mutex);
+			m_maps.push_back(button);
+			m_commands.Post([this, button]() { m_translator.AddKeyMap(button); });
+			return "";
+		}
+		/// <summary>Adds a chord map, compiling all chord maps into the table used to resolve them.
+		///	The chord is reported to the translator with a synthesized VK, a KeyboardKeyMap for it is added.</summary>
+		/// <returns>a std::string containing an error message if there is an error, empty string otherwise.</returns>
+		std::string AddChordMap(const KeyboardChordMap& chord)
+		{
+			if (m_poller.GetSource() != KeystrokeSource::STATE_FEED)
+				return ERR_CHORD_SOURCE;
+			std::lock_guard configLock(m_config_mutex);
+			std::vector<ControllerBits::MaskType> masks;
+			for (const auto& c : m_chords)
+				masks.push_back(c.GetSendingMask());
+			masks.push_back(chord.GetSendingMask());
+			if (masks.back() == 0)
+				return ERR_CHORD_INPUT;
+			auto table = std::make_shared<KeyboardChordTable>();
+			std::string er = table->Compile(masks);
+			if (!er.empty())
+				return er;
+			const int chordVk = ControllerBits::GetVirtualKey(ControllerBits::USED_BIT_COUNT + static_cast<int>(m_chords.size()));
+			const KeyboardKeyMap button{ chordVk, chord.MappedToVK, chord.UsesRepeat };
+			er = m_translator.CheckForVKError(button);
+			if (!er.empty())
+				return er;
+			m_chords.push_back(chord);
+			m_maps.push_back(button);
+			//the map is added before the table reporting the chord's VK is used
+			m_commands.Post([this, button, table = std::shared_ptr<const KeyboardChordTable>(std::move(table))]()
+			{
+				m_translator.AddKeyMap(button);
+				m_poller.SetChordTable(table);
+			});
+			return "";
+		}
+		/// <summary>Sets the time a newly pressed chord input is held back waiting for the rest of its chord,
+		///	so the chord inputs may be pressed in any order. Zero sends chord inputs at once,
+		///	then pressing A before LB for an LB+A chord sends A's own map before the chord's.</summary>
+		void SetChordWindow(const std::chrono::microseconds window)
+		{
+			m_poller.SetChordWindow(window);
+		}
+		/// <summary>Adds a macro map, played on the timer queue without blocking keystroke processing.
+		///	Applied by the worker on its next tick.</summary>
+		/// <returns>a std::string containing an error message if there is an error, empty string otherwise.</returns>
+		std::string AddMacroMap(KeyboardMacroMap macro)
+		{
+			std::string er = m_translator.CheckMacroMap(macro);
+			if (!er.empty())
+				return er;
+			std::lock_guard configLock(m_config_mutex);
+			if (std::ranges::any_of(m_macro_maps, [&macro](const auto& m) { return m.SendingElementVK == macro.SendingElementVK; }))
+				return KeyboardMacroPlayer::ERR_DUP_MACRO;
+			GetTimerQueueLocked();
+			m_macro_maps.push_back(macro);
+			m_commands.Post([this, macro]() { m_translator.AddMacroMap(macro); });
+			return "";
+		}
+		/// <summary>Returns the timer queue macros are played on, for sharing with other timed outputs.</summary>
+		[[nodiscard]] std::shared_ptr<Utilities::TimerQueue> GetTimerQueue()
+		{
+			std::lock_guard configLock(m_config_mutex);
+			return GetTimerQueueLocked();
+		}
+		[[nodiscard]] std::vector<KeyboardMacroMap> GetMacroMaps() const
+		{
+			std::lock_guard configLock(m_config_mutex);
+			return m_macro_maps;
 		}
 		[[nodiscard]] std::vector<KeyboardKeyMap> GetMaps() const
 		{
-			return m_translator.GetMaps();
+			std::lock_guard configLock(m_config_mutex);
+			return m_maps;
 		}
+		[[nodiscard]] std::vector<KeyboardChordMap> GetChordMaps() const
+		{
+			std::lock_guard configLock(m_config_mutex);
+			return m_chords;
+		}
+		/// <summary>Removes every map, applied by the worker on its next tick, which releases the keys held down first.</summary>
 		void ClearMaps()
 		{
-			m_translator.ClearMaps();
+			std::lock_guard configLock(m_config_mutex);
+			m_maps.clear();
+			m_macro_maps.clear();
+			m_chords.clear();
+			m_commands.Post([this]()
+			{
+				m_translator.CleanupInProgressEvents();
+				m_translator.ClearMaps();
+				m_poller.SetChordTable(nullptr);
+			});
 		}
 	protected:
 		/// <summary>Worker thread, protected visibility.</summary>
 		void workThread(auto& stopCondition, auto&, auto&)
 		{
+			//swapped with the poller's buffer, storage for both is reserved so the loop doesn't allocate
+			std::vector<XINPUT_KEYSTROKE> states;
+			states.reserve(KeyboardSettings::MAX_STATE_COUNT);
 			//thread main loop
 			while (!stopCondition)
 			{
-				const std::vector<XINPUT_KEYSTROKE> states = m_poller.getAndClearStates();
+				//apply the configuration changes first, they are for the keystrokes polled since
+				m_commands.Drain();
+				m_poller.GetAndClearStates(states);
 				for(const auto &cur: states)
 				{
 					m_translator.ProcessKeystroke(cur);
 				}
+				if (m_key_flush)
+					m_key_flush();
 				std::this_thread::sleep_for(std::chrono::milliseconds(KeyboardSettings::THREAD_DELAY_POLLER));
 			}
+			m_commands.Drain();
+			m_translator.CleanupInProgressEvents();
+			if (m_key_flush)
+				m_key_flush();
+		}
+	private:
+		/// <summary>Creates the timer queue on first use, and posts it to the translator, m_config_mutex must be held.</summary>
+		std::shared_ptr<Utilities::TimerQueue> GetTimerQueueLocked()
+		{
+			if (!m_timer)
+			{
+				m_timer = std::make_shared<Utilities::TimerQueue>();
+				m_commands.Post([this, timer = m_timer]() { m_translator.SetTimerQueue(timer); });
+			}
+			return m_timer;
 		}
 	};
 }
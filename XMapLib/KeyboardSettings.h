@@ -12,6 +12,27 @@ namespace sds
 		static constexpr int THREAD_DELAY_POLLER{ 10 };
 		//Microseconds Delay Keyrepeat is the time delay a button has in between activations.
 		static constexpr int MICROSECONDS_DELAY_KEYREPEAT{ 100000 };
+		//Thumbstick deadzones used when translating thumbstick values to direction virtual keys.
+		static constexpr int LEFT_STICK_DEADZONE{ XINPUT_GAMEPAD_LEFT_THUMB_DEADZONE };
+		static constexpr int RIGHT_STICK_DEADZONE{ XINPUT_GAMEPAD_RIGHT_THUMB_DEADZONE };
+		//Trigger value above which the trigger is considered depressed.
+		static constexpr int TRIGGER_THRESHOLD{ XINPUT_GAMEPAD_TRIGGER_THRESHOLD };
+		//Maximum rate, in actions per second, of a TriggerMap rate modulated output.
+		static constexpr float TRIGGER_RATE_MAX{ 100.0f };
+		//Longest time, in microseconds, a key tapped by a TriggerMap is held down before the key-up.
+		static constexpr int TRIGGER_TAP_HOLD_MICROSECONDS{ 15000 };
+		//Default period, in microseconds, over which a StickPwmMap key is held for the duty cycle.
+		static constexpr int PWM_PERIOD_MICROSECONDS{ 50000 };
+		//Bounds for the StickPwmMap period, in microseconds.
+		static constexpr int PWM_PERIOD_MIN_MICROSECONDS{ 10000 };
+		static constexpr int PWM_PERIOD_MAX_MICROSECONDS{ 500000 };
+		//Default and maximum number of StickPwmMap duty cycle steps per period.
+		static constexpr int PWM_DUTY_STEPS{ 64 };
+		static constexpr int PWM_DUTY_STEPS_MAX{ 1000 };
+		//Maximum number of distinct controller inputs used across all chord maps, the chord decision table has 2^N entries.
+		static constexpr int MAX_CHORD_INPUT_BITS{ 16 };
+		//Time, in microseconds, a newly pressed chord input is held back waiting for the rest of its chord.
+		static constexpr int MICROSECONDS_CHORD_WINDOW{ 40000 };
 		//It is necessary to be able to distinguish these mapping values in KeyboardTranslator.
 		static constexpr std::array<int,8> THUMBSTICK_L_VK_LIST
 		{
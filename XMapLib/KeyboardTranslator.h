@@ -2,9 +2,13 @@
 #include "stdafx.h"
 #include "Utilities.h"
 #include "KeyboardKeyMap.h"
+#include "KeyboardMacroPlayer.h"
+#include "KeyStateTable.h"
 
 #include <iostream>
 #include <chrono>
+#include <optional>
+#include <bitset>
 
 
 namespace sds
@@ -12,17 +16,43 @@ namespace sds
 	/// <summary>
 	/// Contains the logic for determining if a key press or mouse click should occur, uses sds::Utilities::SendKeyInput m_key_send to send the input.
 	///	Function ProcessKeystroke(XINPUT_KEYSTROKE &stroke) is used to process a controller input structure.
+	///	The key maps are stored as separate packed arrays, the configuration is only written by AddKeyMap() and ClearMaps(),
+	///	the runtime state is only written by keystroke processing, and both are indexed by the key map's position.
+	///	Timing uses the time passed to ProcessKeystroke(), so the translator may be driven by a virtual clock, see PipelineSimulator.
+	///	Maps sending the same virtual key share its output state in a KeyStateTable, the key is sent down by the first map
+	///	holding it, up by the last, and repeated once per repeat pass.
 	/// </summary>
 	class KeyboardTranslator
 	{
 		using ClockType = std::chrono::high_resolution_clock;
 		using PointInTime = std::chrono::time_point<ClockType>;
 		using InpType = sds::KeyboardKeyMap::ActionType;
+	public:
+		/// <summary>Receives each key event in place of SendInput, virtual key and true for key-down.</summary>
+		using KeySinkType = std::function<void(int, bool)>;
 		const std::string ERR_BAD_VK{ "Either WordData.MappedToVK OR WordData.SendElementVK is <= 0" };
 		const std::string ERR_DUP_KEYUP{ "Sent a duplicate keyup event to handle thumbstick direction changing behavior." };
 	private:
+		/// <summary>Key map configuration, read-only while keystrokes are processed.</summary>
+		struct KeyMapConfig
+		{
+			std::vector<int> SendingElementVK{};
+			std::vector<int> MappedToVK{};
+			std::vector<std::uint8_t> UsesRepeat{};
+			[[nodiscard]] size_t size() const noexcept { return SendingElementVK.size(); }
+		};
+		/// <summary>Key map runtime state, the last action sent and the time the key may next be repeated or reset.</summary>
+		struct KeyMapRuntime
+		{
+			std::vector<InpType> LastAction{};
+			std::vector<PointInTime> NextSendTime{};
+		};
 		Utilities::SendKeyInput m_key_send{};
-		std::vector<KeyboardKeyMap> m_map_token_info{};
+		KeySinkType m_key_sink{};
+		KeyMapConfig m_config{};
+		KeyMapRuntime m_runtime{};
+		KeyStateTable m_key_state{};
+		KeyboardMacroPlayer m_macros{};
 		KeyboardPlayerInfo m_local_player{};
 	public:
 		explicit KeyboardTranslator(const KeyboardPlayerInfo &p) : m_local_player(p)
@@ -36,141 +66,206 @@ namespace sds
 		~KeyboardTranslator() = default;
 
 		void ProcessKeystroke(const XINPUT_KEYSTROKE &stroke)
+		{
+			ProcessKeystroke(stroke, ClockType::now());
+		}
+		/// <param name="stroke">keystroke to process, an empty one only runs the key update and repeat loops</param>
+		/// <param name="now">current time, used for the key repeat behavior</param>
+		void ProcessKeystroke(const XINPUT_KEYSTROKE& stroke, const PointInTime now)
 		{
 			//Key update loop
-			KeyUpdateLoop();
+			KeyUpdateLoop(now);
 			//Key repeat loop
-			KeyRepeatLoop();
+			KeyRepeatLoop(now);
+			//start a macro, returns immediately
+			m_macros.ProcessKeystroke(stroke);
 			//search the map for a matching virtual key and send it
-			for(auto &w: m_map_token_info)
+			for (size_t i = 0; i < m_config.size(); i++)
 			{
-				if (w.SendingElementVK == stroke.VirtualKey)
+				if (m_config.SendingElementVK[i] == stroke.VirtualKey)
 				{
-					this->Normal(w, stroke);
+					this->Normal(i, stroke, now);
 				}
 			}
 		}
 		/// <summary>Call this function to send key-ups for any in-progress key presses.</summary>
 		void CleanupInProgressEvents()
 		{
-			for(auto &m: m_map_token_info)
+			m_macros.CancelAll();
+			const auto now = ClockType::now();
+			for (size_t i = 0; i < m_config.size(); i++)
 			{
-				if(m.LastAction == InpType::KEYDOWN || m.LastAction == InpType::KEYREPEAT)
+				if (m_runtime.LastAction[i] == InpType::KEYDOWN || m_runtime.LastAction[i] == InpType::KEYREPEAT)
 				{
-					this->DoOvertaking(m);
+					this->DoOvertaking(i, now);
 				}
 			}
 		}
+		/// <returns>a std::string containing an error message if the key map is unusable, empty string otherwise.</returns>
+		[[nodiscard]] std::string CheckForVKError(const KeyboardKeyMap& detail) const
+		{
+			if ((detail.MappedToVK <= 0) || (detail.SendingElementVK <= 0))
+			{
+				std::stringstream error;
+				error << detail;
+				return std::string("Contents:\n") + error.str() + ERR_BAD_VK;
+			}
+			return "";
+		}
+		/// <summary>See KeyboardMacroPlayer::CheckMacroMap().</summary>
+		[[nodiscard]] std::string CheckMacroMap(const KeyboardMacroMap& macro) const
+		{
+			return m_macros.CheckMacroMap(macro);
+		}
 		std::string AddKeyMap(KeyboardKeyMap w)
 		{
 			std::string result = CheckForVKError(w);
 			if (!result.empty())
 				return result;
-			m_map_token_info.push_back(w);
+			m_config.SendingElementVK.push_back(w.SendingElementVK);
+			m_config.MappedToVK.push_back(w.MappedToVK);
+			m_config.UsesRepeat.push_back(w.UsesRepeat);
+			m_runtime.LastAction.push_back(InpType::NONE);
+			m_runtime.NextSendTime.push_back(PointInTime{});
 			return "";
 		}
-		void ClearMaps() noexcept
+		std::string AddMacroMap(KeyboardMacroMap macro)
+		{
+			return m_macros.AddMacroMap(std::move(macro));
+		}
+		void ClearMaps()
+		{
+			m_config = {};
+			m_runtime = {};
+			m_key_state.Clear();
+			m_macros.ClearMacroMaps();
+		}
+		/// <summary>Returns the key maps, with the last action sent for each.</summary>
+		[[nodiscard]] std::vector<KeyboardKeyMap> GetMaps() const
+		{
+			std::vector<KeyboardKeyMap> maps;
+			maps.reserve(m_config.size());
+			for (size_t i = 0; i < m_config.size(); i++)
+			{
+				maps.emplace_back(m_config.SendingElementVK[i], m_config.MappedToVK[i], m_config.UsesRepeat[i] != 0);
+				maps.back().LastAction = m_runtime.LastAction[i];
+			}
+			return maps;
+		}
+		[[nodiscard]] std::vector<KeyboardMacroMap> GetMacroMaps() const
+		{
+			return m_macros.GetMacroMaps();
+		}
+		/// <summary>Returns the timer queue macros are played on, for sharing with other timed outputs.</summary>
+		std::shared_ptr<Utilities::TimerQueue> GetTimerQueue()
+		{
+			return m_macros.GetTimerQueue();
+		}
+		void SetTimerQueue(std::shared_ptr<Utilities::TimerQueue> timer)
 		{
-			m_map_token_info.clear();
+			m_macros.SetTimerQueue(std::move(timer));
 		}
-		[[nodiscard]] std::vector<KeyboardKeyMap> GetMaps() const noexcept
+		/// <summary>Sets a function receiving the key events in place of SendInput, or an empty one to send input.
+		///	Must not be called concurrently with keystroke processing.</summary>
+		void SetKeySink(KeySinkType sink)
 		{
-			return m_map_token_info;
+			m_key_sink = std::move(sink);
+		}
+		/// <summary>Returns the number of key maps holding the virtual key down.</summary>
+		[[nodiscard]] KeyStateTable::CountType GetKeyHolderCount(const int vk) const noexcept
+		{
+			return m_key_state.GetHolderCount(vk);
 		}
 	private:
-		void KeyUpdateLoop()
+		void KeyUpdateLoop(const PointInTime now)
 		{
 			//If enough time has passed, reset the key for use again, provided it uses the key-repeat behavior--
 			//otherwise reset it immediately.
-			for(auto &e: m_map_token_info)
+			for (size_t i = 0; i < m_runtime.LastAction.size(); i++)
 			{
-				const bool DoUpdate = (e.LastAction == InpType::KEYUP && e.LastSentTime.IsElapsed()) && e.UsesRepeat;
-				const bool DoImmediate = e.LastAction == InpType::KEYUP && !e.UsesRepeat;
-				if (DoUpdate || DoImmediate)
-					e.LastAction = InpType::NONE;
+				if (m_runtime.LastAction[i] == InpType::KEYUP && (!m_config.UsesRepeat[i] || now > m_runtime.NextSendTime[i]))
+					m_runtime.LastAction[i] = InpType::NONE;
 			}
 		}
-		void KeyRepeatLoop()
+		void KeyRepeatLoop(const PointInTime now)
 		{
-			for(auto &w: m_map_token_info)
+			//a key held by several maps due together is repeated once
+			std::bitset<KeyStateTable::VK_COUNT> repeated;
+			for (size_t i = 0; i < m_runtime.LastAction.size(); i++)
 			{
-				using AT = sds::KeyboardKeyMap::ActionType;
-				if (w.UsesRepeat && (((w.LastAction == AT::KEYDOWN) || (w.LastAction == AT::KEYREPEAT))))
+				const InpType action = m_runtime.LastAction[i];
+				if ((action == InpType::KEYDOWN || action == InpType::KEYREPEAT) && m_config.UsesRepeat[i] && now > m_runtime.NextSendTime[i])
 				{
-					if (w.LastSentTime.IsElapsed())
-						this->SendTheKey(w, true, AT::KEYREPEAT);
+					const int vk = m_config.MappedToVK[i];
+					const bool isDuplicate = KeyStateTable::IsTracked(vk) && repeated.test(static_cast<size_t>(vk));
+					if (KeyStateTable::IsTracked(vk))
+						repeated.set(static_cast<size_t>(vk));
+					this->SendTheKey(i, true, InpType::KEYREPEAT, now, !isDuplicate);
 				}
 			}
 		}
 		/// <summary>Normal keypress simulation logic.</summary>
-		void Normal(KeyboardKeyMap &detail, const XINPUT_KEYSTROKE &stroke)
+		void Normal(const size_t index, const XINPUT_KEYSTROKE &stroke, const PointInTime now)
 		{
-			const bool DoDown = (detail.LastAction == InpType::NONE) && (stroke.Flags & static_cast<WORD>(InpType::KEYDOWN));
-			const bool DoUp = ((detail.LastAction == InpType::KEYDOWN) || (detail.LastAction == InpType::KEYREPEAT)) && (stroke.Flags & static_cast<WORD>(InpType::KEYUP));
+			const InpType action = m_runtime.LastAction[index];
+			const bool DoDown = (action == InpType::NONE) && (stroke.Flags & static_cast<WORD>(InpType::KEYDOWN));
+			const bool DoUp = ((action == InpType::KEYDOWN) || (action == InpType::KEYREPEAT)) && (stroke.Flags & static_cast<WORD>(InpType::KEYUP));
 			if (DoDown)
 			{
-				KeyboardKeyMap overtaken;
-				if (IsOvertaking(detail,overtaken))
-					DoOvertaking(overtaken);
+				if (const auto overtaken = GetOvertaken(index))
+					DoOvertaking(*overtaken, now);
 				else
-					SendTheKey(detail, true, InpType::KEYDOWN);
+					SendTheKey(index, true, InpType::KEYDOWN, now);
 			}
 			else if (DoUp)
 			{
-				SendTheKey(detail, false, InpType::KEYUP);
+				SendTheKey(index, false, InpType::KEYUP, now);
 			}
 		}
-		/// <summary>Does the key send call, updates LastAction and updates LastSentTime</summary>
-		void SendTheKey(KeyboardKeyMap& mp, const bool keyDown, KeyboardKeyMap::ActionType action) noexcept
+		/// <summary>Does the key send call, updates LastAction and updates NextSendTime.
+		///	Key-downs and key-ups are only sent by the first and last holder of the virtual key.</summary>
+		/// <param name="isRepeatSent">for a KEYREPEAT, false if another map already repeated the key this pass</param>
+		void SendTheKey(const size_t index, const bool keyDown, const InpType action, const PointInTime now, const bool isRepeatSent = true)
 		{
-			//std::cerr << mp << std::endl; // temp logging
-			mp.LastAction = action;
-			m_key_send.SendScanCode(mp.MappedToVK, keyDown);
-			mp.LastSentTime.Reset(KeyboardSettings::MICROSECONDS_DELAY_KEYREPEAT); // update last sent time
+			m_runtime.LastAction[index] = action;
+			const int vk = m_config.MappedToVK[index];
+			bool isSent = isRepeatSent;
+			if (action != InpType::KEYREPEAT)
+				isSent = keyDown ? m_key_state.Press(vk) : m_key_state.Release(vk);
+			if (isSent)
+			{
+				if (m_key_sink)
+					m_key_sink(vk, keyDown);
+				else
+					m_key_send.SendScanCode(vk, keyDown);
+			}
+			m_runtime.NextSendTime[index] = now + std::chrono::microseconds(KeyboardSettings::MICROSECONDS_DELAY_KEYREPEAT); // update last sent time
 		}
 		/// <summary>Check to see if a different axis of the same thumbstick has been pressed already</summary>
-		/// <param name="detail">Newest element being set to keydown state</param>
-		///	<param name="outOvertaken">out key set to the one being overtaken</param>
-		/// <returns>true if is overtaking a thumbstick direction already depressed</returns>
-		[[nodiscard]] bool IsOvertaking(const KeyboardKeyMap &detail, KeyboardKeyMap &outOvertaken)
-		{
-			//Is detail a thumbstick direction map, and if so, which thumbstick.
-			const auto leftAxisIterator = std::ranges::find(KeyboardSettings::THUMBSTICK_L_VK_LIST, detail.SendingElementVK);
-			const auto rightAxisIterator = std::ranges::find(KeyboardSettings::THUMBSTICK_R_VK_LIST, detail.SendingElementVK);
-			const bool leftStick = leftAxisIterator != KeyboardSettings::THUMBSTICK_L_VK_LIST.end();
-			const bool rightStick = rightAxisIterator != KeyboardSettings::THUMBSTICK_R_VK_LIST.end();
+		/// <param name="index">Newest element being set to keydown state</param>
+		/// <returns>index of the map of the thumbstick direction already depressed, being overtaken, or empty</returns>
+		[[nodiscard]] std::optional<size_t> GetOvertaken(const size_t index) const noexcept
+		{
+			//Is the map a thumbstick direction map, and if so, which thumbstick.
+			const int sendingVk = m_config.SendingElementVK[index];
+			const bool leftStick = std::ranges::find(KeyboardSettings::THUMBSTICK_L_VK_LIST, sendingVk) != KeyboardSettings::THUMBSTICK_L_VK_LIST.end();
+			const bool rightStick = std::ranges::find(KeyboardSettings::THUMBSTICK_R_VK_LIST, sendingVk) != KeyboardSettings::THUMBSTICK_R_VK_LIST.end();
+			if (!leftStick && !rightStick)
+				return {};
 			//find a key-down'd or repeat'd direction of the same thumbstick
-			if (leftStick || rightStick)
+			const auto& stickSettingList = leftStick ? KeyboardSettings::THUMBSTICK_L_VK_LIST : KeyboardSettings::THUMBSTICK_R_VK_LIST;
+			for (size_t i = 0; i < m_config.size(); i++)
 			{
-				//build list of key-down state maps that match the thumbstick of the current "detail" map.
-				const auto stickSettingList = leftStick ? KeyboardSettings::THUMBSTICK_L_VK_LIST : KeyboardSettings::THUMBSTICK_R_VK_LIST;
-				auto TestFunc = [&stickSettingList, &detail](const KeyboardKeyMap& elem)
-				{
-					if ((elem.LastAction == InpType::KEYDOWN || elem.LastAction == InpType::KEYREPEAT) && elem.SendingElementVK != detail.SendingElementVK)
-						return std::ranges::find(stickSettingList, elem.SendingElementVK) != stickSettingList.end();
-					return false;
-				};
-				const auto mpit = std::ranges::find_if(m_map_token_info, TestFunc);
-				if (mpit == m_map_token_info.end())
-					return false;
-				outOvertaken = *mpit;
-				return true;
+				const InpType action = m_runtime.LastAction[i];
+				if ((action == InpType::KEYDOWN || action == InpType::KEYREPEAT) && m_config.SendingElementVK[i] != sendingVk
+					&& std::ranges::find(stickSettingList, m_config.SendingElementVK[i]) != stickSettingList.end())
+					return i;
 			}
-			return false;
-		}
-		void DoOvertaking(KeyboardKeyMap &detail) noexcept
-		{
-			SendTheKey(detail, false, InpType::KEYUP);
+			return {};
 		}
-		[[nodiscard]] std::string CheckForVKError(const KeyboardKeyMap& detail) const
+		void DoOvertaking(const size_t index, const PointInTime now)
 		{
-			if ((detail.MappedToVK <= 0) || (detail.SendingElementVK <= 0))
-			{
-				std::stringstream error;
-				error << detail;
-				return std::string("Contents:\n") + error.str() + ERR_BAD_VK;
-			}
-			return "";
+			SendTheKey(index, false, InpType::KEYUP, now);
 		}
 	};
 
@@ -0,0 +1,169 @@
+#pragma once
+#include "stdafx.h"
+#include "XInputTranslater.h"
+#include "KeyboardChordTable.h"
+
+namespace sds
+{
+	/// <summary>
+	/// Derives XINPUT_KEYSTROKE events from successive XINPUT_STATE structs, in place of XInputGetKeystroke().
+	///	Uses the XInputTranslater bitmask edges: a pressed bit produces a KEYDOWN, a released bit a KEYUP,
+	///	and a bit held past the repeat delay produces KEYDOWN|REPEAT events, the same flags XInput reports.
+	///	Releases are reported before presses, so a thumbstick direction change is an up followed by a down.
+	///	With a KeyboardChordTable set, active chords are reported with their synthesized virtual keys in place of their inputs.
+	///	A newly pressed chord input is held back for the chord window, so the rest of the chord may be pressed after it
+	///	without the input's own key being sent first. An input tapped within the window is sent as a press, then a release on the next state.
+	///	Not thread-safe, intended to be used by the single thread polling the controller state.
+	/// </summary>
+	class KeystrokeSynthesizer
+	{
+	public:
+		using ClockType = std::chrono::high_resolution_clock;
+		using PointInTime = std::chrono::time_point<ClockType>;
+		using MaskType = ControllerBits::MaskType;
+	private:
+		XInputTranslater m_translater{};
+		std::shared_ptr<const KeyboardChordTable> m_chords{};
+		MaskType m_chord_latched{ 0 };
+		MaskType m_chord_pending{ 0 }; // chord inputs held back, waiting for the rest of a chord
+		MaskType m_raw_held{ 0 };
+		std::array<PointInTime, ControllerBits::MAX_BIT_COUNT> m_chord_deadline{};
+		std::chrono::microseconds m_chord_window{ KeyboardSettings::MICROSECONDS_CHORD_WINDOW };
+		MaskType m_held{ 0 };
+		std::array<PointInTime, ControllerBits::MAX_BIT_COUNT> m_next_repeat{};
+		std::chrono::microseconds m_repeat_delay{ KeyboardSettings::MICROSECONDS_DELAY_KEYREPEAT };
+		BYTE m_user_index{ 0 };
+	public:
+		KeystrokeSynthesizer() = default;
+		explicit KeystrokeSynthesizer(const int playerId) noexcept : m_user_index(static_cast<BYTE>(playerId)) { }
+		KeystrokeSynthesizer(const int playerId, const XInputTranslater& translater) noexcept
+			: m_translater(translater), m_user_index(static_cast<BYTE>(playerId))
+		{
+		}
+		KeystrokeSynthesizer(const KeystrokeSynthesizer& other) = default;
+		KeystrokeSynthesizer(KeystrokeSynthesizer&& other) = default;
+		KeystrokeSynthesizer& operator=(const KeystrokeSynthesizer& other) = default;
+		KeystrokeSynthesizer& operator=(KeystrokeSynthesizer&& other) = default;
+		~KeystrokeSynthesizer() = default;
+
+		/// <summary>Translates the state and emits the keystrokes for the edges against the previous state.</summary>
+		/// <param name="state">state obj retrieved from XInputGetState()</param>
+		/// <param name="now">time of the poll, used for the key repeat behavior</param>
+		/// <param name="emitFn">callable taking a const XINPUT_KEYSTROKE&, called once per keystroke produced</param>
+		/// <returns>number of keystrokes emitted</returns>
+		size_t ProcessState(const XINPUT_STATE& state, const PointInTime now, auto&& emitFn)
+		{
+			MaskType mask = m_translater.ProcessState(state);
+			if (m_chords)
+				mask = ApplyChords(mask, now);
+			return ProcessMask(mask, now, emitFn);
+		}
+		/// <summary>Emits the keystrokes for the edges between the held mask and the new current mask.
+		///	Any bit with a non-zero ControllerBits::GetVirtualKey() value may be set.</summary>
+		/// <returns>number of keystrokes emitted</returns>
+		size_t ProcessMask(const MaskType current, const PointInTime now, auto&& emitFn)
+		{
+			const ControllerStateDiff diff = ControllerStateDiff::Build(m_held, current);
+			m_held = current;
+			size_t count = 0;
+			ForEachBit(diff.Released, [&](const int bit)
+			{
+				count += Emit(bit, XINPUT_KEYSTROKE_KEYUP, emitFn);
+			});
+			ForEachBit(diff.Pressed, [&](const int bit)
+			{
+				m_next_repeat[static_cast<size_t>(bit)] = now + m_repeat_delay;
+				count += Emit(bit, XINPUT_KEYSTROKE_KEYDOWN, emitFn);
+			});
+			ForEachBit(current & ~diff.Pressed, [&](const int bit)
+			{
+				auto& nextRepeat = m_next_repeat[static_cast<size_t>(bit)];
+				if (now >= nextRepeat)
+				{
+					nextRepeat = now + m_repeat_delay;
+					count += Emit(bit, XINPUT_KEYSTROKE_KEYDOWN | XINPUT_KEYSTROKE_REPEAT, emitFn);
+				}
+			});
+			return count;
+		}
+		/// <summary>Forgets the held state, without emitting key-ups.</summary>
+		void Reset() noexcept
+		{
+			m_held = 0;
+			ResetChordState();
+			m_translater.Reset();
+		}
+		/// <summary>Sets the compiled chord maps, or nullptr for none.</summary>
+		void SetChordTable(std::shared_ptr<const KeyboardChordTable> chords) noexcept
+		{
+			m_chords = std::move(chords);
+			ResetChordState();
+		}
+		/// <summary>Sets the time a newly pressed chord input is held back, zero to send it at once.</summary>
+		void SetChordWindow(const std::chrono::microseconds window) noexcept
+		{
+			m_chord_window = window;
+		}
+		/// <summary>Sets the delay between KEYDOWN|REPEAT events of a held input.</summary>
+		void SetRepeatDelay(const std::chrono::microseconds delay) noexcept
+		{
+			m_repeat_delay = delay;
+		}
+		[[nodiscard]] MaskType GetHeldMask() const noexcept
+		{
+			return m_held;
+		}
+	private:
+		/// <summary>Replaces chord inputs with their chord bits, holding back newly pressed chord inputs for the chord window.</summary>
+		MaskType ApplyChords(const MaskType raw, const PointInTime now)
+		{
+			const MaskType pressed = raw & ~m_raw_held & m_chords->GetInputMask();
+			m_raw_held = raw;
+			ForEachBit(pressed, [&](const int bit)
+			{
+				m_chord_deadline[static_cast<size_t>(bit)] = now + m_chord_window;
+			});
+			MaskType pending = m_chord_pending | pressed;
+			//released within the window, sent as a tap, released on the next state by leaving it out
+			const MaskType tapped = pending & ~raw;
+			pending &= raw;
+			const MaskType resolved = m_chords->Apply(raw, m_chord_latched);
+			//inputs that joined a chord, or waited the whole window, are no longer held back
+			pending &= ~m_chord_latched;
+			ForEachBit(pending, [&](const int bit)
+			{
+				if (now >= m_chord_deadline[static_cast<size_t>(bit)])
+					pending &= ~ControllerBits::ToMask(bit);
+			});
+			m_chord_pending = pending;
+			return (resolved & ~pending) | tapped;
+		}
+		void ResetChordState() noexcept
+		{
+			m_chord_latched = 0;
+			m_chord_pending = 0;
+			m_raw_held = 0;
+		}
+		static void ForEachBit(MaskType mask, auto&& fn)
+		{
+			while (mask != 0)
+			{
+				const int bit = std::countr_zero(mask);
+				mask &= mask - 1;
+				fn(bit);
+			}
+		}
+		size_t Emit(const int bit, const WORD flags, auto&& emitFn) const
+		{
+			const int vk = ControllerBits::GetVirtualKey(bit);
+			if (vk == 0)
+				return 0;
+			XINPUT_KEYSTROKE stroke{};
+			stroke.VirtualKey = static_cast<WORD>(vk);
+			stroke.Flags = flags;
+			stroke.UserIndex = m_user_index;
+			emitFn(stroke);
+			return 1;
+		}
+	};
+}
@@ -7,19 +7,30 @@ namespace sds
 	/// <summary>
 	/// Polls for input from the XInput library in it's worker thread function.
 	/// Values are used in MouseMapper, the main class for use.
+	///	The polling delay adapts to activity, see Utilities::AdaptivePollDelay, fast while dwPacketNumber
+	///	is changing and decaying to a slow rate while the controller is idle.
+	///	An optional state listener receives every polled state, so a single poll can feed other consumers
+	///	such as KeyboardInputPoller::FeedState().
 	/// </summary>
 	class MouseInputPoller
 	{
 		using InternalType = XINPUT_STATE;
 		using LambdaRunnerType = sds::CPPRunnerGeneric<InternalType>;
 		using lock = LambdaRunnerType::ScopedLockType;
+	public:
+		using StateListenerType = std::function<void(const XINPUT_STATE&)>;
+	private:
 		MousePlayerInfo m_local_player{};
+		StateListenerType m_state_listener{};
+		std::mutex m_listener_mutex{};
+		Utilities::AdaptivePollDelay m_poll_delay{ MouseSettings::MICROSECONDS_POLLER_FAST, MouseSettings::MICROSECONDS_POLLER_SLOW, MouseSettings::POLLER_IDLE_COUNT_BEFORE_DECAY };
 		std::unique_ptr<LambdaRunnerType> m_workThread{};
 		void InitWorkThread() noexcept
 		{
 			m_workThread =
 				std::make_unique<LambdaRunnerType>
 				([this](const sds::LambdaArgs::LambdaArg1& stopCondition, sds::LambdaArgs::LambdaArg2& mut, auto& protectedData) { workThread(stopCondition, mut, protectedData); });
+			m_workThread->SetThreadPolicy(Utilities::ThreadPolicy::ForPolling());
 		}
 	public:
 		MouseInputPoller()
@@ -32,6 +43,13 @@ namespace sds
 			InitWorkThread();
 			Start();
 		}
+		/// <summary>Ctor allows setting the adaptive polling delay bounds, in microseconds.</summary>
+		MouseInputPoller(const MousePlayerInfo& p, const size_t fastDelayUs, const size_t slowDelayUs) : m_local_player(p)
+		{
+			m_poll_delay.SetBounds(fastDelayUs, slowDelayUs);
+			InitWorkThread();
+			Start();
+		}
 		MouseInputPoller(const MouseInputPoller& other) = delete;
 		MouseInputPoller(MouseInputPoller&& other) = delete;
 		MouseInputPoller& operator=(const MouseInputPoller& other) = delete;
@@ -44,6 +62,38 @@ namespace sds
 				return m_workThread->GetCurrentState();
 			return XINPUT_STATE{};
 		}
+		/// <summary>Sets the fast (active) and slow (idle) polling delay bounds, in microseconds.
+		///	Picked up by the running poller on its next poll.</summary>
+		void SetPollDelayBounds(const size_t fastDelayUs, const size_t slowDelayUs) noexcept
+		{
+			m_poll_delay.SetBounds(fastDelayUs, slowDelayUs);
+		}
+		/// <summary>Sets the scheduling policy of the polling thread, takes effect the next time it is started.</summary>
+		void SetThreadPolicy(const Utilities::ThreadPolicy& policy)
+		{
+			m_workThread->SetThreadPolicy(policy);
+		}
+		/// <summary>Telemetry, returns the polling delay currently in use, in microseconds.</summary>
+		[[nodiscard]] size_t GetPollDelay() const noexcept
+		{
+			return m_poll_delay.GetCurrentDelay();
+		}
+		[[nodiscard]] MousePlayerInfo::PidType GetPlayerId() const noexcept
+		{
+			return m_local_player.player_id;
+		}
+		/// <summary>Telemetry, returns the polling rate currently in use, in polls per second.</summary>
+		[[nodiscard]] double GetPollRate() const noexcept
+		{
+			return m_poll_delay.GetCurrentRate();
+		}
+		/// <summary>Sets a function called by the worker thread with every polled state, changed or not.
+		///	The state is zeroed if the controller could not be read. Pass an empty function to remove it.</summary>
+		void SetStateListener(StateListenerType listener)
+		{
+			lock listenerLock(m_listener_mutex);
+			m_state_listener = std::move(listener);
+		}
 		/// <summary>Start polling for updated XINPUT_STATE info.</summary>
 		void Start() const noexcept
 		{
@@ -81,7 +131,7 @@ namespace sds
 		}
 	protected:
 		/// <summary>Worker thread used by m_workThread. Updates the protectedData with mutex protection.</summary>
-		void workThread(const sds::LambdaArgs::LambdaArg1& stopCondition, sds::LambdaArgs::LambdaArg2& mut, InternalType& protectedData) const noexcept
+		void workThread(const sds::LambdaArgs::LambdaArg1& stopCondition, sds::LambdaArgs::LambdaArg2& mut, InternalType& protectedData) noexcept
 		{
 			{
 				//zero local_state before use
@@ -93,17 +143,24 @@ namespace sds
 			while (!stopCondition)
 			{
 				tempState = {};
+				bool isChanged = false;
 				const DWORD error = XInputGetState(m_local_player.player_id, &tempState);
 				if (error == ERROR_SUCCESS)
 				{
 					if (tempState.dwPacketNumber != lastPacket)
 					{
+						isChanged = true;
 						lastPacket = tempState.dwPacketNumber;
 						lock second(mut);
 						protectedData = tempState;
 					}
 				}
-				std::this_thread::sleep_for(std::chrono::milliseconds(MouseSettings::THREAD_DELAY_POLLER));
+				{
+					lock listenerLock(m_listener_mutex);
+					if (m_state_listener)
+						m_state_listener(tempState);
+				}
+				std::this_thread::sleep_for(std::chrono::microseconds(m_poll_delay.Update(isChanged)));
 			}
 		}
 	};
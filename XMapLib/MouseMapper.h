@@ -1,9 +1,12 @@
 #pragma once
 #include "stdafx.h"
 #include "MouseMoveThread.h"
-#include "ThumbstickToDelay.h"
+#include "ThumbstickProcessor.h"
+#include "ThumbstickFilter.h"
 #include "MouseInputPoller.h"
+#include "CommandQueue.h"
 #include "Utilities.h"
+#include <optional>
 namespace sds
 {
 	/// <summary>
@@ -11,24 +14,64 @@ namespace sds
 	/// This class starts a running thread that is used to process the XINPUT_STATE structure and use those values to determine if it should move the mouse cursor, and if so how much.
 	/// The class has an internal MouseInputPoller() instance that fetches controller information via the XInputGetState() function and associated lib.
 	/// It also has public functions for getting and setting the sensitivity as well as setting which thumbstick to use.
+	///	More sticks, of this or other players, are added with AddStick(), each is stepped by the same worker loop and moves its own mouse mover.
+	///	Settings changes are validated on the calling thread and posted to the worker, which applies them at the top of its next tick,
+	///	so the threads are never stopped or locked for them. The getters return the configured settings.
 	/// </summary>
 	class MouseMapper
 	{
 		using InternalType = int;
 		using LambdaRunnerType = sds::CPPRunnerGeneric<InternalType>;
 		using lock = LambdaRunnerType::ScopedLockType;
-		std::atomic<StickMap> m_stickmap_info{ StickMap::NEITHER_STICK };
-		std::atomic<SHORT> m_thread_x{ 0 };
-		std::atomic<SHORT> m_thread_y{0};
-		std::atomic<int> m_mouse_sensitivity{ MouseSettings::SENSITIVITY_DEFAULT };
-		sds::MousePlayerInfo m_local_player{};
+	public:
+		/// <summary>A stick added with AddStick().</summary>
+		struct AddedStick
+		{
+			MousePlayerInfo Player{};
+			StickMap Stick{ StickMap::RIGHT_STICK };
+		};
+	private:
+		const std::string ERR_ADD_STICK{ "MouseMapper::AddStick(): Stick is NEITHER_STICK, or a deadzone value out of range." };
+		const std::string ERR_DUP_STICK{ "MouseMapper::AddStick(): The player's stick is already added, or is the main stick." };
+		/// <summary>Settings the stick processors are built from, the player and stick are those of the main stick.</summary>
+		struct Config
+		{
+			MousePlayerInfo Player{};
+			StickMap Stick{ StickMap::NEITHER_STICK };
+			int XSensitivity{ MouseSettings::SENSITIVITY_DEFAULT };
+			int YSensitivity{ MouseSettings::SENSITIVITY_DEFAULT };
+			ResponseCurve Curve{};
+			std::optional<ThumbstickFilter::ParamType> Filter{};
+		};
+		//The configured settings, for the getters and validation, written under m_config_mutex by the callers.
+		mutable std::mutex m_config_mutex{};
+		Config m_config{};
+		std::vector<AddedStick> m_added_sticks{};
+		/// <summary>An added stick of the worker, with its own processor and mover, and the poller of its player.</summary>
+		struct StickRuntime
+		{
+			AddedStick Added{};
+			std::shared_ptr<MouseInputPoller> Poller{}; // nullptr for m_poller, shared by the sticks of a player
+			std::unique_ptr<MouseMoveThread> Mover{};
+			std::optional<ThumbstickProcessor> Processor{};
+			std::optional<ThumbstickFilter> Filter{};
+		};
+		//Stick state of the worker, rebuilt from a posted copy of the settings, the main stick's is empty with NEITHER_STICK.
+		Config m_applied{}; // worker thread only
+		std::optional<ThumbstickProcessor> m_stick{}; // worker thread only
+		std::optional<ThumbstickFilter> m_filter{}; // worker thread only
+		std::vector<std::unique_ptr<StickRuntime>> m_sticks{}; // worker thread only
+		Utilities::CommandQueue m_commands{};
 		sds::MouseInputPoller m_poller{};
+		//created stopped, run by the worker while the main stick is set, so the mover thread is reused across starts
+		MouseMoveThread m_mover{ Utilities::ThreadPolicy::Default(), {}, MouseMoveThread::TimingMode::RESET_FROM_NOW, false };
 		std::unique_ptr<LambdaRunnerType> m_workThread{};
 		void InitWorkThread() noexcept
 		{
 			m_workThread =
 				std::make_unique<LambdaRunnerType>
 				([this](const sds::LambdaArgs::LambdaArg1& stopCondition, sds::LambdaArgs::LambdaArg2& mut, int& protectedData) { workThread(stopCondition, mut, protectedData); });
+			m_workThread->SetThreadPolicy(Utilities::ThreadPolicy::ForPolling());
 		}
 	public:
 		/// <summary>Ctor for default configuration</summary>
@@ -37,7 +80,19 @@ namespace sds
 			InitWorkThread();
 		}
 		/// <summary>Ctor allows setting a custom MousePlayerInfo</summary>
-		explicit MouseMapper(const sds::MousePlayerInfo& player) noexcept : m_local_player(player) { InitWorkThread(); }
+		explicit MouseMapper(const sds::MousePlayerInfo& player) noexcept : m_poller(player)
+		{
+			m_config.Player = player;
+			InitWorkThread();
+		}
+		/// <summary>Ctor allows setting a function receiving each mouse move in place of SendInput,
+		///	such as Utilities::SendUinput::SendMouseMove(), which writes the X and Y move in one call.</summary>
+		MouseMapper(const sds::MousePlayerInfo& player, MouseMoveThread::MoveSinkType moveSink) noexcept
+			: m_poller(player), m_mover{ Utilities::ThreadPolicy::Default(), std::move(moveSink), MouseMoveThread::TimingMode::RESET_FROM_NOW, false }
+		{
+			m_config.Player = player;
+			InitWorkThread();
+		}
 		MouseMapper(const MouseMapper& other) = delete;
 		MouseMapper(MouseMapper&& other) = delete;
 		MouseMapper& operator=(const MouseMapper& other) = delete;
@@ -46,54 +101,201 @@ namespace sds
 
 		/// <summary>Use this function to establish one stick or the other as the one controlling the mouse movements.
 		/// Set to NEITHER_STICK for no thumbstick mouse movement. Options are RIGHT_STICK, LEFT_STICK, NEITHER_STICK
-		///	This will start processing if the stick is something other than "NEITHER"
+		///	This will start processing if the stick is something other than "NEITHER" and the threads aren't running,
+		///	with NEITHER_STICK the poller and worker keep running, so the state listener is still fed, and the worker stops the mover thread.
 		///	**Arbitrary values outside of the enum constants will not be processed successfully.**</summary>
 		/// <param name="info"> a StickMap enum</param>
-		void SetStick(const StickMap info) noexcept
+		void SetStick(const StickMap info)
 		{
-			if (m_stickmap_info != info)
+			std::lock_guard configLock(m_config_mutex);
+			if (m_config.Stick == info)
+				return;
+			m_config.Stick = info;
+			PostConfigLocked();
+			if (info != StickMap::NEITHER_STICK && !IsRunning())
+				Start();
+		}
+		[[nodiscard]] StickMap GetStick() const
+		{
+			std::lock_guard configLock(m_config_mutex);
+			return m_config.Stick;
+		}
+		/// <summary>Setter for sensitivity value, of both axes. Applied by the running worker on its next tick.</summary>
+		/// <returns> returns a std::string containing an error message
+		/// if there is an error, empty string otherwise. </returns>
+		std::string SetSensitivity(const int new_sens)
+		{
+			return SetAxisSensitivity(new_sens, new_sens);
+		}
+		/// <summary>Setter for per-axis sensitivity values. Applied by the running worker on its next tick.</summary>
+		/// <returns> returns a std::string containing an error message
+		/// if there is an error, empty string otherwise. </returns>
+		std::string SetAxisSensitivity(const int xSens, const int ySens)
+		{
+			if (!MouseSettings::IsValidSensitivityValue(xSens) || !MouseSettings::IsValidSensitivityValue(ySens))
+			{
+				return "Error in sds::XinMouseMapper::SetSensitivity(), int new_sens out of range.";
+			}
+			std::lock_guard configLock(m_config_mutex);
+			m_config.XSensitivity = xSens;
+			m_config.YSensitivity = ySens;
+			PostConfigLocked();
+			return "";
+		}
+		/// <summary>Setter for the deadzone values of one thumbstick. Applied by the running worker on its next tick.</summary>
+		/// <returns> returns a std::string containing an error message
+		/// if there is an error, empty string otherwise. </returns>
+		std::string SetDeadzones(const StickMap stick, const int xDz, const int yDz)
+		{
+			if (stick == StickMap::NEITHER_STICK || !MouseSettings::IsValidDeadzoneValue(xDz) || !MouseSettings::IsValidDeadzoneValue(yDz))
 			{
-				this->Stop();
-				m_stickmap_info = info;
-				if (info != StickMap::NEITHER_STICK)
-				{
-					m_poller.Start();
-					m_workThread->StartThread();
-				}
-				else
-				{
-					m_poller.Stop();
-					m_workThread->StopThread();
-				}
+				return "Error in sds::XinMouseMapper::SetDeadzones(), stick or deadzone value out of range.";
 			}
+			std::lock_guard configLock(m_config_mutex);
+			const bool isLeft = stick == StickMap::LEFT_STICK;
+			(isLeft ? m_config.Player.left_x_dz : m_config.Player.right_x_dz) = xDz;
+			(isLeft ? m_config.Player.left_y_dz : m_config.Player.right_y_dz) = yDz;
+			PostConfigLocked();
+			return "";
 		}
-		StickMap GetStick() const
+		/// <summary>Setter for the thumbstick response curve, baked into the delay tables by the running worker on its next tick.</summary>
+		/// <returns> returns a std::string containing an error message
+		/// if there is an error, empty string otherwise. </returns>
+		std::string SetResponseCurve(const ResponseCurve& curve)
+		{
+			std::string er = curve.Validate();
+			if (!er.empty())
+				return er;
+			std::lock_guard configLock(m_config_mutex);
+			m_config.Curve = curve;
+			PostConfigLocked();
+			return "";
+		}
+		[[nodiscard]] ResponseCurve GetResponseCurve() const
 		{
-			return m_stickmap_info;
+			std::lock_guard configLock(m_config_mutex);
+			return m_config.Curve;
 		}
-		/// <summary>Setter for sensitivity value.</summary>
+		/// <summary>Enables the thumbstick noise filter stage with the given parameters, or disables it with std::nullopt.
+		///	Applied by the running worker on its next tick. See ThumbstickFilter::DefaultParameters() for a starting point.</summary>
 		/// <returns> returns a std::string containing an error message
 		/// if there is an error, empty string otherwise. </returns>
-		std::string SetSensitivity(const int new_sens) noexcept
+		std::string SetStickFilter(const std::optional<ThumbstickFilter::ParamType>& params)
 		{
-			if (!MouseSettings::IsValidSensitivityValue(new_sens))
+			if (params)
 			{
-				return "Error in sds::XinMouseMapper::SetSensitivity(), int new_sens out of range.";
+				std::string er = params->Validate();
+				if (!er.empty())
+					return er;
 			}
-			Stop();
-			m_mouse_sensitivity = new_sens;
-			Start();
+			std::lock_guard configLock(m_config_mutex);
+			m_config.Filter = params;
+			PostConfigLocked();
+			return "";
+		}
+		[[nodiscard]] std::optional<ThumbstickFilter::ParamType> GetStickFilter() const
+		{
+			std::lock_guard configLock(m_config_mutex);
+			return m_config.Filter;
+		}
+		/// <summary>Getter for sensitivity value, of the X axis</summary>
+		[[nodiscard]] int GetSensitivity() const
+		{
+			std::lock_guard configLock(m_config_mutex);
+			return m_config.XSensitivity;
+		}
+		[[nodiscard]] int GetSensitivityY() const
+		{
+			std::lock_guard configLock(m_config_mutex);
+			return m_config.YSensitivity;
+		}
+		/// <summary>Sets the scheduling policy of the mouse mover thread, takes effect the next time this MouseMapper is started.
+		///	The mover doesn't wait between moves, see ThreadPolicy::ForOutput() and ThreadPolicy::ForRealtimeOutput()
+		///	to raise its priority where a CPU can be given over to it.</summary>
+		void SetMoverThreadPolicy(const Utilities::ThreadPolicy& policy)
+		{
+			m_mover.SetThreadPolicy(policy);
+		}
+		[[nodiscard]] Utilities::ThreadPolicy GetMoverThreadPolicy() const
+		{
+			return m_mover.GetThreadPolicy();
+		}
+		/// <summary>Sets how the mouse mover times each move, takes effect the next time this MouseMapper is started.</summary>
+		void SetMoverTimingMode(const MouseMoveThread::TimingMode mode) noexcept
+		{
+			m_mover.SetTimingMode(mode);
+		}
+		[[nodiscard]] MouseMoveThread::TimingMode GetMoverTimingMode() const noexcept
+		{
+			return m_mover.GetTimingMode();
+		}
+		/// <summary>Adds a stick stepped by the same worker loop, with the player's deadzones and its own mouse mover,
+		///	such as a second player's stick. The sensitivity, curve and filter settings are those of the main stick.
+		///	A player other than the main stick's is polled by one more MouseInputPoller, shared by that player's sticks.
+		///	Applied by the running worker on its next tick.</summary>
+		/// <param name="player">player id and deadzones of the stick</param>
+		/// <param name="stick">LEFT_STICK or RIGHT_STICK</param>
+		/// <param name="moveSink">function receiving each move of this stick in place of SendInput, or empty to send input</param>
+		/// <returns> returns a std::string containing an error message
+		/// if there is an error, empty string otherwise. </returns>
+		std::string AddStick(const MousePlayerInfo& player, const StickMap stick, MouseMoveThread::MoveSinkType moveSink = {})
+		{
+			const bool isLeft = stick == StickMap::LEFT_STICK;
+			if (stick == StickMap::NEITHER_STICK
+				|| !MouseSettings::IsValidDeadzoneValue(isLeft ? player.left_x_dz : player.right_x_dz)
+				|| !MouseSettings::IsValidDeadzoneValue(isLeft ? player.left_y_dz : player.right_y_dz))
+				return ERR_ADD_STICK;
+			std::lock_guard configLock(m_config_mutex);
+			const bool isMainStick = m_config.Player.player_id == player.player_id && m_config.Stick == stick;
+			if (isMainStick || std::ranges::any_of(m_added_sticks, [&](const AddedStick& a) { return a.Player.player_id == player.player_id && a.Stick == stick; }))
+				return ERR_DUP_STICK;
+			m_added_sticks.push_back(AddedStick{ player, stick });
+			m_commands.Post([this, added = m_added_sticks.back(), moveSink = std::move(moveSink)]() { AddStickRuntime(added, moveSink); });
 			return "";
 		}
-		/// <summary>Getter for sensitivity value</summary>
-		[[nodiscard]] int GetSensitivity() const noexcept
+		/// <summary>Removes the added sticks, applied by the running worker on its next tick.</summary>
+		void ClearAddedSticks()
+		{
+			std::lock_guard configLock(m_config_mutex);
+			m_added_sticks.clear();
+			m_commands.Post([this]() { m_sticks.clear(); });
+		}
+		[[nodiscard]] std::vector<AddedStick> GetAddedSticks() const
+		{
+			std::lock_guard configLock(m_config_mutex);
+			return m_added_sticks;
+		}
+		[[nodiscard]] MousePlayerInfo GetPlayerInfo() const
 		{
-			return m_mouse_sensitivity;
+			std::lock_guard configLock(m_config_mutex);
+			return m_config.Player;
 		}
 		[[nodiscard]] bool IsControllerConnected() const noexcept
 		{
 			return m_poller.IsControllerConnected();
 		}
+		/// <summary>Sets the fast (active) and slow (idle) input polling delay bounds, in microseconds.</summary>
+		void SetPollDelayBounds(const size_t fastDelayUs, const size_t slowDelayUs) noexcept
+		{
+			m_poller.SetPollDelayBounds(fastDelayUs, slowDelayUs);
+		}
+		/// <summary>Sets a function called by the input poller with every polled state, used to share
+		///	the single state poll with a KeyboardMapper using KeystrokeSource::STATE_FEED.
+		///	The poller runs while this MouseMapper is started, with or without a stick set.</summary>
+		void SetStateListener(MouseInputPoller::StateListenerType listener)
+		{
+			m_poller.SetStateListener(std::move(listener));
+		}
+		/// <summary>Telemetry, returns the input polling rate currently in use, in polls per second.</summary>
+		[[nodiscard]] double GetPollRate() const noexcept
+		{
+			return m_poller.GetPollRate();
+		}
+		/// <summary>Telemetry, true while the mover thread of the main stick is running, it is stopped with NEITHER_STICK.</summary>
+		[[nodiscard]] bool IsMoverRunning() const noexcept
+		{
+			return m_mover.IsRunning();
+		}
 		[[nodiscard]] bool IsRunning() const noexcept
 		{
 			bool workRunning = false;
@@ -114,47 +316,100 @@ namespace sds
 				m_workThread->StopThread();
 		}
 	protected:
-		/// <summary>Worker thread, protected visibility, gets updated data from ProcessState() function to use.
-		/// Accesses the std::atomic m_thread_x and m_thread_y members. chrono lib instances may throw exceptions.</summary>
+		/// <summary>Worker thread, protected visibility, applies the posted settings and steps the stick processors
+		///	with the latest polled states. chrono lib instances may throw exceptions.</summary>
 		void workThread(const sds::LambdaArgs::LambdaArg1& stopCondition, sds::LambdaArgs::LambdaArg2&, int&)
 		{
-			ThumbstickToDelay xThread(this->GetSensitivity(), m_local_player, m_stickmap_info, true);
-			ThumbstickToDelay yThread(this->GetSensitivity(), m_local_player, m_stickmap_info, false);
-			MouseMoveThread mover;
+			auto lastTick = std::chrono::steady_clock::now();
+			if (m_stick)
+				m_mover.Start();
+			for (const auto& stick : m_sticks)
+			{
+				if (stick->Poller)
+					stick->Poller->Start();
+				stick->Mover->Start();
+			}
 			//thread main loop
 			while (!stopCondition)
 			{
-				ProcessState(m_poller.GetUpdatedState());
-				//store the returned delay from axisthread for each axis
-				//then pass the delays on to MouseMoveThread, along with some information like
-				//is X or Y negative, and if the axis is moving
-				const SHORT tx = m_thread_x;
-				const SHORT ty = m_thread_y;
-				const size_t xDelay = xThread.GetDelayFromThumbstickValue(tx, ty);
-				const size_t yDelay = yThread.GetDelayFromThumbstickValue(tx, ty);
-				const bool ixp = tx > 0;
-				const bool iyp = ty > 0;
-				mover.UpdateState(xDelay, yDelay, ixp, iyp, xThread.DoesAxisRequireMoveAlt(tx, ty), yThread.DoesAxisRequireMoveAlt(tx, ty));
-				std::this_thread::sleep_for(std::chrono::milliseconds(MouseSettings::THREAD_DELAY_POLLER));
+				//apply the settings changes first, they are for the states polled since
+				m_commands.Drain();
+				const auto now = std::chrono::steady_clock::now();
+				const float dtSeconds = std::chrono::duration<float>(now - lastTick).count();
+				lastTick = now;
+				if (m_stick)
+					StepStick(*m_stick, m_filter, m_poller.GetUpdatedState(), dtSeconds, m_mover);
+				for (const auto& stick : m_sticks)
+					StepStick(*stick->Processor, stick->Filter, stick->Poller ? stick->Poller->GetUpdatedState() : m_poller.GetUpdatedState(), dtSeconds, *stick->Mover);
+				//tick at the poller's current rate, so this loop doesn't add latency while the stick is moving
+				std::this_thread::sleep_for(std::chrono::microseconds(m_poller.GetPollDelay()));
+			}
+			m_mover.Stop();
+			for (const auto& stick : m_sticks)
+			{
+				if (stick->Poller)
+					stick->Poller->Stop();
+				stick->Mover->Stop();
 			}
 		}
 	private:
-		/// <summary>Updates local atomic values with XINPUT_STATE info from the MouseInputPoller</summary>
-		void ProcessState(const XINPUT_STATE& state) noexcept
+		/// <summary>Posts a copy of the settings to the worker, m_config_mutex must be held so copies are posted in order.</summary>
+		void PostConfigLocked()
 		{
-			if (m_stickmap_info == StickMap::NEITHER_STICK)
-				return;
-			if (m_stickmap_info == StickMap::RIGHT_STICK)
+			m_commands.Post([this, config = m_config]() { ApplyConfig(config); });
+		}
+		/// <summary>Rebuilds the stick processors and filters from the settings, worker thread only.</summary>
+		void ApplyConfig(const Config& config)
+		{
+			m_applied = config;
+			for (const auto& stick : m_sticks)
+				BuildStick(stick->Added.Player, stick->Added.Stick, stick->Processor, stick->Filter);
+			if (config.Stick == StickMap::NEITHER_STICK)
 			{
-				//Give worker thread new values.
-				m_thread_x = state.Gamepad.sThumbRX;
-				m_thread_y = state.Gamepad.sThumbRY;
+				m_stick.reset();
+				m_filter.reset();
+				//the mover loop doesn't wait, it isn't left running without a stick
+				m_mover.Stop();
+				return;
 			}
-			else if(m_stickmap_info == StickMap::LEFT_STICK)
+			BuildStick(config.Player, config.Stick, m_stick, m_filter);
+			m_mover.Start();
+		}
+		void BuildStick(const MousePlayerInfo& player, const StickMap whichStick, std::optional<ThumbstickProcessor>& stick, std::optional<ThumbstickFilter>& filter) const
+		{
+			stick.emplace(m_applied.XSensitivity, m_applied.YSensitivity, player, whichStick, m_applied.Curve);
+			if (m_applied.Filter)
+				filter.emplace(*m_applied.Filter);
+			else
+				filter.reset();
+		}
+		/// <summary>Creates an added stick, its mover and, for a player not polled yet, its poller, worker thread only.</summary>
+		void AddStickRuntime(const AddedStick& added, const MouseMoveThread::MoveSinkType& moveSink)
+		{
+			auto runtime = std::make_unique<StickRuntime>();
+			runtime->Added = added;
+			if (added.Player.player_id != m_poller.GetPlayerId())
 			{
-				m_thread_x = state.Gamepad.sThumbLX;
-				m_thread_y = state.Gamepad.sThumbLY;
+				const auto samePlayer = std::ranges::find_if(m_sticks, [&added](const auto& s) { return s->Added.Player.player_id == added.Player.player_id; });
+				runtime->Poller = samePlayer != m_sticks.end() ? (*samePlayer)->Poller : std::make_shared<MouseInputPoller>(added.Player);
 			}
+			runtime->Mover = std::make_unique<MouseMoveThread>(m_mover.GetThreadPolicy(), moveSink, m_mover.GetTimingMode());
+			BuildStick(added.Player, added.Stick, runtime->Processor, runtime->Filter);
+			m_sticks.push_back(std::move(runtime));
+		}
+		/// <summary>Passes the delays for the stick's axes in the polled state on to the mover.</summary>
+		static void StepStick(const ThumbstickProcessor& stick, std::optional<ThumbstickFilter>& filter, const XINPUT_STATE& state, const float dtSeconds, MouseMoveThread& mover) noexcept
+		{
+			const bool isLeft = stick.GetStick() == StickMap::LEFT_STICK;
+			ThumbstickFilter::Output axes{ isLeft ? state.Gamepad.sThumbLX : state.Gamepad.sThumbRX, isLeft ? state.Gamepad.sThumbLY : state.Gamepad.sThumbRY };
+			//smooth the stick jitter, if enabled, with the time since the last tick
+			if (filter)
+				axes = filter->Process(axes.X, axes.Y, dtSeconds);
+			//get the delay for each axis from the stick processor
+			//then pass the delays on to MouseMoveThread, along with some information like
+			//is X or Y negative, and if the axis is moving
+			const auto move = stick.Process(axes.X, axes.Y);
+			mover.UpdateState(move.XDelay, move.YDelay, move.IsXPositive, move.IsYPositive, move.IsXMoving, move.IsYMoving);
 		}
 	};
 }
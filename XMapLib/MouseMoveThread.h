@@ -1,16 +1,113 @@
 #pragma once
 #include "MouseSettings.h"
 #include "Utilities.h"
+#include <optional>
 
 namespace sds
 {
 	/// <summary>A singular thread responsible for sending mouse movements using
-	///	two different axis delay values being updated while running.</summary>
+	///	two different axis delay values being updated while running.
+	///	The loop checks the axis deadlines without waiting, so it runs with the default scheduling policy unless another is given,
+	///	a spinning thread at a raised priority takes a CPU from the rest of the system.
+	///	May be stopped and started again with Stop() and Start(), the thread is parked in between.</summary>
 	class MouseMoveThread
 	{
 		using InternalType = int;
 		using LambdaRunnerType = sds::CPPRunnerGeneric<InternalType>;
 		using lock = LambdaRunnerType::ScopedLockType;
+	public:
+		/// <summary>Receives each move in place of SendInput, for benchmarking or re-routing the output.</summary>
+		using MoveSinkType = std::function<void(int, int)>;
+		/// <summary>How the next move of an axis is timed, see DelayManager::Reset() and DelayManager::Advance().</summary>
+		enum class TimingMode : int
+		{
+			RESET_FROM_NOW = 0, // the delay starts when the move is sent, lateness accumulates
+			ADVANCE_DEADLINE = 1 // the delay starts at the previous deadline, drift-free
+		};
+		/// <summary>Axis delays in microseconds and directions, as given to UpdateState().</summary>
+		struct MoveState
+		{
+			size_t XDelay{ 1 };
+			size_t YDelay{ 1 };
+			bool IsXPositive{ false };
+			bool IsYPositive{ false };
+			bool IsXMoving{ false };
+			bool IsYMoving{ false };
+		};
+		/// <summary>One iteration of the mover loop, checking each axis delay against the given time
+		///	and producing the single pixel move for the axes past their deadline.
+		///	Run by the mover thread with the system clock, and by PipelineSimulator with its VirtualClock.</summary>
+		class MoveStep
+		{
+		public:
+			using PointInTime = Utilities::DelayManager::TimeType;
+			/// <summary>Pixels to move in X and Y.</summary>
+			using MoveType = std::pair<int, int>;
+		private:
+			Utilities::DelayManager m_x_time;
+			Utilities::DelayManager m_y_time;
+			bool m_is_advancing;
+			//moving state of the previous step, a newly moving axis first moves on the step after
+			bool m_was_x_moving{ false };
+			bool m_was_y_moving{ false };
+		public:
+			/// <param name="timingMode">how the next move of an axis is timed</param>
+			/// <param name="startTime">time the mover starts at</param>
+			MoveStep(const TimingMode timingMode, const PointInTime startTime) noexcept
+				: m_x_time(MouseSettings::MICROSECONDS_MAX, startTime),
+				m_y_time(MouseSettings::MICROSECONDS_MAX, startTime),
+				m_is_advancing(timingMode == TimingMode::ADVANCE_DEADLINE)
+			{
+			}
+			/// <summary>Checks the deadlines at the time now.</summary>
+			/// <returns>the move to send, or std::nullopt when no axis is due</returns>
+			[[nodiscard]] std::optional<MoveType> Step(const MoveState& state, const PointInTime now) noexcept
+			{
+				const bool isXPast = m_x_time.IsElapsed(now);
+				const bool isYPast = m_y_time.IsElapsed(now);
+				std::optional<MoveType> move{};
+				if (m_was_x_moving || m_was_y_moving)
+				{
+					int xVal = 0;
+					int yVal = 0;
+					if (isXPast && state.IsXMoving)
+					{
+						xVal = (state.IsXPositive ? MouseSettings::PIXELS_MAGNITUDE : (-MouseSettings::PIXELS_MAGNITUDE));
+						RestartDelay(m_x_time, state.XDelay, now);
+					}
+					if (isYPast && state.IsYMoving)
+					{
+						yVal = (state.IsYPositive ? -MouseSettings::PIXELS_MAGNITUDE : (MouseSettings::PIXELS_MAGNITUDE)); // y is inverted
+						RestartDelay(m_y_time, state.YDelay, now);
+					}
+					if (xVal != 0 || yVal != 0)
+						move = MoveType{ xVal, yVal };
+				}
+				m_was_x_moving = state.IsXMoving;
+				m_was_y_moving = state.IsYMoving;
+				return move;
+			}
+			/// <summary>The earliest time a Step() with this state may move, PointInTime::max() when neither axis is moving.
+			///	May be a time already passed, for an axis that has just started moving.</summary>
+			[[nodiscard]] PointInTime GetNextMoveTime(const MoveState& state) const noexcept
+			{
+				//IsElapsed() is true after the deadline
+				const PointInTime xAt = state.IsXMoving ? m_x_time.GetDeadline() + PointInTime::duration(1) : PointInTime::max();
+				const PointInTime yAt = state.IsYMoving ? m_y_time.GetDeadline() + PointInTime::duration(1) : PointInTime::max();
+				return std::min(xAt, yAt);
+			}
+		private:
+			void RestartDelay(Utilities::DelayManager& axisTime, const size_t delay, const PointInTime now) const noexcept
+			{
+				if (m_is_advancing)
+					axisTime.Advance(delay, now);
+				else
+					axisTime.Reset(delay, now);
+			}
+		};
+	private:
+		const MoveSinkType m_move_sink{};
+		std::atomic<TimingMode> m_timing_mode{ TimingMode::RESET_FROM_NOW };
 		std::atomic<size_t> m_x_axis_delay{ 1 };
 		std::atomic<size_t> m_y_axis_delay{ 1 };
 		std::atomic<bool> m_is_x_moving{ false };
@@ -30,6 +127,18 @@ namespace sds
 			InitWorkThread();
 			m_workThread->StartThread();
 		}
+		/// <param name="policy">scheduling policy for the mover thread</param>
+		/// <param name="moveSink">function receiving each move in place of SendInput, or empty to send input</param>
+		/// <param name="timingMode">how the next move of an axis is timed</param>
+		/// <param name="isStarted">false to construct stopped, see Start()</param>
+		explicit MouseMoveThread(const Utilities::ThreadPolicy& policy, MoveSinkType moveSink = {}, const TimingMode timingMode = TimingMode::RESET_FROM_NOW, const bool isStarted = true) noexcept
+			: m_move_sink(std::move(moveSink)), m_timing_mode(timingMode)
+		{
+			InitWorkThread();
+			m_workThread->SetThreadPolicy(policy);
+			if (isStarted)
+				m_workThread->StartThread();
+		}
 		~MouseMoveThread() = default;
 		MouseMoveThread(const MouseMoveThread& other) = delete;
 		MouseMoveThread(MouseMoveThread&& other) = delete;
@@ -46,44 +155,58 @@ namespace sds
 			m_is_x_moving = isXMoving;
 			m_is_y_moving = isYMoving;
 		}
+		/// <summary>Starts, or resumes, sending moves for the state given to UpdateState().</summary>
+		void Start() noexcept
+		{
+			m_workThread->StartThread();
+		}
+		/// <summary>Stops sending moves and clears the state, waits for the thread to park.</summary>
+		void Stop() noexcept
+		{
+			m_workThread->StopThread();
+			UpdateState(1, 1, false, false, false, false);
+		}
+		[[nodiscard]] bool IsRunning() const noexcept
+		{
+			return m_workThread->IsRunning();
+		}
+		/// <summary>Sets the scheduling policy of the thread, takes effect the next time it is started.</summary>
+		void SetThreadPolicy(const Utilities::ThreadPolicy& policy)
+		{
+			m_workThread->SetThreadPolicy(policy);
+		}
+		[[nodiscard]] Utilities::ThreadPolicy GetThreadPolicy() const
+		{
+			return m_workThread->GetThreadPolicy();
+		}
+		/// <summary>Sets how moves are timed, takes effect the next time the thread is started.</summary>
+		void SetTimingMode(const TimingMode mode) noexcept
+		{
+			m_timing_mode = mode;
+		}
+		[[nodiscard]] TimingMode GetTimingMode() const noexcept
+		{
+			return m_timing_mode;
+		}
 	protected:
 		void workThread(const sds::LambdaArgs::LambdaArg1& stopCondition, sds::LambdaArgs::LambdaArg2&, InternalType&) const noexcept
 		{
-			using namespace std::chrono;
+			using ClockType = std::chrono::high_resolution_clock;
 			Utilities::SendMouseInput keySend;
-			Utilities::DelayManager xTime(MouseSettings::MICROSECONDS_MAX);
-			Utilities::DelayManager yTime(MouseSettings::MICROSECONDS_MAX);
 			//A loop with no delay, that checks each delay value
 			//against a timepoint, and performs the move for that axis if it beyond the timepoint
 			//and in that way, will perform the single pixel move with two different variable time delays.
-			bool isXM = false;
-			bool isYM = false;
+			MoveStep step(m_timing_mode, ClockType::now());
 			while (!stopCondition)
 			{
-				const bool isXPos = m_is_x_positive;
-				const bool isYPos = m_is_y_positive;
-				const size_t xDelay = m_x_axis_delay;
-				const size_t yDelay = m_y_axis_delay;
-				const bool isXPast = xTime.IsElapsed();
-				const bool isYPast = yTime.IsElapsed();
-				if (isXM || isYM)
+				const MoveState state{ m_x_axis_delay, m_y_axis_delay, m_is_x_positive, m_is_y_positive, m_is_x_moving, m_is_y_moving };
+				if (const auto move = step.Step(state, ClockType::now()))
 				{
-					int xVal = 0;
-					int yVal = 0;
-					if (isXPast && m_is_x_moving)
-					{
-						xVal = (isXPos ? MouseSettings::PIXELS_MAGNITUDE : (-MouseSettings::PIXELS_MAGNITUDE));
-						xTime.Reset(xDelay);
-					}
-					if (isYPast && m_is_y_moving)
-					{
-						yVal = (isYPos ? -MouseSettings::PIXELS_MAGNITUDE : (MouseSettings::PIXELS_MAGNITUDE)); // y is inverted
-						yTime.Reset(yDelay);
-					}
-					keySend.SendMouseMove(xVal, yVal);
+					if (m_move_sink)
+						m_move_sink(move->first, move->second);
+					else
+						keySend.SendMouseMove(move->first, move->second);
 				}
-				isXM = m_is_x_moving;
-				isYM = m_is_y_moving;
 			}
 		}
 
@@ -14,6 +14,18 @@ namespace sds
 		static constexpr int PIXELS_NOMOVE{ 0 };
 		//Input Poller thread delay, in milliseconds.
 		static constexpr int THREAD_DELAY_POLLER{ 10 };
+		//Input Poller fastest thread delay, in microseconds, used while the controller state is changing.
+		static constexpr int MICROSECONDS_POLLER_FAST{ 1000 };
+		//Input Poller slowest thread delay, in microseconds, decayed to while the controller is idle.
+		static constexpr int MICROSECONDS_POLLER_SLOW{ 20000 };
+		//Input Poller number of unchanged polls at the fast rate before the delay starts to decay.
+		static constexpr int POLLER_IDLE_COUNT_BEFORE_DECAY{ 100 };
+		//Scroll tick is the fixed interval, in microseconds, at which accumulated scroll wheel deltas are sent.
+		static constexpr int SCROLL_TICK_MICROSECONDS{ 8000 };
+		//Scroll speed is the wheel units per second sent at full thumbstick deflection, WHEEL_DELTA (120) units is one notch.
+		static constexpr int SCROLL_SPEED_MIN{ 120 };
+		static constexpr int SCROLL_SPEED_MAX{ 12000 };
+		static constexpr int SCROLL_SPEED_DEFAULT{ 1200 };
 		//SMax is the value of the Microsoft type "SHORT"'s maximum possible value.
 		static constexpr short SMax{ std::numeric_limits<SHORT>::max() };
 		//SMin is the value of the Microsoft type "SHORT"'s minimum possible value.
@@ -39,6 +51,12 @@ namespace sds
 		//Alt Deadzone Default is the multiplier to use when a deadzone is already activated,
 		//the deadzone value for the other axis is lessened via this value.
 		static constexpr float ALT_DEADZONE_MULT_DEFAULT{ 0.75f };
+		//Stick filter defaults, for the optional OneEuroFilter stage on the normalized [-1,1] thumbstick values.
+		//Min cutoff is the cutoff in Hz while the stick is still, beta is the cutoff increase in Hz per unit per second of stick speed,
+		//and dcutoff is the cutoff in Hz of the speed estimate.
+		static constexpr float STICK_FILTER_MIN_CUTOFF_DEFAULT{ 2.0f };
+		static constexpr float STICK_FILTER_BETA_DEFAULT{ 2.0f };
+		static constexpr float STICK_FILTER_DCUTOFF_DEFAULT{ 1.0f };
 		//Static assertions about the const members
 		static_assert(SENSITIVITY_MAX < MICROSECONDS_MAX);
 		static_assert(SENSITIVITY_MIN >= 1);
@@ -48,6 +66,11 @@ namespace sds
 		static_assert(MICROSECONDS_MIN < MICROSECONDS_MAX);
 		static_assert(MICROSECONDS_MIN_MAX < MICROSECONDS_MAX);
 		static_assert(MICROSECONDS_MIN_MAX > MICROSECONDS_MIN);
+		static_assert(MICROSECONDS_POLLER_FAST > 0);
+		static_assert(MICROSECONDS_POLLER_FAST <= MICROSECONDS_POLLER_SLOW);
+		static_assert(STICK_FILTER_MIN_CUTOFF_DEFAULT > 0.0f && STICK_FILTER_BETA_DEFAULT >= 0.0f && STICK_FILTER_DCUTOFF_DEFAULT > 0.0f);
+		static_assert(SCROLL_TICK_MICROSECONDS > 0);
+		static_assert(SCROLL_SPEED_MIN > 0 && SCROLL_SPEED_MIN <= SCROLL_SPEED_DEFAULT && SCROLL_SPEED_DEFAULT <= SCROLL_SPEED_MAX);
 		[[nodiscard]] static constexpr bool IsValidSensitivityValue(int newSens) noexcept
 		{
 			return (newSens <= SENSITIVITY_MAX) && (newSens >= SENSITIVITY_MIN);
@@ -56,6 +79,10 @@ namespace sds
 		{
 			return (dz <= DEADZONE_MAX) && (dz >= DEADZONE_MIN);
 		}
+		[[nodiscard]] static constexpr bool IsValidScrollSpeed(int speed) noexcept
+		{
+			return (speed <= SCROLL_SPEED_MAX) && (speed >= SCROLL_SPEED_MIN);
+		}
 		[[nodiscard]] static constexpr bool IsValidThumbstickValue(int thumb) noexcept
 		{
 			return (thumb <= SMax) && (thumb >= SMin);
@@ -0,0 +1,93 @@
+#pragma once
+#include <cmath>
+#include <string>
+#include <numbers>
+
+namespace sds::Utilities
+{
+	/// <summary>Parameters of a OneEuroFilter.</summary>
+	struct OneEuroParameters
+	{
+		//cutoff frequency in Hz while the signal is still, lower removes more jitter and adds more lag at low speeds
+		float MinCutoffHz{ 1.0f };
+		//cutoff increase in Hz per unit of signal speed (units per second), higher reduces lag during fast motion
+		float Beta{ 0.0f };
+		//cutoff frequency in Hz of the speed estimate itself
+		float DerivativeCutoffHz{ 1.0f };
+		/// <returns>a std::string containing an error message if the parameters are unusable, empty string otherwise.</returns>
+		[[nodiscard]] std::string Validate() const
+		{
+			if (!std::isfinite(MinCutoffHz) || MinCutoffHz <= 0.0f)
+				return "OneEuroParameters::Validate(): MinCutoffHz must be greater than 0.";
+			if (!std::isfinite(Beta) || Beta < 0.0f)
+				return "OneEuroParameters::Validate(): Beta must not be negative.";
+			if (!std::isfinite(DerivativeCutoffHz) || DerivativeCutoffHz <= 0.0f)
+				return "OneEuroParameters::Validate(): DerivativeCutoffHz must be greater than 0.";
+			return "";
+		}
+	};
+	/// <summary>
+	/// The "1 Euro" adaptive low-pass filter for a noisy scalar signal (Casiez, Roussel, Vogel, CHI 2012).
+	///	An exponential smoother whose cutoff frequency rises with the filtered speed of the signal,
+	///	so a slow or still signal is heavily smoothed while fast motion passes with little lag.
+	///	Holds only a few floats and does no allocation, cheap enough to run for every poll.
+	/// </summary>
+	class OneEuroFilter
+	{
+	public:
+		using Parameters = OneEuroParameters;
+	private:
+		Parameters m_params;
+		float m_last_value{ 0.0f };
+		float m_last_speed{ 0.0f };
+		bool m_has_value{ false };
+	public:
+		explicit OneEuroFilter(const Parameters& params = {}) noexcept : m_params(params) { }
+
+		/// <summary>Filters the next sample of the signal.</summary>
+		/// <param name="value">the raw sample</param>
+		/// <param name="dtSeconds">time since the previous sample, in seconds</param>
+		/// <returns>the filtered value, the first sample after construction or Reset() is returned unchanged.</returns>
+		float Filter(const float value, const float dtSeconds) noexcept
+		{
+			if (!m_has_value || !(dtSeconds > 0.0f))
+			{
+				//no time has passed (or no history), nothing to smooth against
+				if (!m_has_value)
+				{
+					m_last_value = value;
+					m_last_speed = 0.0f;
+					m_has_value = true;
+				}
+				return m_last_value;
+			}
+			const float speed = (value - m_last_value) / dtSeconds;
+			m_last_speed = Smooth(m_last_speed, speed, Alpha(m_params.DerivativeCutoffHz, dtSeconds));
+			const float cutoff = m_params.MinCutoffHz + m_params.Beta * std::abs(m_last_speed);
+			m_last_value = Smooth(m_last_value, value, Alpha(cutoff, dtSeconds));
+			return m_last_value;
+		}
+		/// <summary>Forgets the signal history, the next sample is passed through unchanged.</summary>
+		void Reset() noexcept
+		{
+			m_has_value = false;
+			m_last_value = 0.0f;
+			m_last_speed = 0.0f;
+		}
+		[[nodiscard]] const Parameters& GetParameters() const noexcept
+		{
+			return m_params;
+		}
+	private:
+		/// <summary>Smoothing factor of an exponential smoother with the given cutoff, at the given sample interval.</summary>
+		[[nodiscard]] static float Alpha(const float cutoffHz, const float dtSeconds) noexcept
+		{
+			const float tau = 1.0f / (2.0f * std::numbers::pi_v<float> * cutoffHz);
+			return 1.0f / (1.0f + tau / dtSeconds);
+		}
+		[[nodiscard]] static float Smooth(const float previous, const float value, const float alpha) noexcept
+		{
+			return previous + alpha * (value - previous);
+		}
+	};
+}
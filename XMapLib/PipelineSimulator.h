@@ -0,0 +1,190 @@
+#pragma once
+#include "stdafx.h"
+#include "VirtualClock.h"
+#include "KeystrokeSynthesizer.h"
+#include "KeyboardTranslator.h"
+#include "ThumbstickProcessor.h"
+#include "ThumbstickFilter.h"
+#include "MouseMoveThread.h"
+#include <optional>
+
+namespace sds
+{
+	/// <summary>
+	/// Runs the controller state to output pipeline on a virtual clock, from a single stepping loop and without threads.
+	///	Each poll interval the scripted controller state is passed through the KeystrokeSynthesizer and KeyboardTranslator,
+	///	as with KeystrokeSource::STATE_FEED, and through the optional ThumbstickFilter and a ThumbstickProcessor, with the mouse mover's
+	///	MouseMoveThread::MoveStep run at each virtual time it may move between the polls. Nothing is sent to the OS, the output events go to an optional sink
+	///	and are summarized by a hash, so the same script always produces the same output, in much less than real time.
+	///	Macros, played on a real time TimerQueue, are not simulated.
+	/// </summary>
+	class PipelineSimulator
+	{
+	public:
+		using ClockType = Utilities::VirtualClock::ClockType;
+		using PointInTime = Utilities::VirtualClock::PointInTime;
+		struct OutputEvent
+		{
+			enum class EventType : int
+			{
+				KEY_DOWN = 0,
+				KEY_UP = 1,
+				MOUSE_MOVE = 2
+			};
+			std::chrono::microseconds Time{ 0 }; // virtual time since the start
+			EventType Type{ EventType::KEY_DOWN };
+			int VirtualKey{ 0 }; // for the key events
+			int X{ 0 }; // for the mouse move
+			int Y{ 0 };
+			friend bool operator==(const OutputEvent& lhs, const OutputEvent& rhs) = default;
+		};
+		using OutputSinkType = std::function<void(const OutputEvent&)>;
+	private:
+		using EventType = OutputEvent::EventType;
+		static constexpr std::uint64_t HASH_OFFSET{ 14695981039346656037ull };
+		static constexpr std::uint64_t HASH_PRIME{ 1099511628211ull };
+		Utilities::VirtualClock m_clock{};
+		KeystrokeSynthesizer m_synthesizer{};
+		KeyboardTranslator m_translator{};
+		std::optional<ThumbstickProcessor> m_stick{};
+		std::optional<ThumbstickFilter> m_stick_filter{};
+		XINPUT_STATE m_state{};
+		const std::chrono::microseconds m_poll_interval;
+		MouseMoveThread::MoveStep m_mover{ MouseMoveThread::TimingMode::RESET_FROM_NOW, PointInTime{} };
+		OutputSinkType m_sink{};
+		std::uint64_t m_output_hash{ HASH_OFFSET };
+		size_t m_key_event_count{ 0 };
+		size_t m_move_event_count{ 0 };
+	public:
+		/// <param name="player">mouse settings, the deadzones</param>
+		/// <param name="sensitivity">mouse sensitivity for both axes</param>
+		/// <param name="stick">thumbstick moving the mouse, NEITHER_STICK for none</param>
+		/// <param name="pollInterval">virtual time between polls of the scripted state</param>
+		explicit PipelineSimulator(const MousePlayerInfo& player = {},
+			const int sensitivity = MouseSettings::SENSITIVITY_DEFAULT,
+			const StickMap stick = StickMap::RIGHT_STICK,
+			const std::chrono::microseconds pollInterval = std::chrono::microseconds(MouseSettings::MICROSECONDS_POLLER_FAST))
+			: m_poll_interval(std::max(pollInterval, std::chrono::microseconds(1)))
+		{
+			if (stick != StickMap::NEITHER_STICK)
+				m_stick.emplace(sensitivity, sensitivity, player, stick);
+			m_translator.SetKeySink([this](const int vk, const bool keyDown)
+			{
+				Emit(OutputEvent{ m_clock.GetElapsed(), keyDown ? EventType::KEY_DOWN : EventType::KEY_UP, vk, 0, 0 });
+			});
+		}
+		PipelineSimulator(const PipelineSimulator& other) = delete;
+		PipelineSimulator(PipelineSimulator&& other) = delete;
+		PipelineSimulator& operator=(const PipelineSimulator& other) = delete;
+		PipelineSimulator& operator=(PipelineSimulator&& other) = delete;
+		~PipelineSimulator() = default;
+
+		/// <returns>a std::string containing an error message if there is an error, empty string otherwise.</returns>
+		std::string AddKeyMap(const KeyboardKeyMap& map)
+		{
+			return m_translator.AddKeyMap(map);
+		}
+		/// <summary>Sets a function receiving each output event, in order.</summary>
+		void SetOutputSink(OutputSinkType sink)
+		{
+			m_sink = std::move(sink);
+		}
+		/// <summary>Enables the thumbstick noise filter stage, as with MouseMapper::SetStickFilter(), or disables it with std::nullopt.</summary>
+		/// <returns>a std::string containing an error message if there is an error, empty string otherwise.</returns>
+		std::string SetStickFilter(const std::optional<ThumbstickFilter::ParamType>& params)
+		{
+			if (!params)
+			{
+				m_stick_filter.reset();
+				return "";
+			}
+			std::string er = params->Validate();
+			if (er.empty())
+				m_stick_filter.emplace(*params);
+			return er;
+		}
+		/// <summary>Sets how the mouse moves are timed, as with MouseMapper::SetMoverTimingMode(), the mover restarts at the current virtual time.</summary>
+		void SetMoverTimingMode(const MouseMoveThread::TimingMode mode) noexcept
+		{
+			m_mover = MouseMoveThread::MoveStep(mode, m_clock.Now());
+		}
+		/// <summary>Sets the controller state returned by the polls from now on.</summary>
+		void SetState(const XINPUT_STATE& state) noexcept
+		{
+			m_state = state;
+		}
+		/// <summary>Polls and processes the current state every poll interval, advancing the virtual clock by the duration.</summary>
+		void RunFor(const std::chrono::microseconds duration)
+		{
+			const PointInTime end = m_clock.Now() + duration;
+			while (m_clock.Now() < end)
+			{
+				const PointInTime now = m_clock.Now();
+				const PointInTime next = std::min(now + m_poll_interval, end);
+				const size_t count = m_synthesizer.ProcessState(m_state, now, [this, now](const XINPUT_KEYSTROKE& stroke)
+				{
+					m_translator.ProcessKeystroke(stroke, now);
+				});
+				//the key update and repeat loops run with every keystroke, an empty one keeps them running
+				if (count == 0)
+					m_translator.ProcessKeystroke(XINPUT_KEYSTROKE{}, now);
+				if (m_stick)
+					StepMover(ProcessStick(std::chrono::duration<float>(next - now).count()), now, next);
+				m_clock.Advance(std::chrono::duration_cast<std::chrono::microseconds>(next - now));
+			}
+		}
+		/// <summary>Virtual time since the start.</summary>
+		[[nodiscard]] std::chrono::microseconds GetElapsed() const noexcept
+		{
+			return m_clock.GetElapsed();
+		}
+		/// <summary>FNV-1a hash of every output event so far, equal for equal outputs.</summary>
+		[[nodiscard]] std::uint64_t GetOutputHash() const noexcept
+		{
+			return m_output_hash;
+		}
+		[[nodiscard]] size_t GetKeyEventCount() const noexcept
+		{
+			return m_key_event_count;
+		}
+		[[nodiscard]] size_t GetMoveEventCount() const noexcept
+		{
+			return m_move_event_count;
+		}
+	private:
+		/// <summary>Runs the stick values of the current state through the filter, if enabled, and the stick processor.</summary>
+		ThumbstickProcessor::Output ProcessStick(const float dtSeconds)
+		{
+			const bool isLeft = m_stick->GetStick() == StickMap::LEFT_STICK;
+			ThumbstickFilter::Output axes{ isLeft ? m_state.Gamepad.sThumbLX : m_state.Gamepad.sThumbRX, isLeft ? m_state.Gamepad.sThumbLY : m_state.Gamepad.sThumbRY };
+			if (m_stick_filter)
+				axes = m_stick_filter->Process(axes.X, axes.Y, dtSeconds);
+			return m_stick->Process(axes.X, axes.Y);
+		}
+		/// <summary>Sends the moves MouseMoveThread would send in [from,to), running its step
+		///	at each time the mover thread's loop could first see an axis due.</summary>
+		void StepMover(const ThumbstickProcessor::Output& move, const PointInTime from, const PointInTime to)
+		{
+			const MouseMoveThread::MoveState state{ move.XDelay, move.YDelay, move.IsXPositive, move.IsYPositive, move.IsXMoving, move.IsYMoving };
+			for (PointInTime at = from; at < to; at = std::max(at, m_mover.GetNextMoveTime(state)))
+			{
+				if (const auto pixels = m_mover.Step(state, at))
+					Emit(OutputEvent{ std::chrono::duration_cast<std::chrono::microseconds>(at - PointInTime{}), EventType::MOUSE_MOVE, 0, pixels->first, pixels->second });
+			}
+		}
+		void Emit(const OutputEvent& e)
+		{
+			if (e.Type == EventType::MOUSE_MOVE)
+				m_move_event_count++;
+			else
+				m_key_event_count++;
+			for (const auto value : { static_cast<std::int64_t>(e.Time.count()), static_cast<std::int64_t>(e.Type),
+				static_cast<std::int64_t>(e.VirtualKey), static_cast<std::int64_t>(e.X), static_cast<std::int64_t>(e.Y) })
+			{
+				m_output_hash = (m_output_hash ^ static_cast<std::uint64_t>(value)) * HASH_PRIME;
+			}
+			if (m_sink)
+				m_sink(e);
+		}
+	};
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include "stdafx.h"
+#include <cmath>
+
+namespace sds
+{
+	/// <summary>
+	/// Describes the response of a thumbstick, the shape of the mapping from the normalized stick
+	///	magnitude [0,1] past the deadzone to the normalized output speed [0,1].
+	///	Meant to be evaluated once into a lookup table when settings are applied, see SensitivityMapper::BuildSensitivityTable(),
+	///	never per tick.
+	/// </summary>
+	struct ResponseCurve
+	{
+		enum class CurveType : int
+		{
+			LINEAR = 0, // the original linear ramp
+			EXPONENTIAL = 1, // t^Exponent, above 1 gives finer control near the center
+			SCURVE = 2, // logistic, Exponent is the steepness, slow near the center and near full deflection
+			PIECEWISE = 3 // straight lines through ControlPoints, with implied end points (0,0) and (1,1)
+		};
+		using PointType = std::pair<float, float>;
+		//Struct members
+		CurveType Type{ CurveType::LINEAR };
+		float Exponent{ 2.0f };
+		std::vector<PointType> ControlPoints{};
+
+		[[nodiscard]] static ResponseCurve Linear() { return ResponseCurve{}; }
+		[[nodiscard]] static ResponseCurve Exponential(const float exponent) { return ResponseCurve{ CurveType::EXPONENTIAL, exponent, {} }; }
+		[[nodiscard]] static ResponseCurve SCurve(const float steepness) { return ResponseCurve{ CurveType::SCURVE, steepness, {} }; }
+		[[nodiscard]] static ResponseCurve Piecewise(std::vector<PointType> points) { return ResponseCurve{ CurveType::PIECEWISE, 1.0f, std::move(points) }; }
+
+		/// <returns>a std::string containing an error message if the curve is unusable, empty string otherwise.</returns>
+		[[nodiscard]] std::string Validate() const
+		{
+			switch (Type)
+			{
+			case CurveType::LINEAR:
+				return "";
+			case CurveType::EXPONENTIAL:
+			case CurveType::SCURVE:
+				if (!std::isfinite(Exponent) || Exponent <= 0.0f || Exponent > 64.0f)
+					return "ResponseCurve::Validate(): Exponent must be in (0,64].";
+				return "";
+			case CurveType::PIECEWISE:
+			{
+				float lastX = 0.0f;
+				for (const auto& [x, y] : ControlPoints)
+				{
+					if (!(x > lastX && x < 1.0f) || !(y >= 0.0f && y <= 1.0f))
+						return "ResponseCurve::Validate(): Control points must have ascending x in (0,1), and y in [0,1].";
+					lastX = x;
+				}
+				return "";
+			}
+			default:
+				return "ResponseCurve::Validate(): Unknown curve type.";
+			}
+		}
+		/// <summary>Evaluates the curve, not for use per tick.</summary>
+		/// <param name="t">normalized input, clamped to [0,1]</param>
+		/// <returns>normalized output in [0,1]</returns>
+		[[nodiscard]] float Evaluate(float t) const noexcept
+		{
+			t = std::clamp(t, 0.0f, 1.0f);
+			float result = t;
+			switch (Type)
+			{
+			case CurveType::EXPONENTIAL:
+				result = std::pow(t, Exponent);
+				break;
+			case CurveType::SCURVE:
+			{
+				//logistic function rescaled so f(0) = 0 and f(1) = 1
+				auto Logistic = [this](const float v) { return 1.0f / (1.0f + std::exp(-Exponent * (v - 0.5f))); };
+				const float low = Logistic(0.0f);
+				const float high = Logistic(1.0f);
+				result = (Logistic(t) - low) / (high - low);
+				break;
+			}
+			case CurveType::PIECEWISE:
+			{
+				PointType previous{ 0.0f, 0.0f };
+				for (const auto& point : ControlPoints)
+				{
+					if (t <= point.first)
+						return Lerp(previous, point, t);
+					previous = point;
+				}
+				result = Lerp(previous, PointType{ 1.0f, 1.0f }, t);
+				break;
+			}
+			default:
+				break;
+			}
+			return std::clamp(result, 0.0f, 1.0f);
+		}
+		friend bool operator==(const ResponseCurve& lhs, const ResponseCurve& rhs) = default;
+	private:
+		[[nodiscard]] static float Lerp(const PointType& a, const PointType& b, const float t) noexcept
+		{
+			if (b.first <= a.first)
+				return b.second;
+			return a.second + (b.second - a.second) * ((t - a.first) / (b.first - a.first));
+		}
+	};
+}
@@ -0,0 +1,218 @@
+#pragma once
+#include "stdafx.h"
+#include "ThumbstickToDelay.h"
+#include "Utilities.h"
+
+namespace sds
+{
+	/// <summary>
+	/// Maps a thumbstick to mouse wheel scrolling, stick Y to the vertical wheel and optionally stick X to the horizontal wheel.
+	///	The stick value past the deadzone is mapped through a response curve table to a scroll speed, fractional wheel
+	///	units accumulate every tick and the whole units are sent as high resolution wheel events, at a fixed tick.
+	///	Pass every polled XINPUT_STATE to FeedState(), see MouseMapper::SetStateListener(), so no more polling thread is used.
+	///	Settings changes are picked up by the running worker on its next tick.
+	/// </summary>
+	class ScrollMapper
+	{
+		using InternalType = XINPUT_STATE;
+		using LambdaRunnerType = sds::CPPRunnerGeneric<InternalType>;
+		using lock = LambdaRunnerType::ScopedLockType;
+		using ClockType = std::chrono::steady_clock;
+	public:
+		/// <summary>Number of rate table elements, one per value of ThumbstickToDelay::GetRangedThumbstickValue().</summary>
+		static constexpr size_t RATE_TABLE_SIZE{ MouseSettings::SENSITIVITY_MAX - MouseSettings::SENSITIVITY_MIN + 1 };
+	private:
+		std::atomic<StickMap> m_stickmap_info{ StickMap::NEITHER_STICK };
+		//Settings read by the worker thread, written under m_config_mutex and published by incrementing m_config_version.
+		std::mutex m_config_mutex{};
+		std::atomic<unsigned> m_config_version{ 0 };
+		int m_scroll_speed{ MouseSettings::SCROLL_SPEED_DEFAULT };
+		bool m_is_horizontal_enabled{ false };
+		ResponseCurve m_response_curve{};
+		sds::MousePlayerInfo m_local_player{};
+		std::unique_ptr<LambdaRunnerType> m_workThread{};
+		void InitWorkThread() noexcept
+		{
+			m_workThread =
+				std::make_unique<LambdaRunnerType>
+				([this](const sds::LambdaArgs::LambdaArg1& stopCondition, sds::LambdaArgs::LambdaArg2& mut, InternalType& protectedData) { workThread(stopCondition, mut, protectedData); });
+			m_workThread->SetThreadPolicy(Utilities::ThreadPolicy::ForOutput());
+		}
+	public:
+		/// <summary>Ctor for default configuration</summary>
+		ScrollMapper()
+		{
+			InitWorkThread();
+		}
+		/// <summary>Ctor allows setting a custom MousePlayerInfo</summary>
+		explicit ScrollMapper(const sds::MousePlayerInfo& player) : m_local_player(player)
+		{
+			InitWorkThread();
+		}
+		ScrollMapper(const ScrollMapper& other) = delete;
+		ScrollMapper(ScrollMapper&& other) = delete;
+		ScrollMapper& operator=(const ScrollMapper& other) = delete;
+		ScrollMapper& operator=(ScrollMapper&& other) = delete;
+		~ScrollMapper()
+		{
+			Stop();
+		}
+
+		/// <summary>Sets the thumbstick used for scrolling, starts processing if the stick is something other than NEITHER_STICK.</summary>
+		void SetStick(const StickMap info) noexcept
+		{
+			if (m_stickmap_info != info)
+			{
+				Stop();
+				m_stickmap_info = info;
+				if (info != StickMap::NEITHER_STICK)
+					Start();
+			}
+		}
+		[[nodiscard]] StickMap GetStick() const noexcept
+		{
+			return m_stickmap_info;
+		}
+		/// <summary>Setter for the scroll speed at full deflection, in wheel units per second.</summary>
+		/// <returns> returns a std::string containing an error message
+		/// if there is an error, empty string otherwise. </returns>
+		std::string SetScrollSpeed(const int unitsPerSecond)
+		{
+			if (!MouseSettings::IsValidScrollSpeed(unitsPerSecond))
+				return "Error in sds::ScrollMapper::SetScrollSpeed(), int unitsPerSecond out of range.";
+			PublishConfig([&]() { m_scroll_speed = unitsPerSecond; });
+			return "";
+		}
+		[[nodiscard]] int GetScrollSpeed()
+		{
+			std::lock_guard configLock(m_config_mutex);
+			return m_scroll_speed;
+		}
+		/// <summary>Enables horizontal scrolling from the stick X axis.</summary>
+		void SetHorizontalEnabled(const bool isEnabled)
+		{
+			PublishConfig([&]() { m_is_horizontal_enabled = isEnabled; });
+		}
+		/// <summary>Setter for the response curve, the scroll speed past the deadzone.</summary>
+		/// <returns> returns a std::string containing an error message
+		/// if there is an error, empty string otherwise. </returns>
+		std::string SetResponseCurve(const ResponseCurve& curve)
+		{
+			std::string er = curve.Validate();
+			if (!er.empty())
+				return er;
+			PublishConfig([&]() { m_response_curve = curve; });
+			return "";
+		}
+		/// <summary>Updates the state scrolled from, see MouseMapper::SetStateListener().</summary>
+		void FeedState(const XINPUT_STATE& state)
+		{
+			m_workThread->UpdateState(state);
+		}
+		[[nodiscard]] bool IsRunning() const noexcept
+		{
+			return m_workThread->IsRunning();
+		}
+		void Start() const noexcept
+		{
+			m_workThread->StartThread();
+		}
+		void Stop() const noexcept
+		{
+			m_workThread->StopThread();
+		}
+		/// <summary>Builds the rate table for AccumulateScroll(), the response curve evaluated over the ranged thumbstick values.</summary>
+		/// <param name="unitsPerTick">wheel units per tick at full deflection</param>
+		[[nodiscard]] static std::vector<float> BuildRateTable(const ResponseCurve& curve, const float unitsPerTick)
+		{
+			return SensitivityMapper{}.BuildRateTable(curve, MouseSettings::SENSITIVITY_MIN, MouseSettings::SENSITIVITY_MAX, unitsPerTick);
+		}
+		/// <summary>Accumulates one tick of scrolling for an axis value, returns the whole wheel units to send.</summary>
+		/// <param name="thumbstick">thumbstick axis value</param>
+		/// <param name="deadzone">axis deadzone</param>
+		/// <param name="rateTable">wheel units per tick for each ranged thumbstick value [1,100], see BuildRateTable()</param>
+		/// <param name="accumulator">in/out, the fractional wheel units not yet sent</param>
+		[[nodiscard]] static int AccumulateScroll(const int thumbstick, const int deadzone, const std::vector<float>& rateTable, float& accumulator) noexcept
+		{
+			if (Utilities::ConstAbs(thumbstick) <= deadzone || rateTable.size() != RATE_TABLE_SIZE)
+			{
+				//drop the remainder when released, so a later scroll doesn't start early
+				accumulator = 0.0f;
+				return 0;
+			}
+			const int percentage = ThumbstickToDelay::GetRangedThumbstickValue(thumbstick, deadzone);
+			const float rate = rateTable[static_cast<size_t>(percentage - MouseSettings::SENSITIVITY_MIN)];
+			accumulator += thumbstick > 0 ? rate : -rate;
+			const int units = static_cast<int>(accumulator);
+			accumulator -= static_cast<float>(units);
+			return units;
+		}
+	protected:
+		/// <summary>Worker thread, protected visibility.</summary>
+		void workThread(const sds::LambdaArgs::LambdaArg1& stopCondition, sds::LambdaArgs::LambdaArg2& mut, InternalType& protectedData)
+		{
+			using namespace std::chrono;
+			constexpr microseconds tick{ MouseSettings::SCROLL_TICK_MICROSECONDS };
+			Utilities::SendMouseInput wheel;
+			std::vector<float> rateTable;
+			bool isHorizontalEnabled = false;
+			int xDeadzone = 0;
+			int yDeadzone = 0;
+			unsigned configVersion = m_config_version.load() - 1;
+			float xAccumulator = 0.0f;
+			float yAccumulator = 0.0f;
+			{
+				//no scrolling from a state fed before this start
+				lock first(mut);
+				protectedData = {};
+			}
+			auto nextTick = ClockType::now();
+			//thread main loop
+			while (!stopCondition)
+			{
+				if (const unsigned currentVersion = m_config_version.load(std::memory_order_acquire); currentVersion != configVersion)
+				{
+					configVersion = currentVersion;
+					std::unique_lock configLock(m_config_mutex);
+					const ResponseCurve curve = m_response_curve;
+					const float unitsPerTick = static_cast<float>(m_scroll_speed) * duration<float>(tick).count();
+					isHorizontalEnabled = m_is_horizontal_enabled;
+					const bool isLeft = m_stickmap_info == StickMap::LEFT_STICK;
+					xDeadzone = isLeft ? m_local_player.left_x_dz : m_local_player.right_x_dz;
+					yDeadzone = isLeft ? m_local_player.left_y_dz : m_local_player.right_y_dz;
+					configLock.unlock();
+					rateTable = BuildRateTable(curve, unitsPerTick);
+				}
+				XINPUT_STATE state;
+				{
+					lock second(mut);
+					state = protectedData;
+				}
+				const bool isLeft = m_stickmap_info == StickMap::LEFT_STICK;
+				const int vertical = AccumulateScroll(isLeft ? state.Gamepad.sThumbLY : state.Gamepad.sThumbRY, yDeadzone, rateTable, yAccumulator);
+				if (vertical != 0)
+					wheel.SendMouseWheel(vertical, false);
+				if (isHorizontalEnabled)
+				{
+					const int horizontal = AccumulateScroll(isLeft ? state.Gamepad.sThumbLX : state.Gamepad.sThumbRX, xDeadzone, rateTable, xAccumulator);
+					if (horizontal != 0)
+						wheel.SendMouseWheel(horizontal, true);
+				}
+				//fixed tick, advanced from the previous deadline so the scroll rate doesn't drift
+				nextTick += tick;
+				const auto now = ClockType::now();
+				if (nextTick < now)
+					nextTick = now;
+				std::this_thread::sleep_until(nextTick);
+			}
+		}
+	private:
+		/// <summary>Makes a settings change under the config mutex and publishes it to the worker.</summary>
+		void PublishConfig(auto&& changeFn)
+		{
+			std::lock_guard configLock(m_config_mutex);
+			changeFn();
+			m_config_version.fetch_add(1, std::memory_order_release);
+		}
+	};
+}
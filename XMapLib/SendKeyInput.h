@@ -2,10 +2,14 @@
 #include "stdafx.h"
 #include <bitset>
 #include <climits>
-#include "XELog.h"
+#include "AsyncLog.h"
+#ifdef __linux__
+#include "SendUinput.h"
+#endif
 
 namespace sds::Utilities
 {
+#ifdef _WIN32
 	/// <summary>
 	/// Utility class for simulating input via Windows API.
 	/// SendKeyInput is used primarily for simulating keyboard input.
@@ -87,7 +91,7 @@ namespace sds::Utilities
 				tempInput.ki.wScan = scanCode;
 				const UINT ret = CallSendInput(&tempInput, 1);
 				if (ret == 0)
-					Utilities::LogError("SendInput returned 0");
+					Utilities::LogAsync(Utilities::LogMessageId::SEND_INPUT_FAILED, GetLastError());
 			}
 		}
 		/// <summary>Utility function to map a Virtual Keycode to a scancode</summary>
@@ -127,11 +131,11 @@ namespace sds::Utilities
 				{
 					auto result = SendVirtualKey(VK_NUMLOCK, true, true);
 					if (result != 1)
-						Utilities::LogError("Error sending numlock keypress down.");
+						Utilities::LogAsync(Utilities::LogMessageId::NUMLOCK_DOWN_FAILED);
 					std::this_thread::sleep_for(std::chrono::milliseconds(15));
 					result = SendVirtualKey(VK_NUMLOCK, true, false);
 					if (result != 1)
-						Utilities::LogError("Error sending numlock keypress up.");
+						Utilities::LogAsync(Utilities::LogMessageId::NUMLOCK_UP_FAILED);
 				};
 				std::thread numLockSender(DoNumlockSend);
 				numLockSender.detach(); // fire and forget
@@ -175,4 +179,30 @@ namespace sds::Utilities
 			return CallSendInput(&inp, 1);
 		}
 	};
+#elif defined(__linux__)
+	/// <summary>
+	/// Utility class for simulating keyboard input on Linux, the keys and mouse buttons are sent
+	///	through the shared uinput device, see SendUinput::GetShared().
+	/// </summary>
+	class SendKeyInput
+	{
+	public:
+		/// <summary>Default Constructor</summary>
+		SendKeyInput() = default;
+		//Numlock doesn't change the evdev key codes, there is nothing to disable
+		explicit SendKeyInput(const bool) { }
+		SendKeyInput(const SendKeyInput& other) = delete;
+		SendKeyInput(SendKeyInput&& other) = delete;
+		SendKeyInput& operator=(const SendKeyInput& other) = delete;
+		SendKeyInput& operator=(SendKeyInput&& other) = delete;
+		~SendKeyInput() = default;
+		/// <summary>Sends the virtual keycode as an evdev key event.</summary>
+		/// <param name="vk"> is the Virtual Keycode of the keystroke you wish to emulate </param>
+		/// <param name="down"> is a boolean denoting if the keypress event is KEYDOWN or KEYUP</param>
+		void SendScanCode(const int vk, const bool down) noexcept
+		{
+			SendUinput::GetShared().SendScanCode(vk, down);
+		}
+	};
+#endif
 }
\ No newline at end of file
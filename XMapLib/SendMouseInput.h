@@ -1,8 +1,13 @@
 #pragma once
 #include "stdafx.h"
+#include "AsyncLog.h"
+#ifdef __linux__
+#include "SendUinput.h"
+#endif
 
 namespace sds::Utilities
 {
+#ifdef _WIN32
 	/// <summary>
 	/// Utility class for simulating mouse movement input via the Windows API.
 	/// </summary>
@@ -30,7 +35,21 @@ namespace sds::Utilities
 			m_mouse_move_input.mi.dy = static_cast<LONG>(y);
 			m_mouse_move_input.mi.dwExtraInfo = GetMessageExtraInfo();
 			//Finally, send the input
-			CallSendInput(&m_mouse_move_input, 1);
+			if (CallSendInput(&m_mouse_move_input, 1) == 0)
+				LogAsync(LogMessageId::SEND_INPUT_FAILED, GetLastError());
+		}
+		/// <summary>Sends a mouse wheel rotation. High resolution deltas, smaller than WHEEL_DELTA (120) per notch, are allowed.</summary>
+		/// <param name="delta">wheel units, positive is forward (away from the user) or right</param>
+		/// <param name="isHorizontal">true for the horizontal wheel</param>
+		void SendMouseWheel(const int delta, const bool isHorizontal = false)
+		{
+			INPUT wheelInput{};
+			wheelInput.type = INPUT_MOUSE;
+			wheelInput.mi.dwFlags = isHorizontal ? MOUSEEVENTF_HWHEEL : MOUSEEVENTF_WHEEL;
+			wheelInput.mi.mouseData = static_cast<DWORD>(delta);
+			wheelInput.mi.dwExtraInfo = GetMessageExtraInfo();
+			if (CallSendInput(&wheelInput, 1) == 0)
+				LogAsync(LogMessageId::SEND_INPUT_FAILED, GetLastError());
 		}
 		/// <summary>One member function calls SendInput with the eventual built INPUT struct.
 		/// This is useful for debugging or re-routing the output for logging/testing of a real-time system.</summary>
@@ -41,4 +60,34 @@ namespace sds::Utilities
 			return SendInput(static_cast<UINT>(numSent), inp, sizeof(INPUT));
 		}
 	};
+#elif defined(__linux__)
+	/// <summary>
+	/// Utility class for simulating mouse movement input on Linux, through the shared uinput device, see SendUinput::GetShared().
+	/// </summary>
+	class SendMouseInput
+	{
+	public:
+		/// <summary>Default Constructor</summary>
+		SendMouseInput() = default;
+		SendMouseInput(const SendMouseInput& other) = delete;
+		SendMouseInput(SendMouseInput&& other) = delete;
+		SendMouseInput& operator=(const SendMouseInput& other) = delete;
+		SendMouseInput& operator=(SendMouseInput&& other) = delete;
+		~SendMouseInput() = default;
+		/// <summary>Sends mouse movement specified by X and Y number of pixels to move, in one write.</summary>
+		/// <param name="x">number of pixels in X</param>
+		/// <param name="y">number of pixels in Y</param>
+		void SendMouseMove(const int x, const int y)
+		{
+			SendUinput::GetShared().SendMouseMove(x, y);
+		}
+		/// <summary>Sends a mouse wheel rotation. High resolution deltas, smaller than WHEEL_DELTA (120) per notch, are allowed.</summary>
+		/// <param name="delta">wheel units, positive is forward (away from the user) or right</param>
+		/// <param name="isHorizontal">true for the horizontal wheel</param>
+		void SendMouseWheel(const int delta, const bool isHorizontal = false)
+		{
+			SendUinput::GetShared().SendMouseWheel(delta, isHorizontal);
+		}
+	};
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,214 @@
+#pragma once
+#include "stdafx.h"
+#include <bitset>
+#include "AsyncLog.h"
+#include "EvdevKeyCodes.h"
+#ifdef __linux__
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <cerrno>
+#endif
+
+namespace sds::Utilities
+{
+#ifdef __linux__
+	/// <summary>
+	/// Utility class for simulating keyboard and mouse input on Linux through a uinput virtual device,
+	///	the equivalent of SendKeyInput and SendMouseInput, which send through the shared device on Linux, see GetShared().
+	///	Virtual keys are translated with the compile-time Evdev::VIRTUAL_KEY_TO_EVDEV table.
+	///	Events are queued, and Flush() writes the queued events with a single SYN_REPORT in one write() call,
+	///	so a tick's X and Y move and key changes cost one syscall. The Send functions queue and flush.
+	///	Thread-safe, the queue is guarded by a mutex, a flush writes everything queued by any thread.
+	/// </summary>
+	class SendUinput
+	{
+	public:
+		using EventType = Evdev::EvdevEvent;
+		/// <summary>Events queued before a flush is forced, the storage is reserved up front.</summary>
+		static constexpr size_t MAX_BATCH_EVENTS{ 64 };
+		static constexpr int WHEEL_NOTCH{ 120 };
+	private:
+		/// <summary>Layout of the Linux 'struct uinput_setup'.</summary>
+		struct UinputSetup
+		{
+			uint16_t BusType{ 0x06 }; // BUS_VIRTUAL
+			uint16_t Vendor{ 0 };
+			uint16_t Product{ 0 };
+			uint16_t Version{ 1 };
+			std::array<char, 80> Name{};
+			uint32_t EffectsMax{ 0 };
+		};
+		static_assert(sizeof(UinputSetup) == 92);
+		int m_fd{ -1 };
+		bool m_is_owned{ false };
+		std::mutex m_batch_mutex{};
+		std::vector<EventType> m_batch{};
+		int m_wheel_remainder{ 0 };
+		int m_hwheel_remainder{ 0 };
+		std::atomic<size_t> m_write_count{ 0 };
+	public:
+		/// <summary>Default Constructor, creates the virtual device, see IsOpen().</summary>
+		SendUinput()
+			: m_fd(open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC)), m_is_owned(true)
+		{
+			m_batch.reserve(MAX_BATCH_EVENTS + 1);
+			if (m_fd < 0 || !CreateDevice())
+			{
+				LogAsync(LogMessageId::UINPUT_SETUP_FAILED, errno);
+				if (m_fd >= 0)
+					close(m_fd);
+				m_fd = -1;
+			}
+		}
+		/// <summary>Ctor writes to a descriptor already set up as a uinput device, or any other event stream such as a pipe.
+		///	The descriptor is not closed by this object.</summary>
+		explicit SendUinput(const int fd) : m_fd(fd)
+		{
+			m_batch.reserve(MAX_BATCH_EVENTS + 1);
+		}
+		SendUinput(const SendUinput& other) = delete;
+		SendUinput(SendUinput&& other) = delete;
+		SendUinput& operator=(const SendUinput& other) = delete;
+		SendUinput& operator=(SendUinput&& other) = delete;
+		~SendUinput()
+		{
+			Flush();
+			if (m_is_owned && m_fd >= 0)
+			{
+				//UI_DEV_DESTROY
+				ioctl(m_fd, _IO('U', 2));
+				close(m_fd);
+			}
+		}
+		/// <summary>The virtual device SendKeyInput and SendMouseInput send through on Linux, created on first use.</summary>
+		[[nodiscard]] static SendUinput& GetShared()
+		{
+			static SendUinput device;
+			return device;
+		}
+		/// <returns>true if the device is open.</returns>
+		[[nodiscard]] bool IsOpen() const noexcept
+		{
+			return m_fd >= 0;
+		}
+		/// <summary>Queues a key or mouse button event, keys with no evdev code are ignored.</summary>
+		/// <param name="vk"> is the Virtual Keycode of the keystroke you wish to emulate </param>
+		/// <param name="down"> is a boolean denoting if the keypress event is KEYDOWN or KEYUP</param>
+		void QueueKey(const int vk, const bool down)
+		{
+			const uint16_t code = Evdev::ToEvdevKeyCode(vk);
+			if (code == 0)
+				return;
+			std::lock_guard batchLock(m_batch_mutex);
+			QueueLocked(Evdev::EV_TYPE_KEY, code, down ? 1 : 0);
+		}
+		/// <summary>Queues a relative mouse move, an axis with no movement is not sent.</summary>
+		void QueueMouseMove(const int x, const int y)
+		{
+			std::lock_guard batchLock(m_batch_mutex);
+			if (x != 0)
+				QueueLocked(Evdev::EV_TYPE_REL, Evdev::REL_CODE_X, x);
+			if (y != 0)
+				QueueLocked(Evdev::EV_TYPE_REL, Evdev::REL_CODE_Y, y);
+		}
+		/// <summary>Queues a mouse wheel rotation, in WHEEL_DELTA units, as the high resolution wheel event,
+		///	and a notch event each time the accumulated rotation reaches a notch, for readers of the notch events only.</summary>
+		/// <param name="delta">wheel units, positive is forward (away from the user) or right</param>
+		/// <param name="isHorizontal">true for the horizontal wheel</param>
+		void QueueMouseWheel(const int delta, const bool isHorizontal = false)
+		{
+			if (delta == 0)
+				return;
+			std::lock_guard batchLock(m_batch_mutex);
+			int& remainder = isHorizontal ? m_hwheel_remainder : m_wheel_remainder;
+			QueueLocked(Evdev::EV_TYPE_REL, isHorizontal ? Evdev::REL_CODE_HWHEEL_HI_RES : Evdev::REL_CODE_WHEEL_HI_RES, delta);
+			remainder += delta;
+			const int notches = remainder / WHEEL_NOTCH;
+			if (notches != 0)
+			{
+				remainder -= notches * WHEEL_NOTCH;
+				QueueLocked(Evdev::EV_TYPE_REL, isHorizontal ? Evdev::REL_CODE_HWHEEL : Evdev::REL_CODE_WHEEL, notches);
+			}
+		}
+		/// <summary>Writes the queued events followed by a SYN_REPORT, in one write() call.</summary>
+		/// <returns>false if the write failed, the events are dropped.</returns>
+		bool Flush()
+		{
+			std::lock_guard batchLock(m_batch_mutex);
+			return FlushLocked();
+		}
+		/// <summary>Sends a key or mouse button event now, with anything already queued.</summary>
+		void SendScanCode(const int vk, const bool down)
+		{
+			QueueKey(vk, down);
+			Flush();
+		}
+		/// <summary>Sends mouse movement specified by X and Y number of pixels to move, with anything already queued.</summary>
+		void SendMouseMove(const int x, const int y)
+		{
+			QueueMouseMove(x, y);
+			Flush();
+		}
+		/// <summary>Sends a mouse wheel rotation, with anything already queued.</summary>
+		void SendMouseWheel(const int delta, const bool isHorizontal = false)
+		{
+			QueueMouseWheel(delta, isHorizontal);
+			Flush();
+		}
+		/// <summary>Telemetry, the number of write() calls made.</summary>
+		[[nodiscard]] size_t GetWriteCount() const noexcept
+		{
+			return m_write_count.load(std::memory_order_relaxed);
+		}
+	private:
+		void QueueLocked(const uint16_t type, const uint16_t code, const int32_t value)
+		{
+			if (m_batch.size() >= MAX_BATCH_EVENTS)
+				FlushLocked();
+			m_batch.push_back(EventType{ 0, 0, type, code, value });
+		}
+		bool FlushLocked()
+		{
+			if (m_batch.empty())
+				return true;
+			m_batch.push_back(EventType{ 0, 0, Evdev::EV_TYPE_SYN, Evdev::SYN_CODE_REPORT, 0 });
+			const size_t size = m_batch.size() * sizeof(EventType);
+			const ssize_t written = m_fd >= 0 ? write(m_fd, m_batch.data(), size) : -1;
+			m_write_count.fetch_add(1, std::memory_order_relaxed);
+			const bool isWritten = written == static_cast<ssize_t>(size);
+			if (!isWritten)
+				LogAsync(LogMessageId::UINPUT_WRITE_FAILED, written < 0 ? errno : 0, static_cast<std::int64_t>(m_batch.size()));
+			m_batch.clear();
+			return isWritten;
+		}
+		/// <summary>Enables the key, button, movement and wheel events, and creates the device.</summary>
+		[[nodiscard]] bool CreateDevice() const noexcept
+		{
+			//UI_SET_EVBIT, UI_SET_KEYBIT, UI_SET_RELBIT, UI_DEV_SETUP, UI_DEV_CREATE
+			const unsigned long SetEvBit = _IOW('U', 100, int);
+			const unsigned long SetKeyBit = _IOW('U', 101, int);
+			const unsigned long SetRelBit = _IOW('U', 102, int);
+			const unsigned long DevSetup = _IOW('U', 3, UinputSetup);
+			const unsigned long DevCreate = _IO('U', 1);
+			bool isSet = ioctl(m_fd, SetEvBit, static_cast<int>(Evdev::EV_TYPE_KEY)) == 0
+				&& ioctl(m_fd, SetEvBit, static_cast<int>(Evdev::EV_TYPE_REL)) == 0;
+			std::bitset<1024> keys;
+			for (const uint16_t code : Evdev::VIRTUAL_KEY_TO_EVDEV)
+			{
+				if (code != 0 && !keys[code])
+				{
+					keys[code] = true;
+					isSet = isSet && ioctl(m_fd, SetKeyBit, static_cast<int>(code)) == 0;
+				}
+			}
+			for (const uint16_t code : { Evdev::REL_CODE_X, Evdev::REL_CODE_Y, Evdev::REL_CODE_WHEEL, Evdev::REL_CODE_HWHEEL, Evdev::REL_CODE_WHEEL_HI_RES, Evdev::REL_CODE_HWHEEL_HI_RES })
+				isSet = isSet && ioctl(m_fd, SetRelBit, static_cast<int>(code)) == 0;
+			UinputSetup setup{};
+			constexpr std::string_view DeviceName{ "XMapLib virtual input" };
+			std::ranges::copy(DeviceName, setup.Name.begin());
+			return isSet && ioctl(m_fd, DevSetup, &setup) == 0 && ioctl(m_fd, DevCreate) == 0;
+		}
+	};
+#endif
+}
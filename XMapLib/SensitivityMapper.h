@@ -1,6 +1,7 @@
 #pragma once
 #include "stdafx.h"
 #include "Utilities.h"
+#include "ResponseCurve.h"
 #include <cmath>
 namespace sds
 {
@@ -8,6 +9,7 @@ namespace sds
 	{
 	public:
 		using SensMapType = std::map<int, int>;
+		using SensTableType = std::vector<int>;
 	private:
 		const std::string m_except_minimum{ "Exception in SensitivityMapper::SensitivityToMinimum(): " };
 		const std::string m_except_build_map{ "Exception in SensitivityMapper::BuildSensitivityMap(): " };
@@ -58,6 +60,78 @@ namespace sds
 			return sens_map;
 		}
 
+		/// <summary>Builds a dense sensitivity table, element [i] holds the microsecond delay for sensitivity value sens_min + i.
+		///	The response curve shapes the ramp from us_delay_max down to the sensitivity adjusted minimum,
+		///	it is evaluated here once so the lookup cost doesn't depend on the curve.
+		///	The linear curve produces the same values as BuildSensitivityMap().</summary>
+		/// <param name="curve">validated response curve, an invalid curve is logged and treated as linear</param>
+		/// <returns>vector of int, sens_max - sens_min + 1 elements</returns>
+		[[nodiscard]] SensTableType BuildSensitivityTable(const int user_sens,
+			const ResponseCurve& curve,
+			const int sens_min,
+			const int sens_max,
+			const int us_delay_min,
+			const int us_delay_max,
+			const int us_delay_min_max) const
+		{
+			using namespace sds::Utilities;
+			SensTableType table;
+			if (sens_min >= sens_max)
+			{
+				LogError(m_except_build_map + "sensitivity range out of range.");
+				return table;
+			}
+			table.reserve(static_cast<size_t>(sens_max - sens_min + 1));
+			const bool isCurveValid = curve.Validate().empty();
+			if (!isCurveValid)
+				LogError(m_except_build_map + curve.Validate());
+			if (curve.Type == ResponseCurve::CurveType::LINEAR || !isCurveValid)
+			{
+				for (const auto& [key, delay] : BuildSensitivityMap(user_sens, sens_min, sens_max, us_delay_min, us_delay_max, us_delay_min_max))
+					table.push_back(delay);
+				return table;
+			}
+			const int adjustedMinimum = SensitivityToMinimum(user_sens, sens_min, sens_max, us_delay_min, us_delay_min_max);
+			const float range = ToA<float>(us_delay_max) - ToA<float>(adjustedMinimum);
+			for (int i = sens_min; i <= sens_max; i++)
+			{
+				const float t = (ToA<float>(i) - ToA<float>(sens_min)) / (ToA<float>(sens_max) - ToA<float>(sens_min));
+				const int delay = ToA<int>(std::lroundf(ToA<float>(us_delay_max) - curve.Evaluate(t) * range));
+				table.push_back(std::clamp(delay, adjustedMinimum, us_delay_max));
+			}
+			return table;
+		}
+
+		/// <summary>Builds a dense rate table, element [i] holds the output rate for input value in_min + i,
+		///	the response curve evaluated over the input range and scaled to [0,rate_max].
+		///	Used for outputs with a rate proportional to the input, such as scrolling or trigger repeat rates.</summary>
+		/// <param name="curve">validated response curve, an invalid curve is logged and treated as linear</param>
+		/// <returns>vector of float, in_max - in_min + 1 elements</returns>
+		[[nodiscard]] std::vector<float> BuildRateTable(const ResponseCurve& curve,
+			const int in_min,
+			const int in_max,
+			const float rate_max) const
+		{
+			using namespace sds::Utilities;
+			std::vector<float> table;
+			if (in_min >= in_max)
+			{
+				LogError(m_except_build_map + "input range out of range.");
+				return table;
+			}
+			const std::string curveError = curve.Validate();
+			if (!curveError.empty())
+				LogError(m_except_build_map + curveError);
+			const ResponseCurve& used = curveError.empty() ? curve : ResponseCurve{};
+			table.reserve(static_cast<size_t>(in_max - in_min + 1));
+			for (int i = in_min; i <= in_max; i++)
+			{
+				const float t = (ToA<float>(i) - ToA<float>(in_min)) / (ToA<float>(in_max) - ToA<float>(in_min));
+				table.push_back(used.Evaluate(t) * rate_max);
+			}
+			return table;
+		}
+
 		/// <summary>Returns the user sensitivity adjusted minimum microsecond delay based
 		/// on the arguments. This is used to alter the minimum microsecond delay of the sensitivity map,
 		/// when a sensitivity value is used.</summary>
@@ -0,0 +1,84 @@
+#pragma once
+#include "stdafx.h"
+#include "SensitivityMapper.h"
+
+namespace sds
+{
+	/// <summary>
+	/// Process wide cache of the immutable sensitivity tables used by ThumbstickToDelay, keyed by sensitivity and response curve.
+	///	The X and Y axes, and every stick and mapper, using the same settings share one read-only table,
+	///	so constructing a stick processor is a lookup and memory doesn't grow with the number of processors.
+	///	Entries are held weakly, a table is freed with the last processor using it.
+	///	The deadzones only affect the stick value ranging, not the table, so they are not part of the key.
+	/// </summary>
+	class SensitivityTableCache
+	{
+	public:
+		using SensTableType = SensitivityMapper::SensTableType;
+		using TablePtr = std::shared_ptr<const SensTableType>;
+	private:
+		struct Entry
+		{
+			int Sensitivity{ 0 };
+			ResponseCurve Curve{};
+			std::weak_ptr<const SensTableType> Table{};
+		};
+		std::mutex m_mutex{};
+		std::vector<Entry> m_entries{};
+		size_t m_build_count{ 0 };
+	public:
+		SensitivityTableCache() = default;
+		SensitivityTableCache(const SensitivityTableCache& other) = delete;
+		SensitivityTableCache(SensitivityTableCache&& other) = delete;
+		SensitivityTableCache& operator=(const SensitivityTableCache& other) = delete;
+		SensitivityTableCache& operator=(SensitivityTableCache&& other) = delete;
+		~SensitivityTableCache() = default;
+
+		/// <summary>Returns the table for the settings, building it on a miss.</summary>
+		/// <param name="sensitivity">axis sensitivity value, already range bound</param>
+		/// <param name="curve">response curve baked into the table</param>
+		[[nodiscard]] TablePtr Get(const int sensitivity, const ResponseCurve& curve)
+		{
+			std::lock_guard tableLock(m_mutex);
+			for (const auto& entry : m_entries)
+			{
+				if (entry.Sensitivity == sensitivity && entry.Curve == curve)
+				{
+					if (TablePtr table = entry.Table.lock())
+						return table;
+				}
+			}
+			//miss, drop the expired entries and build the table once for every user of these settings
+			std::erase_if(m_entries, [](const Entry& e) { return e.Table.expired(); });
+			auto table = std::make_shared<const SensTableType>(SensitivityMapper{}.BuildSensitivityTable(sensitivity,
+				curve,
+				MouseSettings::SENSITIVITY_MIN,
+				MouseSettings::SENSITIVITY_MAX,
+				MouseSettings::MICROSECONDS_MIN,
+				MouseSettings::MICROSECONDS_MAX,
+				MouseSettings::MICROSECONDS_MIN_MAX));
+			m_entries.push_back(Entry{ sensitivity, curve, table });
+			m_build_count++;
+			return table;
+		}
+		/// <summary>Telemetry, the number of tables built so far.</summary>
+		[[nodiscard]] size_t GetBuildCount()
+		{
+			std::lock_guard tableLock(m_mutex);
+			return m_build_count;
+		}
+		/// <summary>Telemetry, the number of tables currently in use.</summary>
+		[[nodiscard]] size_t GetLiveCount()
+		{
+			std::lock_guard tableLock(m_mutex);
+			return static_cast<size_t>(std::ranges::count_if(m_entries, [](const Entry& e) { return !e.Table.expired(); }));
+		}
+	};
+
+	/// <summary>The process wide SensitivityTableCache.</summary>
+	[[nodiscard]] inline SensitivityTableCache& GetSensitivityTableCache()
+	{
+		static SensitivityTableCache cache;
+		return cache;
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "stdafx.h"
+#include "ResponseCurve.h"
+#include <syncstream>
+
+namespace sds
+{
+	/// <summary>
+	/// Utility class for holding a thumbstick axis to pulse width modulated key map.
+	///	While the axis is deflected past the deadzone, the key for the direction is held for a part of each period,
+	///	the duty cycle, from one step at the deadzone edge to the whole period at full deflection, shaped by the response curve.
+	///	Slight deflection then means slow movement, instead of the full speed of an on/off direction key.
+	/// </summary>
+	struct StickPwmMap
+	{
+		enum class AxisType : int
+		{
+			LEFT_X = 0,
+			LEFT_Y = 1,
+			RIGHT_X = 2,
+			RIGHT_Y = 3
+		};
+		//Struct members
+		AxisType Axis{ AxisType::LEFT_Y };
+		int PositiveVK{ 0 }; // VK held for right or up deflection, 0 for none
+		int NegativeVK{ 0 }; // VK held for left or down deflection, 0 for none
+		int Deadzone{ KeyboardSettings::LEFT_STICK_DEADZONE }; // axis magnitude [0,32766] at which the output starts
+		int PeriodMicroseconds{ KeyboardSettings::PWM_PERIOD_MICROSECONDS };
+		int DutySteps{ KeyboardSettings::PWM_DUTY_STEPS }; // duty cycle resolution, steps per period
+		ResponseCurve Curve{};
+		/// <returns>a std::string containing an error message if the map is unusable, empty string otherwise.</returns>
+		[[nodiscard]] std::string Validate() const
+		{
+			if (PositiveVK < 0 || PositiveVK > 255 || NegativeVK < 0 || NegativeVK > 255 || (PositiveVK == 0 && NegativeVK == 0))
+				return "StickPwmMap::Validate(): PositiveVK and NegativeVK must be in [0,255], and one must be set.";
+			if (Deadzone < 0 || Deadzone > 32766)
+				return "StickPwmMap::Validate(): Deadzone outside [0,32766].";
+			if (PeriodMicroseconds < KeyboardSettings::PWM_PERIOD_MIN_MICROSECONDS || PeriodMicroseconds > KeyboardSettings::PWM_PERIOD_MAX_MICROSECONDS)
+				return "StickPwmMap::Validate(): PeriodMicroseconds outside [PWM_PERIOD_MIN_MICROSECONDS,PWM_PERIOD_MAX_MICROSECONDS].";
+			if (DutySteps < 2 || DutySteps > KeyboardSettings::PWM_DUTY_STEPS_MAX)
+				return "StickPwmMap::Validate(): DutySteps outside [2,PWM_DUTY_STEPS_MAX].";
+			return Curve.Validate();
+		}
+		/// <summary>
+		/// Operator<< overload for std::ostream specialization,
+		///	writes more detailed map details for debugging.
+		///	Thread-safe, provided all writes to the ostream object
+		///	are wrapped with std::osyncstream!
+		/// </summary>
+		friend std::ostream& operator<<(std::ostream& os, const StickPwmMap& obj)
+		{
+			std::osyncstream ss(os);
+			ss << "[StickPwmMap]" << " ";
+			ss << "Axis:" << static_cast<int>(obj.Axis) << " ";
+			ss << "PositiveVK:" << obj.PositiveVK << " ";
+			ss << "NegativeVK:" << obj.NegativeVK << " ";
+			ss << "Deadzone:" << obj.Deadzone << " ";
+			ss << "PeriodMicroseconds:" << obj.PeriodMicroseconds << " ";
+			ss << "DutySteps:" << obj.DutySteps << " ";
+			ss << "[/StickPwmMap]" << " ";
+			return os;
+		}
+		friend bool operator==(const StickPwmMap& lhs, const StickPwmMap& rhs) = default;
+	};
+}
@@ -0,0 +1,221 @@
+#pragma once
+#include "stdafx.h"
+#include "Utilities.h"
+#include "TimerQueue.h"
+#include "StickPwmMap.h"
+
+namespace sds
+{
+	/// <summary>
+	/// Maps thumbstick axes to pulse width modulated keys, see StickPwmMap.
+	///	Pass every polled XINPUT_STATE to FeedState(), see MouseMapper::SetStateListener().
+	///	Each deflected axis runs on a Utilities::TimerQueue, share one with KeyboardMapper::GetTimerQueue():
+	///	a period start presses the key and schedules the key-up at the duty point and the next period start,
+	///	so an axis costs at most two timer callbacks per period whatever the duty resolution, and an axis inside
+	///	the deadzone has nothing scheduled. Periods are deadline based, they don't drift with callback latency.
+	///	A change of deflection takes effect at the next period start.
+	///	The duty step for every deflection is computed once when the map is added.
+	///	Uses its own SendKeyInput, or the key sink, only ever called on the timer thread.
+	/// </summary>
+	class StickPwmMapper
+	{
+		using TimerType = Utilities::TimerQueue;
+		using GroupType = TimerType::GroupType;
+		using AxisType = StickPwmMap::AxisType;
+	public:
+		/// <summary>Receives each key event in place of SendInput, virtual key and true for key-down.</summary>
+		using KeySinkType = std::function<void(int, bool)>;
+		/// <summary>Number of axis magnitude buckets in the duty table.</summary>
+		static constexpr size_t DUTY_TABLE_SIZE{ 1024 };
+		using DutyTableType = std::array<std::uint16_t, DUTY_TABLE_SIZE>;
+	private:
+		const std::string ERR_DUP_AXIS{ "StickPwmMapper::AddMap(): A map already uses the axis." };
+		static constexpr int AXIS_MAGNITUDE_MAX{ std::numeric_limits<SHORT>::max() };
+		struct AxisRuntime
+		{
+			StickPwmMap Map{};
+			DutyTableType Duty{}; // duty steps for each magnitude bucket, zero inside the deadzone
+			std::chrono::microseconds Period{};
+			std::atomic<int> Value{ 0 };
+			std::atomic<bool> IsScheduled{ false };
+			int HeldVK{ 0 }; // timer thread only
+			TimerType::PointInTime PeriodStart{}; // timer thread only
+		};
+		std::shared_ptr<TimerType> m_timer{};
+		//unique_ptr, timer callbacks hold references to the runtime state
+		std::vector<std::unique_ptr<AxisRuntime>> m_maps{};
+		std::mutex m_maps_mutex{};
+		Utilities::SendKeyInput m_key_send{}; // timer thread only
+		const KeySinkType m_key_sink{};
+	public:
+		/// <param name="timer">timer queue to share with other timed outputs, or nullptr for a new one</param>
+		/// <param name="keySink">function receiving the key events in place of SendInput, or empty to send input</param>
+		explicit StickPwmMapper(std::shared_ptr<TimerType> timer = nullptr, KeySinkType keySink = {})
+			: m_timer(timer ? std::move(timer) : std::make_shared<TimerType>()), m_key_sink(std::move(keySink))
+		{
+		}
+		StickPwmMapper(const StickPwmMapper& other) = delete;
+		StickPwmMapper(StickPwmMapper&& other) = delete;
+		StickPwmMapper& operator=(const StickPwmMapper& other) = delete;
+		StickPwmMapper& operator=(StickPwmMapper&& other) = delete;
+		~StickPwmMapper()
+		{
+			ClearMaps();
+		}
+		/// <summary>Updates the axis values, starting the output of any axis deflected past its deadzone.</summary>
+		void FeedState(const XINPUT_STATE& state)
+		{
+			std::lock_guard mapsLock(m_maps_mutex);
+			for (const auto& axis : m_maps)
+			{
+				const int value = GetAxisValue(state.Gamepad, axis->Map.Axis);
+				axis->Value.store(value, std::memory_order_relaxed);
+				//a deflection toward a direction without a VK has nothing to send
+				if (GetDutyStep(axis->Duty, value) != 0 && GetDirectionVK(axis->Map, value) != 0 && !axis->IsScheduled.exchange(true))
+				{
+					AxisRuntime& runtime = *axis;
+					m_timer->Schedule(TimerType::ClockType::now(), GetGroup(runtime), [this, &runtime]()
+					{
+						runtime.PeriodStart = TimerType::ClockType::now();
+						StartPeriod(runtime);
+					});
+				}
+			}
+		}
+		/// <returns>a std::string containing an error message if there is an error, empty string otherwise.</returns>
+		std::string AddMap(const StickPwmMap& map)
+		{
+			std::string er = map.Validate();
+			if (!er.empty())
+				return er;
+			std::lock_guard mapsLock(m_maps_mutex);
+			if (std::ranges::any_of(m_maps, [&map](const auto& a) { return a->Map.Axis == map.Axis; }))
+				return ERR_DUP_AXIS;
+			auto runtime = std::make_unique<AxisRuntime>();
+			runtime->Map = map;
+			runtime->Duty = BuildDutyTable(map);
+			runtime->Period = std::chrono::microseconds(map.PeriodMicroseconds);
+			m_maps.push_back(std::move(runtime));
+			return "";
+		}
+		/// <summary>Stops the outputs and removes the maps, waits for the timer thread to release any key held down.</summary>
+		void ClearMaps()
+		{
+			std::lock_guard mapsLock(m_maps_mutex);
+			if (m_maps.empty())
+				return;
+			//cancelled on the timer thread, so no running period callback schedules another after the cancel
+			m_timer->RunAndWait(0, [this]()
+			{
+				for (const auto& axis : m_maps)
+				{
+					m_timer->Cancel(GetGroup(*axis));
+					ReleaseKey(*axis);
+				}
+			});
+			m_maps.clear();
+		}
+		[[nodiscard]] std::vector<StickPwmMap> GetMaps()
+		{
+			std::lock_guard mapsLock(m_maps_mutex);
+			std::vector<StickPwmMap> maps;
+			for (const auto& axis : m_maps)
+				maps.push_back(axis->Map);
+			return maps;
+		}
+		[[nodiscard]] std::shared_ptr<TimerType> GetTimerQueue() const
+		{
+			return m_timer;
+		}
+		/// <summary>Computes the duty step for every magnitude bucket, zero inside the deadzone,
+		///	at least one step past it, and every step at full deflection.</summary>
+		[[nodiscard]] static DutyTableType BuildDutyTable(const StickPwmMap& map)
+		{
+			DutyTableType duty{};
+			constexpr int bucketMax = static_cast<int>(DUTY_TABLE_SIZE) - 1;
+			const float range = static_cast<float>(AXIS_MAGNITUDE_MAX - map.Deadzone);
+			for (int i = 0; i <= bucketMax; i++)
+			{
+				const int magnitude = (i * AXIS_MAGNITUDE_MAX + bucketMax / 2) / bucketMax;
+				if (magnitude <= map.Deadzone)
+					continue;
+				const float t = static_cast<float>(magnitude - map.Deadzone) / range;
+				const long step = std::lroundf(map.Curve.Evaluate(t) * static_cast<float>(map.DutySteps));
+				duty[static_cast<size_t>(i)] = static_cast<std::uint16_t>(std::clamp(step, 1L, static_cast<long>(map.DutySteps)));
+			}
+			return duty;
+		}
+		/// <returns>the duty step for an axis value, zero inside the deadzone.</returns>
+		[[nodiscard]] static int GetDutyStep(const DutyTableType& duty, const int value) noexcept
+		{
+			constexpr int bucketMax = static_cast<int>(DUTY_TABLE_SIZE) - 1;
+			const int magnitude = std::min(std::abs(value), AXIS_MAGNITUDE_MAX);
+			return duty[static_cast<size_t>((magnitude * bucketMax + AXIS_MAGNITUDE_MAX / 2) / AXIS_MAGNITUDE_MAX)];
+		}
+	private:
+		[[nodiscard]] static GroupType GetGroup(const AxisRuntime& axis) noexcept
+		{
+			return static_cast<GroupType>(reinterpret_cast<std::uintptr_t>(&axis));
+		}
+		[[nodiscard]] static int GetDirectionVK(const StickPwmMap& map, const int value) noexcept
+		{
+			return value > 0 ? map.PositiveVK : map.NegativeVK;
+		}
+		[[nodiscard]] static int GetAxisValue(const XINPUT_GAMEPAD& pad, const AxisType axis) noexcept
+		{
+			switch (axis)
+			{
+			case AxisType::LEFT_X: return pad.sThumbLX;
+			case AxisType::LEFT_Y: return pad.sThumbLY;
+			case AxisType::RIGHT_X: return pad.sThumbRX;
+			case AxisType::RIGHT_Y: return pad.sThumbRY;
+			default: return 0;
+			}
+		}
+		/// <summary>Timer callback at axis.PeriodStart, holds the key for the duty of the current deflection,
+		///	and schedules the key-up and the next period, or stops when the axis is back inside the deadzone.</summary>
+		void StartPeriod(AxisRuntime& axis)
+		{
+			const int value = axis.Value.load(std::memory_order_relaxed);
+			const int step = GetDutyStep(axis.Duty, value);
+			const int vk = GetDirectionVK(axis.Map, value);
+			if (step == 0 || vk == 0)
+			{
+				ReleaseKey(axis);
+				axis.IsScheduled = false;
+				return;
+			}
+			if (axis.HeldVK != vk)
+			{
+				ReleaseKey(axis);
+				SendKey(vk, true);
+				axis.HeldVK = vk;
+			}
+			const GroupType group = GetGroup(axis);
+			//full duty holds the key through the period, no key-up
+			if (step < axis.Map.DutySteps)
+				m_timer->Schedule(axis.PeriodStart + axis.Period * step / axis.Map.DutySteps, group, [this, &axis]() { ReleaseKey(axis); });
+			//the next period starts a period after this one, unless that has already passed
+			const auto now = TimerType::ClockType::now();
+			axis.PeriodStart += axis.Period;
+			if (axis.PeriodStart < now)
+				axis.PeriodStart = now;
+			m_timer->Schedule(axis.PeriodStart, group, [this, &axis]() { StartPeriod(axis); });
+		}
+		void ReleaseKey(AxisRuntime& axis)
+		{
+			if (axis.HeldVK != 0)
+			{
+				SendKey(axis.HeldVK, false);
+				axis.HeldVK = 0;
+			}
+		}
+		void SendKey(const int vk, const bool isDown)
+		{
+			if (m_key_sink)
+				m_key_sink(vk, isDown);
+			else
+				m_key_send.SendScanCode(vk, isDown);
+		}
+	};
+}
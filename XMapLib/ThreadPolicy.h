@@ -0,0 +1,101 @@
+#pragma once
+#include "stdafx.h"
+#include "XELog.h"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace sds::Utilities
+{
+	/// <summary>
+	/// Scheduling settings for a worker thread, applied by the thread itself when it starts, see CPPRunnerGeneric::SetThreadPolicy().
+	///	On Windows the priority maps to SetThreadPriority() levels, and any real-time type selects THREAD_PRIORITY_TIME_CRITICAL.
+	///	On Linux the real-time type requests SCHED_FIFO or SCHED_RR, which needs CAP_SYS_NICE or an RLIMIT_RTPRIO allowance,
+	///	falling back to the default scheduler when not permitted.
+	///	A failure to apply any part is not fatal, the thread runs with what could be applied.
+	/// </summary>
+	struct ThreadPolicy
+	{
+		enum class PriorityLevel : int
+		{
+			NORMAL = 0,
+			ABOVE_NORMAL = 1,
+			HIGHEST = 2
+		};
+		enum class RealtimeType : int
+		{
+			NONE = 0,
+			FIFO = 1,
+			ROUND_ROBIN = 2
+		};
+		//Struct members
+		PriorityLevel Priority{ PriorityLevel::NORMAL };
+		std::uint64_t AffinityMask{ 0 }; // bit N allows CPU N, 0 leaves the affinity unchanged
+		RealtimeType Realtime{ RealtimeType::NONE };
+
+		/// <summary>Default scheduling, the policy of a thread unless one is set.</summary>
+		[[nodiscard]] static constexpr ThreadPolicy Default() noexcept { return ThreadPolicy{}; }
+		/// <summary>For input polling threads, above normal priority.</summary>
+		[[nodiscard]] static constexpr ThreadPolicy ForPolling() noexcept { return ThreadPolicy{ PriorityLevel::ABOVE_NORMAL, 0, RealtimeType::NONE }; }
+		/// <summary>For output threads with tight deadlines that wait between them, like the timer queue, highest priority.</summary>
+		[[nodiscard]] static constexpr ThreadPolicy ForOutput() noexcept { return ThreadPolicy{ PriorityLevel::HIGHEST, 0, RealtimeType::NONE }; }
+		/// <summary>For output threads with tight deadlines, real-time scheduling where permitted.
+		///	Opt-in, a real-time thread that never blocks can starve the rest of the system on its CPU.</summary>
+		[[nodiscard]] static constexpr ThreadPolicy ForRealtimeOutput() noexcept { return ThreadPolicy{ PriorityLevel::HIGHEST, 0, RealtimeType::FIFO }; }
+
+		[[nodiscard]] constexpr bool IsDefault() const noexcept
+		{
+			return Priority == PriorityLevel::NORMAL && AffinityMask == 0 && Realtime == RealtimeType::NONE;
+		}
+		/// <summary>Applies the policy to the calling thread.</summary>
+		/// <returns>a std::string describing the parts that could not be applied, empty string otherwise.</returns>
+		[[nodiscard]] std::string ApplyToCurrentThread() const
+		{
+			if (IsDefault())
+				return "";
+			std::string result;
+#ifdef _WIN32
+			int level = THREAD_PRIORITY_NORMAL;
+			if (Realtime != RealtimeType::NONE)
+				level = THREAD_PRIORITY_TIME_CRITICAL;
+			else if (Priority == PriorityLevel::HIGHEST)
+				level = THREAD_PRIORITY_HIGHEST;
+			else if (Priority == PriorityLevel::ABOVE_NORMAL)
+				level = THREAD_PRIORITY_ABOVE_NORMAL;
+			if (!SetThreadPriority(GetCurrentThread(), level))
+				result += "ThreadPolicy: SetThreadPriority() failed. ";
+			if (AffinityMask != 0 && SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(AffinityMask)) == 0)
+				result += "ThreadPolicy: SetThreadAffinityMask() failed. ";
+#elif defined(__linux__)
+			if (Realtime != RealtimeType::NONE)
+			{
+				const int schedPolicy = Realtime == RealtimeType::FIFO ? SCHED_FIFO : SCHED_RR;
+				sched_param param{};
+				//mid-range priority, leaving room above for the system's own real-time threads
+				param.sched_priority = (sched_get_priority_min(schedPolicy) + sched_get_priority_max(schedPolicy)) / 2;
+				const int er = pthread_setschedparam(pthread_self(), schedPolicy, &param);
+				if (er != 0)
+					result += std::string("ThreadPolicy: real-time scheduling not permitted, using the default scheduler: ") + std::strerror(er) + ". ";
+			}
+			//Under SCHED_OTHER, thread priority is the nice value, which can't be lowered without the same permission, so no attempt is made.
+			if (AffinityMask != 0)
+			{
+				cpu_set_t cpus;
+				CPU_ZERO(&cpus);
+				for (int i = 0; i < 64 && i < CPU_SETSIZE; i++)
+				{
+					if ((AffinityMask >> i) & 1u)
+						CPU_SET(i, &cpus);
+				}
+				if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+					result += "ThreadPolicy: pthread_setaffinity_np() failed. ";
+			}
+#endif
+			return result;
+		}
+		friend bool operator==(const ThreadPolicy& lhs, const ThreadPolicy& rhs) = default;
+	};
+}
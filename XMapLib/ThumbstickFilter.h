@@ -0,0 +1,64 @@
+#pragma once
+#include "stdafx.h"
+#include "OneEuroFilter.h"
+#include <cmath>
+
+namespace sds
+{
+	/// <summary>
+	/// Optional noise filter stage for one thumbstick, between the polled state and the ThumbstickProcessor.
+	///	Runs a OneEuroFilter per axis on the axis values normalized to [-1,1], so the parameters don't depend on the
+	///	SHORT range: a worn stick's jitter around the deadzone edge is smoothed away while the stick is nearly still,
+	///	and fast motion raises the cutoff so it passes through with little added lag.
+	/// </summary>
+	class ThumbstickFilter
+	{
+	public:
+		using ParamType = Utilities::OneEuroFilter::Parameters;
+		/// <summary>A filtered pair of thumbstick axis values.</summary>
+		struct Output
+		{
+			SHORT X{ 0 };
+			SHORT Y{ 0 };
+		};
+	private:
+		Utilities::OneEuroFilter m_x_filter;
+		Utilities::OneEuroFilter m_y_filter;
+	public:
+		explicit ThumbstickFilter(const ParamType& params = DefaultParameters()) noexcept
+			: m_x_filter(params), m_y_filter(params)
+		{
+		}
+		/// <summary>The parameters from MouseSettings.</summary>
+		[[nodiscard]] static ParamType DefaultParameters() noexcept
+		{
+			return ParamType{ MouseSettings::STICK_FILTER_MIN_CUTOFF_DEFAULT, MouseSettings::STICK_FILTER_BETA_DEFAULT, MouseSettings::STICK_FILTER_DCUTOFF_DEFAULT };
+		}
+		/// <summary>Filters the next pair of axis values.</summary>
+		/// <param name="dtSeconds">time since the previous pair, in seconds</param>
+		[[nodiscard]] Output Process(const SHORT x, const SHORT y, const float dtSeconds) noexcept
+		{
+			return Output{ ToAxisValue(m_x_filter.Filter(ToNormalized(x), dtSeconds)), ToAxisValue(m_y_filter.Filter(ToNormalized(y), dtSeconds)) };
+		}
+		/// <summary>Forgets the stick history, the next pair is passed through unchanged.</summary>
+		void Reset() noexcept
+		{
+			m_x_filter.Reset();
+			m_y_filter.Reset();
+		}
+		[[nodiscard]] const ParamType& GetParameters() const noexcept
+		{
+			return m_x_filter.GetParameters();
+		}
+	private:
+		[[nodiscard]] static float ToNormalized(const SHORT value) noexcept
+		{
+			return static_cast<float>(value) / static_cast<float>(MouseSettings::SMax);
+		}
+		[[nodiscard]] static SHORT ToAxisValue(const float normalized) noexcept
+		{
+			const float scaled = std::round(normalized * static_cast<float>(MouseSettings::SMax));
+			return static_cast<SHORT>(std::clamp(scaled, static_cast<float>(MouseSettings::SMin), static_cast<float>(MouseSettings::SMax)));
+		}
+	};
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "stdafx.h"
+#include "ThumbstickToDelay.h"
+
+namespace sds
+{
+	/// <summary>
+	/// Processes one thumbstick into the mouse move delays for each axis.
+	///	Owns the X and Y axis ThumbstickToDelay instances and the deadzone state they share,
+	///	so any number of processors (sticks, players) may be used at once, or stepped from one worker loop, without interfering.
+	///	Must be re-instantiated to use new settings.
+	/// </summary>
+	class ThumbstickProcessor
+	{
+	public:
+		/// <summary>Mouse move parameters for one tick, as used by MouseMoveThread::UpdateState().</summary>
+		struct Output
+		{
+			size_t XDelay{ 0 };
+			size_t YDelay{ 0 };
+			bool IsXPositive{ false };
+			bool IsYPositive{ false };
+			bool IsXMoving{ false };
+			bool IsYMoving{ false };
+		};
+	private:
+		std::atomic<bool> m_is_deadzone_activated{ false }; // shared by the two axes
+		ThumbstickToDelay m_x_axis;
+		ThumbstickToDelay m_y_axis;
+		const StickMap m_stick;
+	public:
+		/// <param name="xSensitivity">X axis sensitivity value</param>
+		/// <param name="ySensitivity">Y axis sensitivity value</param>
+		/// <param name="player">MousePlayerInfo struct full of deadzone information</param>
+		/// <param name="whichStick">StickMap enum denoting which thumbstick, NEITHER_STICK is treated as RIGHT_STICK</param>
+		/// <param name="curve">response curve baked into the delay tables</param>
+		ThumbstickProcessor(const int xSensitivity, const int ySensitivity, const MousePlayerInfo& player, const StickMap whichStick, const ResponseCurve& curve = {}) noexcept
+			: m_x_axis(xSensitivity, player, whichStick, true, curve, &m_is_deadzone_activated),
+			m_y_axis(ySensitivity, player, whichStick, false, curve, &m_is_deadzone_activated),
+			m_stick(whichStick == StickMap::LEFT_STICK ? StickMap::LEFT_STICK : StickMap::RIGHT_STICK)
+		{
+		}
+		ThumbstickProcessor() = delete;
+		ThumbstickProcessor(const ThumbstickProcessor& other) = delete;
+		ThumbstickProcessor(ThumbstickProcessor&& other) = delete;
+		ThumbstickProcessor& operator=(const ThumbstickProcessor& other) = delete;
+		ThumbstickProcessor& operator=(ThumbstickProcessor&& other) = delete;
+		~ThumbstickProcessor() = default;
+
+		/// <summary>Processes the values of this processor's thumbstick from the controller state.</summary>
+		[[nodiscard]] Output Process(const XINPUT_STATE& state) const noexcept
+		{
+			if (m_stick == StickMap::LEFT_STICK)
+				return Process(state.Gamepad.sThumbLX, state.Gamepad.sThumbLY);
+			return Process(state.Gamepad.sThumbRX, state.Gamepad.sThumbRY);
+		}
+		/// <summary>Processes a pair of thumbstick axis values.</summary>
+		[[nodiscard]] Output Process(const SHORT x, const SHORT y) const noexcept
+		{
+			Output out;
+			out.XDelay = m_x_axis.GetDelayFromThumbstickValue(x, y);
+			out.YDelay = m_y_axis.GetDelayFromThumbstickValue(x, y);
+			out.IsXPositive = x > 0;
+			out.IsYPositive = y > 0;
+			out.IsXMoving = m_x_axis.DoesAxisRequireMoveAlt(x, y);
+			out.IsYMoving = m_y_axis.DoesAxisRequireMoveAlt(x, y);
+			return out;
+		}
+		[[nodiscard]] StickMap GetStick() const noexcept
+		{
+			return m_stick;
+		}
+		[[nodiscard]] bool IsDeadzoneActivated() const noexcept
+		{
+			return m_is_deadzone_activated;
+		}
+	};
+}
@@ -1,26 +1,28 @@
 #pragma once
 #include "stdafx.h"
 #include "SensitivityMapper.h"
+#include "SensitivityTableCache.h"
 #include "Utilities.h"
 
 namespace sds
 {
 	/// <summary>Basic logic for mapping thumbstick values to work thread delay values.
 	/// A single instance for a single thumbstick axis is to be used.
+	/// The deadzone activated state is shared by the X and Y axis instances of a stick, see ThumbstickProcessor.
 	/// This class must be re-instantiated to use new deadzone values.</summary>
 	class ThumbstickToDelay
 	{
 	public:
 		using SensMapType = std::map<int, int>;
+		using SensTableType = SensitivityMapper::SensTableType;
 	private:
-		const std::string BAD_DELAY_MSG{ "Bad timer delay value, exception." };
-		inline static std::atomic<bool> m_is_deadzone_activated{ false }; //shared between instances
+		std::atomic<bool> m_own_deadzone_activated{ false }; //used when no shared state is given
+		std::atomic<bool>& m_is_deadzone_activated; //shared with the other axis of the same stick
 		float m_alt_deadzone_multiplier{ MouseSettings::ALT_DEADZONE_MULT_DEFAULT };
 		int m_axis_sensitivity{ MouseSettings::SENSITIVITY_DEFAULT };
 		int m_x_axis_deadzone{ MouseSettings::DEADZONE_DEFAULT };
 		int m_y_axis_deadzone{ MouseSettings::DEADZONE_DEFAULT };
-		SensitivityMapper m_sensitivity_mapper{};
-		SensMapType m_shared_sensitivity_map{};
+		SensitivityTableCache::TablePtr m_sensitivity_table{}; // [keyValue - SENSITIVITY_MIN], curve already applied, shared read-only
 		const bool m_is_x_axis;
 		//Used to make some assertions about the settings values this class depends upon.
 		static void AssertSettings()
@@ -49,7 +51,7 @@ namespace sds
 			m_x_axis_deadzone = xAxisDz;
 			m_y_axis_deadzone = yAxisDz;
 		}
-		[[nodiscard]] constexpr int RangeBindValue(const int user_sens, const int sens_min, const int sens_max) const noexcept
+		[[nodiscard]] static constexpr int RangeBindValue(const int user_sens, const int sens_min, const int sens_max) noexcept
 		{
 			//bounds check result
 			if (user_sens > sens_max)
@@ -102,7 +104,16 @@ namespace sds
 		/// <param name="player">MousePlayerInfo struct full of deadzone information</param>
 		/// <param name="whichStick">StickMap enum denoting which thumbstick</param>
 		/// <param name="isX">is it for the X axis?</param>
-		ThumbstickToDelay(const int sensitivity, const MousePlayerInfo &player, StickMap whichStick, const bool isX) noexcept : m_is_x_axis(isX)
+		/// <param name="curve">response curve baked into the delay table</param>
+		/// <param name="sharedDeadzoneState">deadzone activated state shared with the other axis of the stick, or nullptr for a private one</param>
+		ThumbstickToDelay(const int sensitivity,
+			const MousePlayerInfo &player,
+			StickMap whichStick,
+			const bool isX,
+			const ResponseCurve& curve = {},
+			std::atomic<bool>* sharedDeadzoneState = nullptr) noexcept
+		: m_is_deadzone_activated(sharedDeadzoneState != nullptr ? *sharedDeadzoneState : m_own_deadzone_activated),
+		m_is_x_axis(isX)
 		{
 			AssertSettings();
 			//error checking mousemap stick setting
@@ -113,12 +124,7 @@ namespace sds
 			const int cdx = whichStick == StickMap::LEFT_STICK ? player.left_x_dz : player.right_x_dz;
 			const int cdy = whichStick == StickMap::LEFT_STICK ? player.left_y_dz : player.right_y_dz;
 			InitFirstPiece(sensitivity, cdx, cdy);
-			m_shared_sensitivity_map = m_sensitivity_mapper.BuildSensitivityMap(m_axis_sensitivity,
-				MouseSettings::SENSITIVITY_MIN,
-				MouseSettings::SENSITIVITY_MAX,
-				MouseSettings::MICROSECONDS_MIN,
-				MouseSettings::MICROSECONDS_MAX,
-				MouseSettings::MICROSECONDS_MIN_MAX);
+			m_sensitivity_table = GetSensitivityTableCache().Get(m_axis_sensitivity, curve);
 		}
 		ThumbstickToDelay() = delete;
 		ThumbstickToDelay(const ThumbstickToDelay& other) = delete;
@@ -126,11 +132,19 @@ namespace sds
 		ThumbstickToDelay& operator=(const ThumbstickToDelay& other) = delete;
 		ThumbstickToDelay& operator=(ThumbstickToDelay&& other) = delete;
 		~ThumbstickToDelay() = default;
+		/// <summary>returns the shared sensitivity table, see SensitivityTableCache</summary>
+		[[nodiscard]] SensitivityTableCache::TablePtr GetSensitivityTable() const noexcept
+		{
+			return m_sensitivity_table;
+		}
 		/// <summary>returns a copy of the internal sensitivity map</summary>
 		/// <returns>std map of int, int</returns>
 		[[nodiscard]] std::map<int, int> GetCopyOfSensitivityMap() const
 		{
-			return m_shared_sensitivity_map;
+			SensMapType sensMap;
+			for (size_t i = 0; i < m_sensitivity_table->size(); i++)
+				sensMap[MouseSettings::SENSITIVITY_MIN + static_cast<int>(i)] = (*m_sensitivity_table)[i];
+			return sensMap;
 		}
 		/// <summary>Determines if m_is_x_axis axis requires move based on alt deadzone if dz is activated.</summary>
 		[[nodiscard]] bool DoesAxisRequireMoveAlt(const int x, const int y) const noexcept
@@ -178,21 +192,23 @@ namespace sds
 		[[nodiscard]] int GetMappedValue(int keyValue) const noexcept
 		{
 			keyValue = RangeBindValue(keyValue, MouseSettings::SENSITIVITY_MIN, MouseSettings::SENSITIVITY_MAX);
-			//error checking to make sure the value is in the map
-			if(!m_shared_sensitivity_map.contains(keyValue))
+			//error checking to make sure the value is in the table
+			const auto index = static_cast<size_t>(keyValue - MouseSettings::SENSITIVITY_MIN);
+			const SensTableType& table = *m_sensitivity_table;
+			if(index >= table.size())
 			{
 				//this should not happen, but in case it does I want a plain string telling me it did.
-				Utilities::LogError("Exception in ThumbstickToDelay::GetDelayFromThumbstickValue(int,int,bool): " + BAD_DELAY_MSG);
+				Utilities::LogAsync(Utilities::LogMessageId::BAD_SENSITIVITY_INDEX, static_cast<std::int64_t>(index), static_cast<std::int64_t>(table.size()));
 				return 1;
 			}
-			const auto rval = m_shared_sensitivity_map.at(keyValue);
+			const auto rval = table[index];
 			if(rval >= MouseSettings::MICROSECONDS_MIN && rval <= MouseSettings::MICROSECONDS_MAX)
 			{
 				return rval;
 			}
 			else
 			{
-				Utilities::LogError("ThumbstickToDelay::GetDelayFromThumbstickValue(): Failed to acquire mapped value with key: " + (std::to_string(keyValue)));
+				Utilities::LogAsync(Utilities::LogMessageId::BAD_MAPPED_VALUE, keyValue);
 				return MouseSettings::MICROSECONDS_MAX;
 			}
 		}
@@ -201,7 +217,7 @@ namespace sds
 		/// <param name="thumbstick">thumbstick value between short minimum and short maximum</param>
 		/// <param name="axisDeadzone">positive deadzone value to use for the axis value</param>
 		/// <returns>positive value between (inclusive) SENSITIVITY_MIN and SENSITIVITY_MAX, or SENSITIVITY_MIN for thumbstick less than deadzone</returns>
-		[[nodiscard]] constexpr int GetRangedThumbstickValue(int thumbstick, int axisDeadzone) const noexcept
+		[[nodiscard]] static constexpr int GetRangedThumbstickValue(int thumbstick, int axisDeadzone) noexcept
 		{
 			using namespace sds::Utilities;
 			thumbstick = RangeBindValue(thumbstick, MouseSettings::SMin, MouseSettings::SMax);
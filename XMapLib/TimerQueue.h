@@ -0,0 +1,183 @@
+#pragma once
+#include "stdafx.h"
+#include "CPPRunnerGeneric.h"
+#include <condition_variable>
+#include <future>
+
+namespace sds::Utilities
+{
+	/// <summary>
+	/// A single worker thread running callbacks at scheduled points in time, so timed output
+	///	(macros, rate modulated actions) never blocks the thread that schedules it.
+	///	Entries are kept in a binary min-heap ordered by deadline, then by scheduling order.
+	///	Each entry has a group id, all pending entries of a group can be cancelled at once.
+	///	Callbacks run one at a time on the timer thread, state touched only by callbacks needs no locking.
+	///	One instance is meant to be shared, via std::shared_ptr, by everything needing timed output.
+	/// </summary>
+	class TimerQueue
+	{
+	public:
+		using ClockType = std::chrono::high_resolution_clock;
+		using PointInTime = std::chrono::time_point<ClockType>;
+		using CallbackType = std::function<void()>;
+		using GroupType = std::uint64_t;
+	private:
+		using InternalType = int;
+		using LambdaRunnerType = sds::CPPRunnerGeneric<InternalType>;
+		using UniqueLockType = std::unique_lock<std::mutex>;
+		struct Entry
+		{
+			PointInTime Deadline{};
+			std::uint64_t Sequence{ 0 };
+			GroupType Group{ 0 };
+			CallbackType Callback{};
+			bool IsWaitedOn{ false }; // from RunAndWait(), run even when stopping
+		};
+		//Heap comparison, the entry with the earliest deadline (then lowest sequence) is at the front.
+		static bool IsLater(const Entry& lhs, const Entry& rhs) noexcept
+		{
+			if (lhs.Deadline != rhs.Deadline)
+				return lhs.Deadline > rhs.Deadline;
+			return lhs.Sequence > rhs.Sequence;
+		}
+		std::vector<Entry> m_heap{};
+		std::uint64_t m_sequence{ 0 };
+		bool m_is_stopping{ false };
+		std::mutex m_queue_mutex{};
+		std::condition_variable m_queue_cv{};
+		std::unique_ptr<LambdaRunnerType> m_workThread{};
+		void InitWorkThread() noexcept
+		{
+			m_workThread =
+				std::make_unique<LambdaRunnerType>
+				([this](const sds::LambdaArgs::LambdaArg1& stopCondition, sds::LambdaArgs::LambdaArg2& mut, auto& protectedData) { workThread(stopCondition, mut, protectedData); });
+			m_workThread->SetThreadPolicy(Utilities::ThreadPolicy::ForOutput());
+		}
+	public:
+		/// <param name="reserveCount">number of pending entries to reserve storage for</param>
+		explicit TimerQueue(const size_t reserveCount = 256)
+		{
+			m_heap.reserve(reserveCount);
+			InitWorkThread();
+			m_workThread->StartThread();
+		}
+		TimerQueue(const TimerQueue& other) = delete;
+		TimerQueue(TimerQueue&& other) = delete;
+		TimerQueue& operator=(const TimerQueue& other) = delete;
+		TimerQueue& operator=(TimerQueue&& other) = delete;
+		~TimerQueue()
+		{
+			{
+				std::lock_guard queueLock(m_queue_mutex);
+				m_is_stopping = true;
+			}
+			m_queue_cv.notify_all();
+			m_workThread->StopThread();
+		}
+		/// <summary>Schedules a callback to run on the timer thread at, or shortly after, the deadline.</summary>
+		void Schedule(const PointInTime deadline, const GroupType group, CallbackType callback)
+		{
+			bool isNewFront;
+			{
+				std::lock_guard queueLock(m_queue_mutex);
+				isNewFront = PushLocked(Entry{ deadline, 0, group, std::move(callback) });
+			}
+			//only an earlier deadline requires waking the worker
+			if (isNewFront)
+				m_queue_cv.notify_one();
+		}
+		/// <summary>Schedules a callback to run on the timer thread after a delay from now.</summary>
+		void ScheduleAfter(const std::chrono::microseconds delay, const GroupType group, CallbackType callback)
+		{
+			Schedule(ClockType::now() + delay, group, std::move(callback));
+		}
+		/// <summary>Removes every pending entry of the group. A callback already running is not interrupted.</summary>
+		/// <returns>number of entries removed</returns>
+		size_t Cancel(const GroupType group)
+		{
+			std::lock_guard queueLock(m_queue_mutex);
+			const auto removed = std::ranges::remove_if(m_heap, [group](const Entry& e) { return e.Group == group; });
+			const auto count = static_cast<size_t>(std::ranges::distance(removed));
+			m_heap.erase(removed.begin(), removed.end());
+			std::ranges::make_heap(m_heap, IsLater);
+			return count;
+		}
+		/// <summary>Runs a callback on the timer thread as soon as possible and waits for it to complete,
+		///	after any entry currently running. Must not be called from the timer thread.
+		///	When the timer thread is stopping or not running, the callback runs on the calling thread instead.</summary>
+		void RunAndWait(const GroupType group, CallbackType callback)
+		{
+			std::promise<void> done;
+			std::future<void> doneFuture = done.get_future();
+			bool isQueued = false;
+			{
+				std::lock_guard queueLock(m_queue_mutex);
+				if (!m_is_stopping && m_workThread->IsRunning())
+				{
+					PushLocked(Entry{ ClockType::now(), 0, group, [&callback, &done]()
+					{
+						callback();
+						done.set_value();
+					}, true });
+					isQueued = true;
+				}
+			}
+			//no timer thread to run it
+			if (!isQueued)
+			{
+				callback();
+				return;
+			}
+			m_queue_cv.notify_one();
+			doneFuture.wait();
+		}
+		[[nodiscard]] size_t GetPendingCount()
+		{
+			std::lock_guard queueLock(m_queue_mutex);
+			return m_heap.size();
+		}
+	private:
+		/// <summary>Adds the entry with the next sequence number, m_queue_mutex must be held.</summary>
+		/// <returns>true if the entry is the new front, with the earliest deadline</returns>
+		bool PushLocked(Entry entry)
+		{
+			entry.Sequence = m_sequence++;
+			m_heap.push_back(std::move(entry));
+			std::ranges::push_heap(m_heap, IsLater);
+			return m_heap.front().Sequence == m_sequence - 1;
+		}
+	protected:
+		void workThread(const sds::LambdaArgs::LambdaArg1& stopCondition, sds::LambdaArgs::LambdaArg2&, InternalType&)
+		{
+			UniqueLockType queueLock(m_queue_mutex);
+			while (!stopCondition && !m_is_stopping)
+			{
+				if (m_heap.empty())
+				{
+					m_queue_cv.wait(queueLock);
+					continue;
+				}
+				const PointInTime deadline = m_heap.front().Deadline;
+				if (ClockType::now() < deadline)
+				{
+					m_queue_cv.wait_until(queueLock, deadline);
+					continue;
+				}
+				std::ranges::pop_heap(m_heap, IsLater);
+				Entry current = std::move(m_heap.back());
+				m_heap.pop_back();
+				queueLock.unlock();
+				current.Callback();
+				queueLock.lock();
+			}
+			//the callers of RunAndWait() are blocked on these, the others are dropped with the queue
+			const auto firstWaited = std::partition(m_heap.begin(), m_heap.end(), [](const Entry& e) { return !e.IsWaitedOn; });
+			std::vector<Entry> waited(std::make_move_iterator(firstWaited), std::make_move_iterator(m_heap.end()));
+			m_heap.erase(firstWaited, m_heap.end());
+			std::ranges::make_heap(m_heap, IsLater);
+			queueLock.unlock();
+			for (const Entry& e : waited)
+				e.Callback();
+		}
+	};
+}
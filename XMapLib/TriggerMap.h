@@ -0,0 +1,69 @@
+#pragma once
+#include "stdafx.h"
+#include "ResponseCurve.h"
+#include <syncstream>
+
+namespace sds
+{
+	/// <summary>
+	/// Utility class for holding an analog trigger to rate modulated output map.
+	///	While the trigger is pulled past the threshold the action repeats, at a rate from MinRate at the threshold
+	///	to MaxRate at full pull, shaped by the response curve.
+	/// </summary>
+	struct TriggerMap
+	{
+		enum class TriggerType : int
+		{
+			LEFT_TRIGGER = 0,
+			RIGHT_TRIGGER = 1
+		};
+		enum class OutputType : int
+		{
+			KEY_TAP = 0, // taps MappedToVK, a key or mouse button
+			WHEEL_VERTICAL = 1, // one wheel notch, positive WheelDirection is forward
+			WHEEL_HORIZONTAL = 2 // one wheel notch, positive WheelDirection is right
+		};
+		//Struct members
+		TriggerType Trigger{ TriggerType::RIGHT_TRIGGER };
+		OutputType Output{ OutputType::KEY_TAP };
+		int MappedToVK{ 0 }; // VK of mapped-to input (key or mouse button), for KEY_TAP
+		int WheelDirection{ 1 }; // 1 or -1, for the wheel outputs
+		int Threshold{ KeyboardSettings::TRIGGER_THRESHOLD }; // trigger value [1,254] at which the output starts
+		float MinRate{ 2.0f }; // actions per second at the threshold
+		float MaxRate{ 20.0f }; // actions per second at full pull
+		ResponseCurve Curve{};
+		/// <returns>a std::string containing an error message if the map is unusable, empty string otherwise.</returns>
+		[[nodiscard]] std::string Validate() const
+		{
+			if (Output == OutputType::KEY_TAP && (MappedToVK <= 0 || MappedToVK > 255))
+				return "TriggerMap::Validate(): MappedToVK outside [1,255].";
+			if (Output != OutputType::KEY_TAP && WheelDirection != 1 && WheelDirection != -1)
+				return "TriggerMap::Validate(): WheelDirection must be 1 or -1.";
+			if (Threshold < 1 || Threshold > 254)
+				return "TriggerMap::Validate(): Threshold outside [1,254].";
+			if (!(MinRate > 0.0f && MinRate <= MaxRate && MaxRate <= KeyboardSettings::TRIGGER_RATE_MAX))
+				return "TriggerMap::Validate(): Rates must satisfy 0 < MinRate <= MaxRate <= TRIGGER_RATE_MAX.";
+			return Curve.Validate();
+		}
+		/// <summary>
+		/// Operator<< overload for std::ostream specialization,
+		///	writes more detailed map details for debugging.
+		///	Thread-safe, provided all writes to the ostream object
+		///	are wrapped with std::osyncstream!
+		/// </summary>
+		friend std::ostream& operator<<(std::ostream& os, const TriggerMap& obj)
+		{
+			std::osyncstream ss(os);
+			ss << "[TriggerMap]" << " ";
+			ss << "Trigger:" << static_cast<int>(obj.Trigger) << " ";
+			ss << "Output:" << static_cast<int>(obj.Output) << " ";
+			ss << "MappedToVK:" << obj.MappedToVK << " ";
+			ss << "Threshold:" << obj.Threshold << " ";
+			ss << "MinRate:" << obj.MinRate << " ";
+			ss << "MaxRate:" << obj.MaxRate << " ";
+			ss << "[/TriggerMap]" << " ";
+			return os;
+		}
+		friend bool operator==(const TriggerMap& lhs, const TriggerMap& rhs) = default;
+	};
+}
@@ -0,0 +1,183 @@
+#pragma once
+#include "stdafx.h"
+#include "Utilities.h"
+#include "TimerQueue.h"
+#include "TriggerMap.h"
+#include "SensitivityMapper.h"
+
+namespace sds
+{
+	/// <summary>
+	/// Maps the analog trigger values to rate modulated outputs, see TriggerMap.
+	///	Pass every polled XINPUT_STATE to FeedState(), see MouseMapper::SetStateListener().
+	///	Each trigger map's output repeats on a Utilities::TimerQueue, share one with KeyboardMapper::GetTimerQueue(),
+	///	the interval for every trigger value is computed once when the map is added.
+	///	Uses its own SendKeyInput, or the key sink, and SendMouseInput, only ever called on the timer thread.
+	/// </summary>
+	class TriggerMapper
+	{
+		using TimerType = Utilities::TimerQueue;
+		using GroupType = TimerType::GroupType;
+		using OutputType = TriggerMap::OutputType;
+	public:
+		/// <summary>Receives each key event in place of SendInput, virtual key and true for key-down.</summary>
+		using KeySinkType = std::function<void(int, bool)>;
+		static constexpr size_t TRIGGER_VALUE_COUNT{ 256 };
+		using IntervalTableType = std::array<std::chrono::microseconds, TRIGGER_VALUE_COUNT>;
+	private:
+		const std::string ERR_DUP_TRIGGER{ "TriggerMapper::AddMap(): A map already uses the trigger." };
+		struct TriggerRuntime
+		{
+			TriggerMap Map{};
+			IntervalTableType Intervals{}; // zero below the threshold
+			std::atomic<int> Value{ 0 };
+			std::atomic<bool> IsScheduled{ false };
+			bool IsKeyDown{ false }; // timer thread only
+		};
+		std::shared_ptr<TimerType> m_timer{};
+		//unique_ptr, timer callbacks hold references to the runtime state
+		std::vector<std::unique_ptr<TriggerRuntime>> m_maps{};
+		std::mutex m_maps_mutex{};
+		Utilities::SendKeyInput m_key_send{}; // timer thread only
+		Utilities::SendMouseInput m_mouse_send{}; // timer thread only
+		const KeySinkType m_key_sink{};
+	public:
+		/// <param name="timer">timer queue to share with other timed outputs, or nullptr for a new one</param>
+		/// <param name="keySink">function receiving the key events in place of SendInput, or empty to send input</param>
+		explicit TriggerMapper(std::shared_ptr<TimerType> timer = nullptr, KeySinkType keySink = {})
+			: m_timer(timer ? std::move(timer) : std::make_shared<TimerType>()), m_key_sink(std::move(keySink))
+		{
+		}
+		TriggerMapper(const TriggerMapper& other) = delete;
+		TriggerMapper(TriggerMapper&& other) = delete;
+		TriggerMapper& operator=(const TriggerMapper& other) = delete;
+		TriggerMapper& operator=(TriggerMapper&& other) = delete;
+		~TriggerMapper()
+		{
+			ClearMaps();
+		}
+		/// <summary>Updates the trigger values, starting the output of any trigger pulled past its threshold.</summary>
+		void FeedState(const XINPUT_STATE& state)
+		{
+			std::lock_guard mapsLock(m_maps_mutex);
+			for (const auto& trigger : m_maps)
+			{
+				const int value = trigger->Map.Trigger == TriggerMap::TriggerType::LEFT_TRIGGER ? state.Gamepad.bLeftTrigger : state.Gamepad.bRightTrigger;
+				trigger->Value.store(value, std::memory_order_relaxed);
+				if (trigger->Intervals[static_cast<size_t>(value)].count() != 0 && !trigger->IsScheduled.exchange(true))
+				{
+					TriggerRuntime& runtime = *trigger;
+					m_timer->Schedule(TimerType::ClockType::now(), GetGroup(runtime), [this, &runtime]() { Fire(runtime); });
+				}
+			}
+		}
+		/// <returns>a std::string containing an error message if there is an error, empty string otherwise.</returns>
+		std::string AddMap(const TriggerMap& map)
+		{
+			std::string er = map.Validate();
+			if (!er.empty())
+				return er;
+			std::lock_guard mapsLock(m_maps_mutex);
+			if (std::ranges::any_of(m_maps, [&map](const auto& t) { return t->Map.Trigger == map.Trigger; }))
+				return ERR_DUP_TRIGGER;
+			auto runtime = std::make_unique<TriggerRuntime>();
+			runtime->Map = map;
+			runtime->Intervals = BuildIntervalTable(map);
+			m_maps.push_back(std::move(runtime));
+			return "";
+		}
+		/// <summary>Stops the outputs and removes the maps, waits for the timer thread to release any key held down.</summary>
+		void ClearMaps()
+		{
+			std::lock_guard mapsLock(m_maps_mutex);
+			if (m_maps.empty())
+				return;
+			//cancelled on the timer thread, so no running Fire() reschedules after the cancel
+			m_timer->RunAndWait(0, [this]()
+			{
+				for (const auto& trigger : m_maps)
+				{
+					m_timer->Cancel(GetGroup(*trigger));
+					ReleaseKey(*trigger);
+				}
+			});
+			m_maps.clear();
+		}
+		[[nodiscard]] std::vector<TriggerMap> GetMaps()
+		{
+			std::lock_guard mapsLock(m_maps_mutex);
+			std::vector<TriggerMap> maps;
+			for (const auto& trigger : m_maps)
+				maps.push_back(trigger->Map);
+			return maps;
+		}
+		[[nodiscard]] std::shared_ptr<TimerType> GetTimerQueue() const
+		{
+			return m_timer;
+		}
+		/// <summary>Computes the output interval for every trigger value, zero below the threshold.</summary>
+		[[nodiscard]] static IntervalTableType BuildIntervalTable(const TriggerMap& map)
+		{
+			using namespace std::chrono;
+			IntervalTableType intervals{};
+			constexpr int valueMax = static_cast<int>(TRIGGER_VALUE_COUNT) - 1;
+			const std::vector<float> rates = SensitivityMapper{}.BuildRateTable(map.Curve, map.Threshold, valueMax, map.MaxRate - map.MinRate);
+			for (size_t i = 0; i < rates.size(); i++)
+			{
+				const float rate = map.MinRate + rates[i];
+				intervals[static_cast<size_t>(map.Threshold) + i] = microseconds(std::lroundf(1'000'000.0f / rate));
+			}
+			return intervals;
+		}
+	private:
+		[[nodiscard]] static GroupType GetGroup(const TriggerRuntime& trigger) noexcept
+		{
+			return static_cast<GroupType>(reinterpret_cast<std::uintptr_t>(&trigger));
+		}
+		/// <summary>Timer callback, sends the output and reschedules itself at the interval for the current trigger value.</summary>
+		void Fire(TriggerRuntime& trigger)
+		{
+			const auto interval = trigger.Intervals[static_cast<size_t>(trigger.Value.load(std::memory_order_relaxed))];
+			if (interval.count() == 0)
+			{
+				trigger.IsScheduled = false;
+				return;
+			}
+			const GroupType group = GetGroup(trigger);
+			switch (trigger.Map.Output)
+			{
+			case OutputType::KEY_TAP:
+			{
+				//key-up after half the interval, at most the tap hold time
+				const auto hold = std::min(interval / 2, std::chrono::microseconds(KeyboardSettings::TRIGGER_TAP_HOLD_MICROSECONDS));
+				SendKey(trigger.Map.MappedToVK, true);
+				trigger.IsKeyDown = true;
+				m_timer->ScheduleAfter(hold, group, [this, &trigger]() { ReleaseKey(trigger); });
+				break;
+			}
+			case OutputType::WHEEL_VERTICAL:
+			case OutputType::WHEEL_HORIZONTAL:
+				m_mouse_send.SendMouseWheel(WHEEL_DELTA * trigger.Map.WheelDirection, trigger.Map.Output == OutputType::WHEEL_HORIZONTAL);
+				break;
+			default:
+				break;
+			}
+			m_timer->ScheduleAfter(interval, group, [this, &trigger]() { Fire(trigger); });
+		}
+		void ReleaseKey(TriggerRuntime& trigger)
+		{
+			if (trigger.IsKeyDown)
+			{
+				SendKey(trigger.Map.MappedToVK, false);
+				trigger.IsKeyDown = false;
+			}
+		}
+		void SendKey(const int vk, const bool isDown)
+		{
+			if (m_key_sink)
+				m_key_sink(vk, isDown);
+			else
+				m_key_send.SendScanCode(vk, isDown);
+		}
+	};
+}
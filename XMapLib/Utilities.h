@@ -1,7 +1,10 @@
 #pragma once
 #include "XELog.h"
+#include "AsyncLog.h"
 #include "CPPRunnerGeneric.h"
 #include "SendKeyInput.h"
 #include "SendMouseInput.h"
 #include "Arithmetic.h"
 #include "DelayManager.h"
+#include "AdaptivePollDelay.h"
+#include "CommandQueue.h"
@@ -0,0 +1,33 @@
+#pragma once
+#include "stdafx.h"
+
+namespace sds::Utilities
+{
+	/// <summary>
+	/// A clock advanced only by its owner, for driving the time dependent logic deterministically.
+	///	Produces time points of the clock used by the keystroke and key repeat logic, starting at the clock's epoch.
+	/// </summary>
+	class VirtualClock
+	{
+	public:
+		using ClockType = std::chrono::high_resolution_clock;
+		using PointInTime = std::chrono::time_point<ClockType>;
+	private:
+		PointInTime m_now{};
+	public:
+		[[nodiscard]] PointInTime Now() const noexcept
+		{
+			return m_now;
+		}
+		/// <summary>Time advanced since the start.</summary>
+		[[nodiscard]] std::chrono::microseconds GetElapsed() const noexcept
+		{
+			return std::chrono::duration_cast<std::chrono::microseconds>(m_now - PointInTime{});
+		}
+		void Advance(const std::chrono::microseconds duration) noexcept
+		{
+			if (duration.count() > 0)
+				m_now += duration;
+		}
+	};
+}
@@ -13,7 +13,13 @@ namespace sds::Utilities
 		/// <returns>printable char value or 0 on error</returns>
 		[[nodiscard]] static PrintableType GetCharFromVK(const VirtualKeyType vk) noexcept
 		{
+#ifdef _WIN32
 			return static_cast<PrintableType>(MapVirtualKeyA(vk, MAPVK_VK_TO_CHAR));
+#else
+			//the digit, letter and space virtual keys are their characters
+			const bool isPrintable = (vk >= '0' && vk <= '9') || (vk >= 'A' && vk <= 'Z') || vk == VK_SPACE;
+			return isPrintable ? static_cast<PrintableType>(vk) : PrintableType{ 0 };
+#endif
 		}
 	};
 }
\ No newline at end of file
@@ -1,100 +1,93 @@
-/*
-Responsible for producing an ActionDetails from
-an XINPUT_STATE for consumption by the rest of the code.
-*/
 #pragma once
 #include "stdafx.h"
-#include "ButtonStateDown.h"
+#include "ControllerBits.h"
 
 namespace sds
 {
 	/// <summary>
-	/// Produces an sds::ActionDetails string from an XINPUT_STATE for consumption by the rest
-	/// of the code. They are space delimited, the tokens are sds::MapInformation tokens.
-	/// <example>
-	/// This might look like: "X B LTRIGGER RTRIGGER LTHUMB:UP RTHUMB:DOWN"
-	/// and another part of the code can use that information to simulate the input mapped to those.
-	/// </example>
+	/// Produces a ControllerBits bitmask from an XINPUT_STATE for consumption by the rest of the code.
+	///	Every digital button, both trigger thresholds, and the 8-way direction of both thumbsticks
+	///	are encoded in a fixed-width mask, so no strings are built or parsed on this path.
+	///	UpdateState() also keeps the previous mask and returns the press/release edges against it.
 	/// </summary>
 	class XInputTranslater
 	{
-		//Utility class with functions that test button/thumbstick/trigger for depressed or "down" status
-		ButtonStateDown m_bsd;
+		using MaskType = ControllerBits::MaskType;
+		using Direction = ControllerBits::StickDirection;
+		//tan(22.5 degrees) scaled by 1000, the boundary between a pure and a diagonal direction.
+		static constexpr long long DIAGONAL_RATIO_NUM{ 414 };
+		static constexpr long long DIAGONAL_RATIO_DEN{ 1000 };
+		int m_left_deadzone{ KeyboardSettings::LEFT_STICK_DEADZONE };
+		int m_right_deadzone{ KeyboardSettings::RIGHT_STICK_DEADZONE };
+		int m_trigger_threshold{ KeyboardSettings::TRIGGER_THRESHOLD };
+		MaskType m_previous{ 0 };
 	public:
 		XInputTranslater() = default;
-		XInputTranslater(const sds::PlayerInfo &player) : m_bsd(player)	{ }
-		XInputTranslater(const XInputTranslater& other) = delete;
-		XInputTranslater(XInputTranslater&& other) = delete;
-		XInputTranslater& operator=(const XInputTranslater& other) = delete;
-		XInputTranslater& operator=(XInputTranslater&& other) = delete;
+		XInputTranslater(const int leftDeadzone, const int rightDeadzone, const int triggerThreshold) noexcept
+			: m_left_deadzone(leftDeadzone), m_right_deadzone(rightDeadzone), m_trigger_threshold(triggerThreshold)
+		{
+		}
+		XInputTranslater(const XInputTranslater& other) = default;
+		XInputTranslater(XInputTranslater&& other) = default;
+		XInputTranslater& operator=(const XInputTranslater& other) = default;
+		XInputTranslater& operator=(XInputTranslater&& other) = default;
 		~XInputTranslater() = default;
-		/// <summary>
-		/// Produces an ActionDetails string from an XINPUT_STATE struct representing the current state
-		/// of the controller, as in what buttons are depressed, what values the thumbsticks are at.
-		/// </summary>
+
+		/// <summary>Produces the bitmask for an XINPUT_STATE struct representing the current state of the controller.</summary>
 		/// <param name="state">state obj retrieved from XInputGetState()</param>
-		/// <returns>ActionDetails string with the information of which buttons are depressed, 
-		/// which thumbsticks and their direction values. Whitespace delimited.
-		/// This might look like: "X B LTRIGGER RTRIGGER LTHUMB:UP RTHUMB:DOWN"</returns>
-		[[nodiscard]] ActionDetails ProcessState(const XINPUT_STATE &state) const
+		/// <returns>ControllerBits mask with a bit set for each depressed button, trigger and thumbstick direction.</returns>
+		[[nodiscard]] MaskType ProcessState(const XINPUT_STATE& state) const noexcept
 		{
-			ActionDetails details;
-			//Buttons
-			for(auto it = sds::sdsActionDescriptors.xin_buttons.cbegin(); it != sds::sdsActionDescriptors.xin_buttons.cend(); ++it)
-			{
-				if( m_bsd.ButtonDown(state,it->first ) ) 
-				{
-					details += it->first + sds::sdsActionDescriptors.delimiter;
-				}
-			}
-			//Triggers
-			if( m_bsd.TriggerDown(state,sds::sdsActionDescriptors.lTrigger) )
-			{
-				details += sds::sdsActionDescriptors.lTrigger + sds::sdsActionDescriptors.delimiter;
-			}
-			if( m_bsd.TriggerDown(state,sds::sdsActionDescriptors.rTrigger) )
-			{
-				details += sds::sdsActionDescriptors.rTrigger + sds::sdsActionDescriptors.delimiter;
-			}
-			//Thumbsticks
-			std::string thumb = sds::sdsActionDescriptors.lThumb + sds::sdsActionDescriptors.moreInfo;
-			//lThumb
-			if( m_bsd.ThumbstickDown(state,thumb + sds::sdsActionDescriptors.up) )
-			{
-				details += thumb + sds::sdsActionDescriptors.up + sds::sdsActionDescriptors.delimiter;
-			}
-			if( m_bsd.ThumbstickDown(state,thumb + sds::sdsActionDescriptors.down) )
-			{
-				details += thumb + sds::sdsActionDescriptors.down + sds::sdsActionDescriptors.delimiter;
-			}
-			if( m_bsd.ThumbstickDown(state, thumb + sds::sdsActionDescriptors.left) )
-			{
-				details += thumb + sds::sdsActionDescriptors.left + sds::sdsActionDescriptors.delimiter;
-			}
-			if( m_bsd.ThumbstickDown(state, thumb + sds::sdsActionDescriptors.right) )
-			{
-				details += thumb + sds::sdsActionDescriptors.right + sds::sdsActionDescriptors.delimiter;
-			}
-			//rThumb
-			thumb = sds::sdsActionDescriptors.rThumb + sds::sdsActionDescriptors.moreInfo;
-			if( m_bsd.ThumbstickDown(state,thumb + sds::sdsActionDescriptors.up) )
-			{
-				details += thumb + sds::sdsActionDescriptors.up + sds::sdsActionDescriptors.delimiter;
-			}
-			if( m_bsd.ThumbstickDown(state,thumb + sds::sdsActionDescriptors.down) )
-			{
-				details += thumb + sds::sdsActionDescriptors.down + sds::sdsActionDescriptors.delimiter;
-			}
-			if( m_bsd.ThumbstickDown(state, thumb + sds::sdsActionDescriptors.left) )
-			{
-				details += thumb + sds::sdsActionDescriptors.left + sds::sdsActionDescriptors.delimiter;
-			}
-			if( m_bsd.ThumbstickDown(state, thumb + sds::sdsActionDescriptors.right) )
-			{
-				details += thumb + sds::sdsActionDescriptors.right + sds::sdsActionDescriptors.delimiter;
-			}
-			return details;
+			const XINPUT_GAMEPAD& pad = state.Gamepad;
+			MaskType mask = static_cast<MaskType>(pad.wButtons) & ControllerBits::BUTTONS_MASK;
+			if (pad.bLeftTrigger > m_trigger_threshold)
+				mask |= ControllerBits::ToMask(ControllerBits::LTRIGGER_BIT);
+			if (pad.bRightTrigger > m_trigger_threshold)
+				mask |= ControllerBits::ToMask(ControllerBits::RTRIGGER_BIT);
+			mask |= StickToMask(pad.sThumbLX, pad.sThumbLY, m_left_deadzone, ControllerBits::LTHUMB_FIRST_BIT);
+			mask |= StickToMask(pad.sThumbRX, pad.sThumbRY, m_right_deadzone, ControllerBits::RTHUMB_FIRST_BIT);
+			return mask;
+		}
+		/// <summary>Produces the bitmask for the state, and the edges against the previously processed state.</summary>
+		/// <param name="state">state obj retrieved from XInputGetState()</param>
+		/// <returns>ControllerStateDiff with the pressed and released bits since the last call.</returns>
+		ControllerStateDiff UpdateState(const XINPUT_STATE& state) noexcept
+		{
+			const MaskType current = ProcessState(state);
+			const ControllerStateDiff diff = ControllerStateDiff::Build(m_previous, current);
+			m_previous = current;
+			return diff;
+		}
+		/// <summary>Forgets the previous state, the next UpdateState() reports every depressed bit as pressed.</summary>
+		void Reset() noexcept
+		{
+			m_previous = 0;
+		}
+		[[nodiscard]] MaskType GetPreviousState() const noexcept
+		{
+			return m_previous;
+		}
+	private:
+		/// <summary>Converts a thumbstick to at most one of 8 direction bits, using a radial deadzone.</summary>
+		[[nodiscard]] static constexpr MaskType StickToMask(const SHORT sx, const SHORT sy, const int deadzone, const int firstBit) noexcept
+		{
+			const long long x = sx;
+			const long long y = sy;
+			const long long dz = deadzone;
+			if ((x * x + y * y) <= (dz * dz))
+				return 0;
+			const long long ax = x < 0 ? -x : x;
+			const long long ay = y < 0 ? -y : y;
+			Direction dir;
+			if (ay * DIAGONAL_RATIO_DEN <= ax * DIAGONAL_RATIO_NUM)
+				dir = x > 0 ? Direction::RIGHT : Direction::LEFT;
+			else if (ax * DIAGONAL_RATIO_DEN <= ay * DIAGONAL_RATIO_NUM)
+				dir = y > 0 ? Direction::UP : Direction::DOWN;
+			else if (y > 0)
+				dir = x > 0 ? Direction::UPRIGHT : Direction::UPLEFT;
+			else
+				dir = x > 0 ? Direction::DOWNRIGHT : Direction::DOWNLEFT;
+			return ControllerBits::ToMask(firstBit + static_cast<int>(dir));
 		}
 	};
-
-}
\ No newline at end of file
+}
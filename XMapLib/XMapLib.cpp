@@ -56,8 +56,11 @@ int main()
 
 	MousePlayerInfo player;
 	KeyboardPlayerInfo kplayer;
+	//The keyboard mapper derives keystrokes from the states polled by the mouse mapper,
+	//so it must be constructed first and destroyed last.
+	KeyboardMapper keyer(kplayer, KeystrokeSource::STATE_FEED);
 	MouseMapper mouser(player);
-	KeyboardMapper keyer(kplayer);
+	mouser.SetStateListener([&keyer](const XINPUT_STATE& state) { keyer.FeedState(state); });
 	std::osyncstream ss(std::cout);
 	AddTestKeyMappings(keyer, ss);
 	GetterExit getter(keyer);
@@ -125,6 +128,13 @@ void AddTestKeyMappings(sds::KeyboardMapper& mapper, std::osyncstream &ss)
 				errorCondition = mapper.AddMap(m);
 			}
 		});
+	//chord, LB+A maps to 'q' and suppresses the 'A' button's own map while held.
+	if (errorCondition.empty())
+		errorCondition = mapper.AddChordMap(KeyboardChordMap{ {VK_PAD_LSHOULDER, VK_PAD_A}, 0x51, false });
+	//macro, Y sends ctrl+c without blocking the other buttons.
+	if (errorCondition.empty())
+		errorCondition = mapper.AddMacroMap(KeyboardMacroMap{ VK_PAD_Y,
+			{ MacroStep::Down(VK_CONTROL), MacroStep::Down(0x43), MacroStep::Wait(20000), MacroStep::Up(0x43), MacroStep::Up(VK_CONTROL) } });
 	if (!errorCondition.empty())
 		ss << "Added buttons until error: " << errorCondition << endl;
 	else
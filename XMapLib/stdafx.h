@@ -5,6 +5,7 @@
 
 #pragma once
 
+#ifdef _WIN32
 #ifndef NOMINMAX
 #define NOMINMAX
 #endif
@@ -14,6 +15,9 @@
 #include <Windows.h>
 #include <Xinput.h>
 #include <tchar.h>
+#else
+#include "LinuxCompat.h"
+#endif
 
 #include <iostream>
 #include <string>
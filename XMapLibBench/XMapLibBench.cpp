@@ -0,0 +1,177 @@
+// XMapLibBench.cpp : Benchmarks for the XMapLib worker threads.
+//Measures how accurately the mouse mover honors its delays: the jitter under a synthetic CPU load for each thread policy,
+//then the achieved rate, drift and jitter over the delay range for each timing mode.
+//The moves go to a recording sink, so nothing is sent to the OS and no controller is needed.
+//Run a Release build, real-time scheduling on Linux needs CAP_SYS_NICE or an RLIMIT_RTPRIO allowance.
+#include "stdafx.h"
+#include "Utilities.h"
+#include "MouseMoveThread.h"
+#include <numeric>
+#include <iomanip>
+#include <cmath>
+#include <syncstream>
+
+namespace
+{
+	using namespace std::chrono;
+	using ClockType = steady_clock;
+
+	using TimingMode = sds::MouseMoveThread::TimingMode;
+	constexpr size_t LoadDelayUs{ 1000 };
+	constexpr seconds RunTime{ 3 };
+	//the ThumbstickToDelay range
+	constexpr std::array<size_t, 5> TimingDelaysUs{ sds::MouseSettings::MICROSECONDS_MIN, 1000, 2000, 5000, sds::MouseSettings::MICROSECONDS_MAX };
+
+	/// <summary>Busy-spins one thread per hardware thread until destroyed, to compete with the mover for CPU time.</summary>
+	class CpuHog
+	{
+		std::atomic<bool> m_is_stop_requested{ false };
+		std::vector<std::thread> m_threads{};
+	public:
+		explicit CpuHog(const unsigned threadCount)
+		{
+			for (unsigned i = 0; i < threadCount; i++)
+			{
+				m_threads.emplace_back([this]()
+				{
+					volatile unsigned long long spin = 0;
+					while (!m_is_stop_requested.load(std::memory_order_relaxed))
+						spin = spin + 1;
+				});
+			}
+		}
+		CpuHog(const CpuHog& other) = delete;
+		CpuHog(CpuHog&& other) = delete;
+		CpuHog& operator=(const CpuHog& other) = delete;
+		CpuHog& operator=(CpuHog&& other) = delete;
+		~CpuHog()
+		{
+			m_is_stop_requested = true;
+			for (auto& t : m_threads)
+				t.join();
+		}
+	};
+
+	struct MoverResult
+	{
+		size_t Count{};
+		double RateHz{}; // achieved moves per second
+		double DriftUs{}; // time of the last move minus the time it was due, from the first move
+		double MeanUs{};
+		double StdDevUs{};
+		double P50Us{};
+		double P99Us{};
+		double MaxUs{};
+	};
+
+	/// <summary>Runs the mover at a fixed delay and records the time of each move, from the mover thread,
+	///	into storage allocated up front.</summary>
+	MoverResult MeasureMover(const sds::Utilities::ThreadPolicy& policy, const size_t delayUs, const TimingMode mode)
+	{
+		//enough for every move at the delay, with room to spare
+		std::vector<ClockType::time_point> stamps(2 * RunTime.count() * 1'000'000 / delayUs);
+		size_t stampCount = 0;
+		{
+			sds::MouseMoveThread mover(policy, [&stamps, &stampCount](const int x, const int)
+			{
+				if (x != 0 && stampCount < stamps.size())
+					stamps[stampCount++] = ClockType::now();
+			}, mode);
+			mover.UpdateState(delayUs, delayUs, true, true, true, false);
+			std::this_thread::sleep_for(RunTime);
+		} // mover thread joined here, stampCount is final
+		MoverResult result;
+		if (stampCount < 2)
+			return result;
+		const auto toUs = [](const ClockType::duration d) { return duration_cast<duration<double, std::micro>>(d).count(); };
+		const double spanUs = toUs(stamps[stampCount - 1] - stamps[0]);
+		result.Count = stampCount;
+		result.RateHz = static_cast<double>(stampCount - 1) * 1'000'000.0 / spanUs;
+		result.DriftUs = spanUs - static_cast<double>((stampCount - 1) * delayUs);
+		//jitter is the distance of each move interval from the requested delay
+		std::vector<double> jitter;
+		jitter.reserve(stampCount);
+		for (size_t i = 1; i < stampCount; i++)
+			jitter.push_back(std::abs(toUs(stamps[i] - stamps[i - 1]) - static_cast<double>(delayUs)));
+		std::ranges::sort(jitter);
+		result.MeanUs = std::accumulate(jitter.begin(), jitter.end(), 0.0) / static_cast<double>(jitter.size());
+		double sumSquares = 0.0;
+		for (const double j : jitter)
+			sumSquares += (j - result.MeanUs) * (j - result.MeanUs);
+		result.StdDevUs = std::sqrt(sumSquares / static_cast<double>(jitter.size()));
+		result.P50Us = jitter[jitter.size() / 2];
+		result.P99Us = jitter[std::min(jitter.size() - 1, jitter.size() * 99 / 100)];
+		result.MaxUs = jitter.back();
+		return result;
+	}
+	void PrintJitter(std::osyncstream& ss, const MoverResult& r)
+	{
+		ss << " mean:" << std::setw(8) << r.MeanUs
+			<< " stddev:" << std::setw(8) << r.StdDevUs
+			<< " p50:" << std::setw(8) << r.P50Us
+			<< " p99:" << std::setw(8) << r.P99Us
+			<< " max:" << std::setw(9) << r.MaxUs << std::endl;
+	}
+	/// <summary>Jitter of each thread policy, with a CPU hog thread per hardware thread competing with the mover.</summary>
+	void RunPolicyBench(std::osyncstream& ss)
+	{
+		using sds::Utilities::ThreadPolicy;
+		const std::vector<std::pair<std::string, ThreadPolicy>> policies
+		{
+			{ "Default", ThreadPolicy::Default() },
+			{ "ForOutput", ThreadPolicy::ForOutput() },
+			{ "ForRealtimeOutput", ThreadPolicy::ForRealtimeOutput() }
+		};
+		const unsigned hogCount = std::max(1u, std::thread::hardware_concurrency());
+		ss << "Mouse mover jitter by thread policy, " << LoadDelayUs << "us delay, " << RunTime.count() << "s per policy, "
+			<< hogCount << " CPU hog threads." << std::endl;
+		ss << "Jitter is the distance of each move interval from the delay, in microseconds." << std::endl;
+		ss.emit();
+		CpuHog hog(hogCount);
+		for (const auto& [name, policy] : policies)
+		{
+			const MoverResult r = MeasureMover(policy, LoadDelayUs, TimingMode::RESET_FROM_NOW);
+			ss << std::fixed << std::setprecision(1)
+				<< std::left << std::setw(18) << name << std::right
+				<< " moves:" << std::setw(6) << r.Count;
+			PrintJitter(ss, r);
+			ss.emit();
+		}
+	}
+	/// <summary>Rate, drift and jitter of each timing mode over the delay range, without added load.</summary>
+	void RunTimingBench(std::osyncstream& ss)
+	{
+		const std::array<std::pair<std::string, TimingMode>, 2> modes
+		{ {
+			{ "Reset", TimingMode::RESET_FROM_NOW },
+			{ "Advance", TimingMode::ADVANCE_DEADLINE }
+		} };
+		ss << "Mouse mover timing by mode, " << RunTime.count() << "s per run, ThreadPolicy::ForOutput()." << std::endl;
+		ss << "Drift is the time of the last move minus the time it was due, counted from the first move, in microseconds." << std::endl;
+		ss.emit();
+		for (const size_t delayUs : TimingDelaysUs)
+		{
+			for (const auto& [name, mode] : modes)
+			{
+				const MoverResult r = MeasureMover(sds::Utilities::ThreadPolicy::ForOutput(), delayUs, mode);
+				ss << std::fixed << std::setprecision(1)
+					<< std::setw(6) << delayUs << "us " << std::left << std::setw(8) << name << std::right
+					<< " rate:" << std::setw(8) << r.RateHz << "/" << std::setw(6) << 1'000'000.0 / static_cast<double>(delayUs) << "Hz"
+					<< " drift:" << std::setw(9) << r.DriftUs;
+				PrintJitter(ss, r);
+				ss.emit();
+			}
+		}
+	}
+}
+
+/* Entry Point */
+int main()
+{
+	std::osyncstream ss(std::cout);
+	RunPolicyBench(ss);
+	ss << std::endl;
+	RunTimingBench(ss);
+	ss.emit();
+	return 0;
+}
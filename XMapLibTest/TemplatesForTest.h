@@ -2,6 +2,7 @@
 #include <cmath>
 #include "pch.h"
 #include "CppUnitTest.h"
+#include "../XMapLib/stdafx.h"
 
 //using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -31,4 +32,11 @@ namespace XMapLibTest::TemplatesForTest
 	{
 		return std::isnormal(static_cast<float>(val));
 	};
+	inline XINPUT_KEYSTROKE MakeStroke(const WORD vk, const WORD flags) noexcept
+	{
+		XINPUT_KEYSTROKE stroke{};
+		stroke.VirtualKey = vk;
+		stroke.Flags = flags;
+		return stroke;
+	}
 }
\ No newline at end of file
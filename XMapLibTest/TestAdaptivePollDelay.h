@@ -0,0 +1,82 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/AdaptivePollDelay.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	TEST_CLASS(TestAdaptivePollDelay)
+	{
+		static constexpr size_t FastUs = 1000;
+		static constexpr size_t SlowUs = 20000;
+		static constexpr size_t IdleCount = 5;
+	public:
+		TEST_METHOD(TestRampAndDecay)
+		{
+			using namespace sds::Utilities;
+			Logger::WriteMessage("Begin TestRampAndDecay()");
+			AdaptivePollDelay delay(FastUs, SlowUs, IdleCount);
+			//starts out idle, at the slow rate
+			Assert::AreEqual(delay.GetCurrentDelay(), SlowUs);
+			//changing input snaps to the fast rate
+			Assert::AreEqual(delay.Update(true), FastUs);
+			//holds the fast rate for the idle count
+			for (size_t i = 0; i < IdleCount; i++)
+				Assert::AreEqual(delay.Update(false), FastUs, L"Expected fast rate during hold period.");
+			//then decays, never exceeding the slow rate
+			size_t last = FastUs;
+			for (size_t i = 0; i < 32; i++)
+			{
+				const size_t current = delay.Update(false);
+				Assert::IsTrue(current >= last && current <= SlowUs, L"Expected monotonic decay bounded by the slow rate.");
+				last = current;
+			}
+			Assert::AreEqual(last, SlowUs);
+			//input change from idle snaps back immediately
+			Assert::AreEqual(delay.Update(true), FastUs);
+			Assert::IsTrue(delay.GetCurrentRate() > 999.0);
+			Logger::WriteMessage("End TestRampAndDecay()");
+		}
+		TEST_METHOD(TestSetBounds)
+		{
+			using namespace sds::Utilities;
+			Logger::WriteMessage("Begin TestSetBounds()");
+			AdaptivePollDelay delay(FastUs, SlowUs, IdleCount);
+			delay.SetBounds(500, 4000);
+			Assert::AreEqual(delay.Update(true), size_t{ 500 });
+			//bad bounds are corrected, the slow rate is never faster than the fast rate
+			delay.SetBounds(0, 0);
+			Assert::AreEqual(delay.GetMinDelay(), size_t{ 1 });
+			Assert::AreEqual(delay.GetMaxDelay(), size_t{ 1 });
+			Assert::AreEqual(delay.Update(false), size_t{ 1 });
+			Logger::WriteMessage("End TestSetBounds()");
+		}
+		TEST_METHOD(TestSetBoundsConcurrent)
+		{
+			using namespace sds::Utilities;
+			Logger::WriteMessage("Begin TestSetBoundsConcurrent()");
+			AdaptivePollDelay delay(10, 20, 0);
+			std::atomic<bool> isDone{ false };
+			//the bounds are swapped between two disjoint ranges while the poller updates
+			std::thread setter([&]()
+				{
+					while (!isDone)
+					{
+						delay.SetBounds(1000, 2000);
+						delay.SetBounds(10, 20);
+					}
+				});
+			bool isInRange = true;
+			for (int i = 0; i < 100'000 && isInRange; i++)
+			{
+				const size_t current = delay.Update(i % 3 == 0);
+				isInRange = (current >= 10 && current <= 20) || (current >= 1000 && current <= 2000);
+			}
+			isDone = true;
+			setter.join();
+			Assert::IsTrue(isInRange);
+			Logger::WriteMessage("End TestSetBoundsConcurrent()");
+		}
+	};
+}
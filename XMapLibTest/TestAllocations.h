@@ -0,0 +1,153 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/KeyboardTranslator.h"
+#include "../XMapLib/KeyboardInputPoller.h"
+#include "../XMapLib/ThumbstickProcessor.h"
+#include "../XMapLib/ThumbstickFilter.h"
+#include "../XMapLib/AsyncLog.h"
+#include <cstdlib>
+#include <new>
+
+namespace XMapLibTest
+{
+	/// <summary>Counts the heap allocations made by the current thread while a Scope is alive,
+	///	through the replacement global operator new below.</summary>
+	namespace AllocationTracking
+	{
+		inline thread_local bool IsTracking{ false };
+		inline thread_local size_t Count{ 0 };
+		struct Scope
+		{
+			Scope() noexcept { Count = 0; IsTracking = true; }
+			Scope(const Scope& other) = delete;
+			Scope(Scope&& other) = delete;
+			Scope& operator=(const Scope& other) = delete;
+			Scope& operator=(Scope&& other) = delete;
+			~Scope() { IsTracking = false; }
+			[[nodiscard]] size_t GetCount() const noexcept { return Count; }
+		};
+	}
+}
+//Replaces the global allocation functions for the whole test module, this header must only be included by one translation unit.
+//The array and nothrow forms call these by default.
+void* operator new(const std::size_t size)
+{
+	if (XMapLibTest::AllocationTracking::IsTracking)
+		++XMapLibTest::AllocationTracking::Count;
+	if (void* p = std::malloc(size != 0 ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	using TemplatesForTest::MakeStroke;
+	/// <summary>Replays inputs through the poll, translate and emit paths after a warm-up replay,
+	///	and fails if the steady-state replays allocate.</summary>
+	TEST_CLASS(TestAllocations)
+	{
+		static constexpr int ReplayCount{ 100 };
+	public:
+		TEST_METHOD(TestTrackerCounts)
+		{
+			Logger::WriteMessage("Begin TestTrackerCounts()");
+			AllocationTracking::Scope tracking;
+			auto p = std::make_unique<int>(1);
+			Assert::AreEqual(tracking.GetCount(), size_t{ 1 }, L"Expected the replacement operator new to count allocations.");
+			Logger::WriteMessage("End TestTrackerCounts()");
+		}
+		TEST_METHOD(TestTranslatorSteadyState)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestTranslatorSteadyState()");
+			KeyboardTranslator translator;
+			//counted instead of sent, set before tracking starts
+			size_t sentCount = 0;
+			translator.SetKeySink([&sentCount](int, bool) { ++sentCount; });
+			Assert::IsTrue(translator.AddKeyMap(KeyboardKeyMap{ VK_PAD_A, VK_SPACE, false }).empty());
+			Assert::IsTrue(translator.AddKeyMap(KeyboardKeyMap{ VK_PAD_LTHUMB_UP, 0x57, true }).empty());
+			Assert::IsTrue(translator.AddKeyMap(KeyboardKeyMap{ VK_PAD_LTHUMB_RIGHT, 0x44, true }).empty());
+			//button press and release, then a thumbstick direction overtaken by another
+			const std::vector<XINPUT_KEYSTROKE> strokes
+			{
+				MakeStroke(VK_PAD_A, XINPUT_KEYSTROKE_KEYDOWN),
+				MakeStroke(VK_PAD_A, XINPUT_KEYSTROKE_KEYUP),
+				MakeStroke(VK_PAD_LTHUMB_UP, XINPUT_KEYSTROKE_KEYDOWN),
+				MakeStroke(VK_PAD_LTHUMB_RIGHT, XINPUT_KEYSTROKE_KEYDOWN),
+				MakeStroke(VK_PAD_LTHUMB_UP, XINPUT_KEYSTROKE_KEYUP),
+				MakeStroke(VK_PAD_LTHUMB_RIGHT, XINPUT_KEYSTROKE_KEYDOWN),
+				MakeStroke(VK_PAD_LTHUMB_RIGHT, XINPUT_KEYSTROKE_KEYUP),
+				XINPUT_KEYSTROKE{}
+			};
+			//warm-up, the first pass may allocate
+			for (const auto& stroke : strokes)
+				translator.ProcessKeystroke(stroke);
+			AllocationTracking::Scope tracking;
+			for (int i = 0; i < ReplayCount; i++)
+			{
+				for (const auto& stroke : strokes)
+					translator.ProcessKeystroke(stroke);
+			}
+			Assert::AreEqual(tracking.GetCount(), size_t{ 0 }, L"Expected no allocation processing keystrokes.");
+			Assert::IsTrue(sentCount > 0, L"Expected the replays to produce key events.");
+			translator.CleanupInProgressEvents();
+			Logger::WriteMessage("End TestTranslatorSteadyState()");
+		}
+		TEST_METHOD(TestPollerSteadyState)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestPollerSteadyState()");
+			KeyboardInputPoller poller(KeyboardPlayerInfo{}, KeystrokeSource::STATE_FEED);
+			std::vector<XINPUT_KEYSTROKE> states;
+			states.reserve(KeyboardSettings::MAX_STATE_COUNT);
+			XINPUT_STATE pressed{};
+			pressed.Gamepad.wButtons = XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_DPAD_UP;
+			pressed.Gamepad.sThumbLX = std::numeric_limits<SHORT>::max();
+			const XINPUT_STATE released{};
+			auto replay = [&]()
+			{
+				poller.FeedState(pressed);
+				poller.FeedState(released);
+				poller.GetAndClearStates(states);
+				return states.size();
+			};
+			Assert::IsTrue(replay() > 0, L"Expected the fed states to produce keystrokes.");
+			AllocationTracking::Scope tracking;
+			for (int i = 0; i < ReplayCount; i++)
+				replay();
+			Assert::AreEqual(tracking.GetCount(), size_t{ 0 }, L"Expected no allocation feeding states and collecting keystrokes.");
+			Logger::WriteMessage("End TestPollerSteadyState()");
+		}
+		TEST_METHOD(TestStickAndLogSteadyState)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestStickAndLogSteadyState()");
+			const ThumbstickProcessor stick(MouseSettings::SENSITIVITY_DEFAULT, MouseSettings::SENSITIVITY_DEFAULT, MousePlayerInfo{}, StickMap::RIGHT_STICK);
+			ThumbstickFilter filter;
+			Utilities::AsyncLogger logger([](std::string_view) {}, std::chrono::microseconds(0));
+			AllocationTracking::Scope tracking;
+			size_t total = 0;
+			for (int i = std::numeric_limits<SHORT>::min(); i <= std::numeric_limits<SHORT>::max(); i += 97)
+			{
+				const auto axes = filter.Process(static_cast<SHORT>(i), static_cast<SHORT>(-i - 1), 0.001f);
+				const auto move = stick.Process(axes.X, axes.Y);
+				total += move.XDelay + move.YDelay;
+			}
+			for (int i = 0; i < ReplayCount; i++)
+				logger.Log(Utilities::LogMessageId::BAD_MAPPED_VALUE, i);
+			Assert::AreEqual(tracking.GetCount(), size_t{ 0 }, L"Expected no allocation filtering or processing the stick, or logging.");
+			Assert::IsTrue(total > 0);
+			Logger::WriteMessage("End TestStickAndLogSteadyState()");
+		}
+	};
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/AsyncLog.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	TEST_CLASS(TestAsyncLog)
+	{
+	public:
+		TEST_METHOD(TestRateLimit)
+		{
+			using namespace sds::Utilities;
+			Logger::WriteMessage("Begin TestRateLimit()");
+			std::vector<std::string> lines;
+			{
+				AsyncLogger logger([&lines](std::string_view s) { lines.emplace_back(s); }, std::chrono::hours(1));
+				//stopped, so the messages and the suppressed count are written out by the same drain
+				logger.Stop();
+				for (int i = 0; i < 5; i++)
+					logger.Log(LogMessageId::BAD_MAPPED_VALUE, i);
+				logger.Log(LogMessageId::SEND_INPUT_FAILED, 5);
+				Assert::AreEqual(logger.GetSuppressedCount(LogMessageId::BAD_MAPPED_VALUE), std::uint64_t{ 4 });
+				Assert::AreEqual(logger.GetSuppressedCount(LogMessageId::SEND_INPUT_FAILED), std::uint64_t{ 0 }, L"Expected a separate limit per message id.");
+				logger.Start();
+			} // sink thread writes out the remaining messages when stopping
+			Assert::AreEqual(lines.size(), size_t{ 2 });
+			//the suppressed count is appended when the sink writes the message after the suppressed ones were logged
+			Assert::IsTrue(std::ranges::any_of(lines, [](const std::string& s) { return s.starts_with("ThumbstickToDelay::GetMappedValue(): Failed to acquire mapped value with key: 0"); }));
+			Assert::IsTrue(std::ranges::any_of(lines, [](const std::string& s) { return s == "SendInput returned 0, GetLastError(): 5"; }));
+			Logger::WriteMessage("End TestRateLimit()");
+		}
+		TEST_METHOD(TestSuppressedAtStop)
+		{
+			using namespace sds::Utilities;
+			Logger::WriteMessage("Begin TestSuppressedAtStop()");
+			std::vector<std::string> lines;
+			{
+				AsyncLogger logger([&lines](std::string_view s) { lines.emplace_back(s); }, std::chrono::hours(1));
+				logger.Log(LogMessageId::BAD_MAPPED_VALUE, 1);
+				//written out, before the suppressed ones are logged
+				logger.Stop();
+				Assert::AreEqual(lines.size(), size_t{ 1 });
+				for (int i = 0; i < 3; i++)
+					logger.Log(LogMessageId::BAD_MAPPED_VALUE, i);
+				logger.Start();
+			}
+			//no later message with the id, the count is written out when stopping
+			Assert::AreEqual(lines.size(), size_t{ 2 });
+			Assert::AreEqual(lines.back(), std::string("AsyncLogger: 3 similar messages suppressed. Message id 6."));
+			Logger::WriteMessage("End TestSuppressedAtStop()");
+		}
+		TEST_METHOD(TestDroppedCount)
+		{
+			using namespace sds::Utilities;
+			Logger::WriteMessage("Begin TestDroppedCount()");
+			constexpr size_t extra = 10;
+			std::vector<std::string> lines;
+			{
+				AsyncLogger logger([&lines](std::string_view s) { lines.emplace_back(s); }, std::chrono::microseconds(0));
+				logger.Stop();
+				lines.clear();
+				for (size_t i = 0; i < AsyncLogger::BUFFER_CAPACITY + extra; i++)
+					logger.Log(LogMessageId::KEYSTROKE_BUFFER_DROP);
+				Assert::AreEqual(logger.GetDroppedCount(LogMessageId::KEYSTROKE_BUFFER_DROP), std::uint64_t{ extra });
+				logger.Start();
+			}
+			//every buffered message, then the drop count
+			Assert::AreEqual(lines.size(), AsyncLogger::BUFFER_CAPACITY + 1);
+			Assert::AreEqual(lines.back(), std::string("AsyncLogger: 10 messages dropped, buffer full. Message id 0."));
+			Logger::WriteMessage("End TestDroppedCount()");
+		}
+	};
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/CPPRunnerGeneric.h"
+#include "../XMapLib/MouseMoveThread.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	TEST_CLASS(TestCPPRunner)
+	{
+		using RunnerType = sds::CPPRunnerGeneric<std::vector<std::thread::id>>;
+	public:
+		TEST_METHOD(TestParkedRestart)
+		{
+			Logger::WriteMessage("Begin TestParkedRestart()");
+			//each run records the thread it ran on, then waits for the stop
+			RunnerType runner([](const std::atomic<bool>& stopCondition, std::mutex& mut, std::vector<std::thread::id>& ids)
+			{
+				{
+					std::lock_guard lock(mut);
+					ids.push_back(std::this_thread::get_id());
+				}
+				while (!stopCondition)
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			});
+			Assert::IsFalse(runner.IsRunning());
+			for (int i = 0; i < 3; i++)
+			{
+				Assert::IsTrue(runner.StartThread());
+				Assert::IsFalse(runner.StartThread(), L"Expected a second start while running to fail.");
+				Assert::IsTrue(runner.IsRunning());
+				WaitForRuns(runner, static_cast<size_t>(i) + 1);
+				runner.StopThread();
+				Assert::IsFalse(runner.IsRunning());
+			}
+			//a non-blocking stop followed by a start runs again once the lambda has returned
+			Assert::IsTrue(runner.StartThread());
+			WaitForRuns(runner, 4);
+			runner.RequestStop();
+			Assert::IsTrue(runner.StartThread());
+			WaitForRuns(runner, 5);
+			runner.StopThread();
+			const auto ids = runner.GetCurrentState();
+			Assert::AreEqual(ids.size(), size_t{ 5 });
+			Assert::IsTrue(std::ranges::all_of(ids, [&ids](const std::thread::id id) { return id == ids.front(); }), L"Expected every run on the same parked thread.");
+			Assert::IsTrue(ids.front() != std::this_thread::get_id());
+			Logger::WriteMessage("End TestParkedRestart()");
+		}
+		TEST_METHOD(TestMoverRestart)
+		{
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestMoverRestart()");
+			std::atomic<size_t> moves{ 0 };
+			sds::MouseMoveThread mover(sds::Utilities::ThreadPolicy::Default(), [&moves](int, int) { ++moves; }, sds::MouseMoveThread::TimingMode::RESET_FROM_NOW, false);
+			Assert::IsFalse(mover.IsRunning());
+			for (int i = 0; i < 2; i++)
+			{
+				mover.SetTimingMode(i == 0 ? sds::MouseMoveThread::TimingMode::RESET_FROM_NOW : sds::MouseMoveThread::TimingMode::ADVANCE_DEADLINE);
+				mover.Start();
+				mover.UpdateState(1000, 1000, true, true, true, false);
+				const auto deadline = steady_clock::now() + seconds(5);
+				while (moves < 3 && steady_clock::now() < deadline)
+					std::this_thread::sleep_for(milliseconds(1));
+				mover.Stop();
+				Assert::IsTrue(moves >= 3, L"Expected the restarted mover to send moves.");
+				//stopped, and the state cleared
+				moves = 0;
+				std::this_thread::sleep_for(milliseconds(5));
+				Assert::AreEqual(moves.load(), size_t{ 0 });
+			}
+			Logger::WriteMessage("End TestMoverRestart()");
+		}
+		TEST_METHOD(TestSwapDrain)
+		{
+			Logger::WriteMessage("Begin TestSwapDrain()");
+			sds::CPPRunnerGeneric<std::vector<int>> runner([](const std::atomic<bool>&, std::mutex&, std::vector<int>&) {});
+			runner.ReserveStates(64);
+			runner.UpdateState({ 1, 2, 3 });
+			//the by value drain hands out the contents and leaves the runner empty
+			const auto first = runner.GetAndClearCurrentStates();
+			Assert::IsTrue(first == std::vector<int>{ 1, 2, 3 });
+			Assert::IsTrue(runner.GetCurrentState().empty());
+			runner.ReserveStates(64);
+			//the buffer drain swaps, the two buffers trade storage back and forth and keep their capacity
+			std::vector<int> drained;
+			drained.reserve(64);
+			std::vector<const int*> storage{ drained.data() };
+			for (int i = 0; i < 4; i++)
+			{
+				runner.UpdateState({ i });
+				runner.GetAndClearCurrentStates(drained);
+				Assert::IsTrue(drained == std::vector<int>{ i });
+				Assert::IsTrue(drained.capacity() >= 64);
+				Assert::IsTrue(runner.GetCurrentState().empty());
+				storage.push_back(drained.data());
+			}
+			Assert::IsTrue(std::ranges::all_of(storage, [&storage](const int* p) { return p == storage[0] || p == storage[1]; }), L"Expected the drain to reuse two buffers.");
+			Logger::WriteMessage("End TestSwapDrain()");
+		}
+	private:
+		static void WaitForRuns(RunnerType& runner, const size_t count)
+		{
+			const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+			while (runner.GetCurrentState().size() < count && std::chrono::steady_clock::now() < deadline)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			Assert::AreEqual(runner.GetCurrentState().size(), count);
+		}
+	};
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/CommandQueue.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	TEST_CLASS(TestCommandQueue)
+	{
+	public:
+		TEST_METHOD(TestDrainOrder)
+		{
+			Logger::WriteMessage("Begin TestDrainOrder()");
+			sds::Utilities::CommandQueue queue;
+			std::vector<int> ran;
+			Assert::AreEqual(queue.Drain(), size_t{ 0 });
+			for (int i = 0; i < 3; i++)
+				queue.Post([&ran, i]() { ran.push_back(i); });
+			Assert::IsTrue(ran.empty(), L"Expected commands to run only when drained.");
+			Assert::AreEqual(queue.Drain(), size_t{ 3 });
+			Assert::IsTrue(ran == std::vector<int>{ 0, 1, 2 });
+			//a command posted while draining runs on this drain or the next
+			queue.Post([&queue, &ran]() { queue.Post([&ran]() { ran.push_back(4); }); ran.push_back(3); });
+			queue.Drain();
+			queue.Drain();
+			Assert::IsTrue(ran == std::vector<int>{ 0, 1, 2, 3, 4 });
+			Assert::AreEqual(queue.GetPostedCount(), size_t{ 5 });
+			Logger::WriteMessage("End TestDrainOrder()");
+		}
+		TEST_METHOD(TestProducers)
+		{
+			Logger::WriteMessage("Begin TestProducers()");
+			constexpr int ProducerCount{ 4 };
+			constexpr int CommandCount{ 5000 };
+			sds::Utilities::CommandQueue queue;
+			//consumer thread state only, each producer's commands must run in its posting order
+			std::array<int, ProducerCount> lastRun{};
+			lastRun.fill(-1);
+			bool isOrdered = true;
+			std::atomic<bool> isDone{ false };
+			size_t total = 0;
+			std::thread consumer([&]()
+			{
+				while (!isDone)
+					total += queue.Drain();
+				total += queue.Drain();
+			});
+			std::vector<std::thread> producers;
+			for (int p = 0; p < ProducerCount; p++)
+			{
+				producers.emplace_back([&, p]()
+				{
+					for (int i = 0; i < CommandCount; i++)
+					{
+						queue.Post([&, p, i]()
+						{
+							isOrdered = isOrdered && lastRun[static_cast<size_t>(p)] == i - 1;
+							lastRun[static_cast<size_t>(p)] = i;
+						});
+					}
+				});
+			}
+			for (auto& t : producers)
+				t.join();
+			isDone = true;
+			consumer.join();
+			Assert::AreEqual(total, static_cast<size_t>(ProducerCount * CommandCount));
+			Assert::IsTrue(isOrdered, L"Expected each producer's commands in order.");
+			Logger::WriteMessage("End TestProducers()");
+		}
+		TEST_METHOD(TestUndrained)
+		{
+			Logger::WriteMessage("Begin TestUndrained()");
+			auto counter = std::make_shared<int>(0);
+			{
+				sds::Utilities::CommandQueue queue;
+				queue.Post([counter]() { ++*counter; });
+				queue.Post([counter]() { ++*counter; });
+				Assert::AreEqual(counter.use_count(), 3L);
+			}
+			Assert::AreEqual(*counter, 0, L"Expected undrained commands not to run.");
+			Assert::AreEqual(counter.use_count(), 1L, L"Expected undrained commands to be destroyed.");
+			Logger::WriteMessage("End TestUndrained()");
+		}
+	};
+}
@@ -0,0 +1,169 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/EvdevInputSource.h"
+#include "../XMapLib/KeystrokeSynthesizer.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	TEST_CLASS(TestEvdev)
+	{
+		using EventType = sds::Evdev::EvdevEvent;
+	public:
+		TEST_METHOD(TestButtonsAndHat)
+		{
+			using namespace sds::Evdev;
+			Logger::WriteMessage("Begin TestButtonsAndHat()");
+			sds::EvdevTranslator translator;
+			Assert::IsFalse(translator.Process(Key(BTN_CODE_A, 1)));
+			Assert::IsFalse(translator.Process(Abs(ABS_CODE_HAT0X, -1)));
+			Assert::IsTrue(translator.Process(Report()));
+			XINPUT_STATE state = translator.GetState();
+			Assert::AreEqual(static_cast<int>(state.Gamepad.wButtons), XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_DPAD_LEFT);
+			Assert::AreEqual(state.dwPacketNumber, DWORD{ 1 });
+			//the hat moving to the other side replaces the direction, autorepeat values keep the button down
+			translator.Process(Abs(ABS_CODE_HAT0X, 1));
+			translator.Process(Key(BTN_CODE_A, 2));
+			translator.Process(Key(BTN_CODE_START, 1));
+			translator.Process(Report());
+			state = translator.GetState();
+			Assert::AreEqual(static_cast<int>(state.Gamepad.wButtons), XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_DPAD_RIGHT | XINPUT_GAMEPAD_START);
+			translator.Process(Key(BTN_CODE_A, 0));
+			translator.Process(Abs(ABS_CODE_HAT0X, 0));
+			translator.Process(Key(0x2ff, 1));
+			translator.Process(Report());
+			Assert::AreEqual(static_cast<int>(translator.GetState().Gamepad.wButtons), XINPUT_GAMEPAD_START);
+			Logger::WriteMessage("End TestButtonsAndHat()");
+		}
+		TEST_METHOD(TestAxes)
+		{
+			using namespace sds;
+			using namespace sds::Evdev;
+			Logger::WriteMessage("Begin TestAxes()");
+			//the defaults are the xpad ranges, Y inverted
+			EvdevTranslator translator;
+			translator.Process(Abs(ABS_CODE_X, 32767));
+			translator.Process(Abs(ABS_CODE_Y, -32768));
+			translator.Process(Abs(ABS_CODE_RZ, 255));
+			translator.Process(Report());
+			const XINPUT_GAMEPAD pad = translator.GetState().Gamepad;
+			Assert::AreEqual(static_cast<int>(pad.sThumbLX), 32767);
+			Assert::AreEqual(static_cast<int>(pad.sThumbLY), 32767, L"Expected evdev up to be XInput up.");
+			Assert::AreEqual(static_cast<int>(pad.bRightTrigger), 255);
+			//a device with other ranges, values are scaled and clamped
+			const EvdevAxisRange stick{ 0, 255, false };
+			const EvdevAxisRange trigger{ 0, 1023, false };
+			Assert::AreEqual(static_cast<int>(EvdevTranslator::ScaleStick(0, stick)), -32768);
+			Assert::AreEqual(static_cast<int>(EvdevTranslator::ScaleStick(255, stick)), 32767);
+			Assert::AreEqual(static_cast<int>(EvdevTranslator::ScaleStick(300, stick)), 32767);
+			Assert::IsTrue(std::abs(EvdevTranslator::ScaleStick(128, stick)) < 256);
+			Assert::AreEqual(static_cast<int>(EvdevTranslator::ScaleTrigger(1023, trigger)), 255);
+			Assert::AreEqual(static_cast<int>(EvdevTranslator::ScaleTrigger(-5, trigger)), 0);
+			Assert::AreEqual(static_cast<int>(EvdevTranslator::ScaleStick(10, EvdevAxisRange{ 5, 5, false })), 0);
+			Logger::WriteMessage("End TestAxes()");
+		}
+		TEST_METHOD(TestDropped)
+		{
+			using namespace sds::Evdev;
+			Logger::WriteMessage("Begin TestDropped()");
+			sds::EvdevTranslator translator;
+			translator.Process(Key(BTN_CODE_B, 1));
+			translator.Process(Report());
+			//after a drop nothing is applied up to the next report, which is neutral so no key is left held
+			translator.Process(EventType{ 0, 0, EV_TYPE_SYN, SYN_CODE_DROPPED, 0 });
+			translator.Process(Key(BTN_CODE_Y, 1));
+			Assert::IsTrue(translator.Process(Report()));
+			Assert::AreEqual(static_cast<int>(translator.GetState().Gamepad.wButtons), 0);
+			translator.Process(Key(BTN_CODE_Y, 1));
+			translator.Process(Report());
+			Assert::AreEqual(static_cast<int>(translator.GetState().Gamepad.wButtons), XINPUT_GAMEPAD_Y);
+			Assert::AreEqual(translator.GetState().dwPacketNumber, DWORD{ 3 });
+			Logger::WriteMessage("End TestDropped()");
+		}
+#ifdef __linux__
+		TEST_METHOD(TestPipeSource)
+		{
+			using namespace sds::Evdev;
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestPipeSource()");
+			std::array<int, 2> ends{};
+			Assert::IsTrue(pipe(ends.data()) == 0);
+			std::mutex framesMutex;
+			std::vector<XINPUT_STATE> frames;
+			{
+				sds::EvdevInputSource source(ends[0], [&](const XINPUT_STATE& state)
+				{
+					std::lock_guard framesLock(framesMutex);
+					frames.push_back(state);
+				});
+				Assert::IsTrue(source.IsRunning());
+				//the frames feed keystrokes, as with KeyboardMapper::FeedState()
+				const std::vector<EventType> events{ Key(BTN_CODE_A, 1), Report(), Key(BTN_CODE_A, 0), Report() };
+				const auto* bytes = reinterpret_cast<const char*>(events.data());
+				const size_t size = events.size() * sizeof(EventType);
+				//an event split across writes is reassembled
+				Assert::IsTrue(write(ends[1], bytes, 30) == 30);
+				std::this_thread::sleep_for(milliseconds(5));
+				Assert::IsTrue(write(ends[1], bytes + 30, size - 30) == static_cast<ssize_t>(size - 30));
+				close(ends[1]);
+				const auto deadline = steady_clock::now() + seconds(5);
+				while (!source.IsEndOfStream() && steady_clock::now() < deadline)
+					std::this_thread::sleep_for(milliseconds(1));
+				Assert::IsTrue(source.IsEndOfStream());
+				Assert::IsFalse(source.IsRunning());
+				Assert::AreEqual(source.GetFrameCount(), size_t{ 2 });
+				Assert::AreEqual(source.GetUpdatedState().dwPacketNumber, DWORD{ 2 });
+			}
+			close(ends[0]);
+			Assert::AreEqual(frames.size(), size_t{ 2 });
+			sds::KeystrokeSynthesizer synthesizer;
+			std::vector<XINPUT_KEYSTROKE> strokes;
+			for (const auto& frame : frames)
+				synthesizer.ProcessState(frame, {}, [&strokes](const XINPUT_KEYSTROKE& stroke) { strokes.push_back(stroke); });
+			Assert::AreEqual(strokes.size(), size_t{ 2 });
+			Assert::AreEqual(static_cast<int>(strokes[0].VirtualKey), VK_PAD_A);
+			Assert::IsTrue(strokes[0].Flags & XINPUT_KEYSTROKE_KEYDOWN);
+			Assert::IsTrue(strokes[1].Flags & XINPUT_KEYSTROKE_KEYUP);
+			Logger::WriteMessage("End TestPipeSource()");
+		}
+		TEST_METHOD(TestStopWhileWaiting)
+		{
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestStopWhileWaiting()");
+			std::array<int, 2> ends{};
+			Assert::IsTrue(pipe(ends.data()) == 0);
+			{
+				sds::EvdevInputSource source(ends[0], {});
+				for (int i = 0; i < 2; i++)
+				{
+					std::this_thread::sleep_for(milliseconds(5));
+					//no event arrives, the blocked worker is woken by the stop
+					const auto start = steady_clock::now();
+					source.Stop();
+					Assert::IsFalse(source.IsRunning());
+					Assert::IsTrue(steady_clock::now() - start < seconds(1));
+					source.Start();
+					Assert::IsTrue(source.IsRunning());
+				}
+			}
+			close(ends[0]);
+			close(ends[1]);
+			Logger::WriteMessage("End TestStopWhileWaiting()");
+		}
+#endif
+	private:
+		static EventType Key(const uint16_t code, const int32_t value) noexcept
+		{
+			return EventType{ 0, 0, sds::Evdev::EV_TYPE_KEY, code, value };
+		}
+		static EventType Abs(const uint16_t code, const int32_t value) noexcept
+		{
+			return EventType{ 0, 0, sds::Evdev::EV_TYPE_ABS, code, value };
+		}
+		static EventType Report() noexcept
+		{
+			return EventType{ 0, 0, sds::Evdev::EV_TYPE_SYN, sds::Evdev::SYN_CODE_REPORT, 0 };
+		}
+	};
+}
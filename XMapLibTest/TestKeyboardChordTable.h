@@ -0,0 +1,67 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/KeyboardChordTable.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	TEST_CLASS(TestKeyboardChordTable)
+	{
+		static sds::ControllerBits::MaskType Bit(const int vk)
+		{
+			return sds::ControllerBits::ToMask(sds::ControllerBits::GetBitIndex(vk));
+		}
+		static sds::ControllerBits::MaskType Chord(const int index)
+		{
+			return sds::ControllerBits::ToMask(sds::ControllerBits::USED_BIT_COUNT + index);
+		}
+	public:
+		TEST_METHOD(TestResolveChords)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestResolveChords()");
+			const auto lb = Bit(VK_PAD_LSHOULDER);
+			const auto a = Bit(VK_PAD_A);
+			const auto b = Bit(VK_PAD_B);
+			const auto x = Bit(VK_PAD_X);
+			const auto y = Bit(VK_PAD_Y);
+			KeyboardChordTable table;
+			//chord 0: LB+A, chord 1: LB+A+B, chord 2: X+Y
+			Assert::IsTrue(table.Compile({ lb | a, lb | a | b, x | y }).empty());
+			Assert::AreEqual(table.GetTableSize(), size_t{ 1 } << 5);
+			ControllerBits::MaskType latched = 0;
+			//single inputs pass through
+			Assert::IsTrue(table.Apply(a, latched) == a);
+			//LB+A replaced by chord 0
+			Assert::IsTrue(table.Apply(lb | a, latched) == Chord(0));
+			//larger chord wins, disjoint chord active at the same time, unrelated input passes through
+			const auto dpad = Bit(VK_PAD_DPAD_UP);
+			Assert::IsTrue(table.Apply(lb | a | b | x | y | dpad, latched) == (Chord(1) | Chord(2) | dpad));
+			//releasing B falls back to chord 0, X and Y released
+			Assert::IsTrue(table.Apply(lb | a, latched) == Chord(0));
+			//releasing A leaves LB suppressed until it is released
+			Assert::IsTrue(table.Apply(lb, latched) == 0);
+			Assert::IsTrue(table.Apply(0, latched) == 0);
+			Assert::IsTrue(table.Apply(lb, latched) == lb);
+			Logger::WriteMessage("End TestResolveChords()");
+		}
+		TEST_METHOD(TestCompileErrors)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestCompileErrors()");
+			KeyboardChordTable table;
+			const auto a = Bit(VK_PAD_A);
+			const auto b = Bit(VK_PAD_B);
+			Assert::IsFalse(table.Compile({ a }).empty(), L"Single input chord.");
+			Assert::IsFalse(table.Compile({ a | b, a | b }).empty(), L"Duplicate chord.");
+			Assert::IsFalse(table.Compile({ a | Chord(0) }).empty(), L"Synthesized input in chord.");
+			//the whole used mask is too many distinct inputs
+			Assert::IsFalse(table.Compile({ ControllerBits::USED_MASK }).empty(), L"Too many inputs.");
+			//failed compile leaves an empty table usable
+			ControllerBits::MaskType latched = 0;
+			Assert::IsTrue(table.Apply(a | b, latched) == (a | b));
+			Logger::WriteMessage("End TestCompileErrors()");
+		}
+	};
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/KeyboardTranslator.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	using TemplatesForTest::MakeStroke;
+	TEST_CLASS(TestKeyboardTranslator)
+	{
+		using InpType = sds::KeyboardKeyMap::ActionType;
+	public:
+		TEST_METHOD(TestMapState)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestMapState()");
+			KeyboardTranslator translator;
+			std::vector<std::pair<int, bool>> events;
+			translator.SetKeySink([&events](const int vk, const bool keyDown) { events.emplace_back(vk, keyDown); });
+			const std::chrono::high_resolution_clock::time_point start{};
+			Assert::IsFalse(translator.AddKeyMap(KeyboardKeyMap{ 0, VK_SPACE, false }).empty());
+			Assert::IsTrue(translator.AddKeyMap(KeyboardKeyMap{ VK_PAD_A, VK_SPACE, false }).empty());
+			Assert::IsTrue(translator.AddKeyMap(KeyboardKeyMap{ VK_PAD_B, 0x42, true }).empty());
+			translator.ProcessKeystroke(MakeStroke(VK_PAD_B, XINPUT_KEYSTROKE_KEYDOWN), start);
+			auto maps = translator.GetMaps();
+			Assert::AreEqual(maps.size(), size_t{ 2 });
+			Assert::AreEqual(maps[0].SendingElementVK, static_cast<int>(VK_PAD_A));
+			Assert::AreEqual(maps[1].MappedToVK, 0x42);
+			Assert::IsTrue(maps[1].UsesRepeat);
+			Assert::IsTrue(maps[0].LastAction == InpType::NONE);
+			Assert::IsTrue(maps[1].LastAction == InpType::KEYDOWN);
+			//a key without repeat is reset on the next keystroke after the key-up
+			translator.ProcessKeystroke(MakeStroke(VK_PAD_A, XINPUT_KEYSTROKE_KEYDOWN), start);
+			translator.ProcessKeystroke(MakeStroke(VK_PAD_A, XINPUT_KEYSTROKE_KEYUP), start);
+			Assert::IsTrue(translator.GetMaps()[0].LastAction == InpType::KEYUP);
+			translator.ProcessKeystroke(XINPUT_KEYSTROKE{}, start);
+			Assert::IsTrue(translator.GetMaps()[0].LastAction == InpType::NONE);
+			translator.CleanupInProgressEvents();
+			Assert::IsTrue(translator.GetMaps()[1].LastAction == InpType::KEYUP);
+			const std::vector<std::pair<int, bool>> expected{ { 0x42, true }, { VK_SPACE, true }, { VK_SPACE, false }, { 0x42, false } };
+			Assert::IsTrue(events == expected, L"Expected each map's key-down and key-up, and the held key released by the cleanup.");
+			translator.ClearMaps();
+			Assert::IsTrue(translator.GetMaps().empty());
+			Logger::WriteMessage("End TestMapState()");
+		}
+		TEST_METHOD(TestOvertaking)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestOvertaking()");
+			KeyboardTranslator translator;
+			std::vector<std::pair<int, bool>> events;
+			translator.SetKeySink([&events](const int vk, const bool keyDown) { events.emplace_back(vk, keyDown); });
+			const std::chrono::high_resolution_clock::time_point start{};
+			Assert::IsTrue(translator.AddKeyMap(KeyboardKeyMap{ VK_PAD_LTHUMB_UP, 0x57, true }).empty());
+			Assert::IsTrue(translator.AddKeyMap(KeyboardKeyMap{ VK_PAD_LTHUMB_RIGHT, 0x44, true }).empty());
+			Assert::IsTrue(translator.AddKeyMap(KeyboardKeyMap{ VK_PAD_RTHUMB_UP, 0x49, true }).empty());
+			translator.ProcessKeystroke(MakeStroke(VK_PAD_LTHUMB_UP, XINPUT_KEYSTROKE_KEYDOWN), start);
+			translator.ProcessKeystroke(MakeStroke(VK_PAD_RTHUMB_UP, XINPUT_KEYSTROKE_KEYDOWN), start);
+			//another direction of the same stick releases the held one, the other stick is unaffected
+			translator.ProcessKeystroke(MakeStroke(VK_PAD_LTHUMB_RIGHT, XINPUT_KEYSTROKE_KEYDOWN), start);
+			const auto maps = translator.GetMaps();
+			Assert::IsTrue(maps[0].LastAction == InpType::KEYUP, L"Expected the overtaken direction to be released.");
+			Assert::IsTrue(maps[1].LastAction == InpType::NONE);
+			Assert::IsTrue(maps[2].LastAction == InpType::KEYDOWN);
+			const std::vector<std::pair<int, bool>> expected{ { 0x57, true }, { 0x49, true }, { 0x57, false } };
+			Assert::IsTrue(events == expected, L"Expected only 'w' released, and 'i' held.");
+			translator.CleanupInProgressEvents();
+			Assert::AreEqual(events.size(), size_t{ 4 });
+			Assert::IsTrue(events[3] == std::pair{ 0x49, false });
+			Logger::WriteMessage("End TestOvertaking()");
+		}
+		TEST_METHOD(TestSharedKeyState)
+		{
+			using namespace sds;
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestSharedKeyState()");
+			KeyboardTranslator translator;
+			std::vector<std::pair<int, bool>> events;
+			translator.SetKeySink([&events](const int vk, const bool keyDown) { events.emplace_back(vk, keyDown); });
+			Assert::IsTrue(translator.AddKeyMap(KeyboardKeyMap{ VK_PAD_LTHUMB_UPLEFT, 0x57, true }).empty());
+			Assert::IsTrue(translator.AddKeyMap(KeyboardKeyMap{ VK_PAD_LTHUMB_UPLEFT, 0x41, true }).empty());
+			Assert::IsTrue(translator.AddKeyMap(KeyboardKeyMap{ VK_PAD_A, 0x57, true }).empty());
+			const high_resolution_clock::time_point start{};
+			//two maps holding 'w', it is sent down by the first and up by the last
+			translator.ProcessKeystroke(MakeStroke(VK_PAD_LTHUMB_UPLEFT, XINPUT_KEYSTROKE_KEYDOWN), start);
+			translator.ProcessKeystroke(MakeStroke(VK_PAD_A, XINPUT_KEYSTROKE_KEYDOWN), start);
+			Assert::AreEqual(events.size(), size_t{ 2 });
+			Assert::AreEqual(static_cast<int>(translator.GetKeyHolderCount(0x57)), 2);
+			//held keys are repeated once each, not once per map
+			translator.ProcessKeystroke(XINPUT_KEYSTROKE{}, start + microseconds(KeyboardSettings::MICROSECONDS_DELAY_KEYREPEAT + 1));
+			Assert::AreEqual(events.size(), size_t{ 4 });
+			Assert::IsTrue(events[2].second && events[3].second && events[2].first != events[3].first);
+			const auto later = start + microseconds(KeyboardSettings::MICROSECONDS_DELAY_KEYREPEAT + 2);
+			translator.ProcessKeystroke(MakeStroke(VK_PAD_A, XINPUT_KEYSTROKE_KEYUP), later);
+			Assert::AreEqual(events.size(), size_t{ 4 }, L"Expected 'w' to stay down while another map holds it.");
+			translator.ProcessKeystroke(MakeStroke(VK_PAD_LTHUMB_UPLEFT, XINPUT_KEYSTROKE_KEYUP), later);
+			Assert::AreEqual(events.size(), size_t{ 6 });
+			Assert::IsTrue(!events[4].second && !events[5].second);
+			Assert::AreEqual(static_cast<int>(translator.GetKeyHolderCount(0x57)), 0);
+			Assert::AreEqual(static_cast<int>(translator.GetKeyHolderCount(0x41)), 0);
+			Logger::WriteMessage("End TestSharedKeyState()");
+		}
+		TEST_METHOD(TestKeyStateTable)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestKeyStateTable()");
+			KeyStateTable table;
+			Assert::IsTrue(table.Press(VK_SPACE));
+			Assert::IsFalse(table.Press(VK_SPACE));
+			Assert::IsTrue(table.IsDown(VK_SPACE));
+			Assert::IsFalse(table.Release(VK_SPACE));
+			Assert::IsTrue(table.Release(VK_SPACE));
+			Assert::IsFalse(table.Release(VK_SPACE), L"Expected a release of an unheld key not to be sent.");
+			//untracked keys are passed through
+			Assert::IsTrue(table.Press(0x1FF));
+			Assert::IsTrue(table.Press(0x1FF));
+			Assert::IsTrue(table.Release(0x1FF));
+			Assert::IsTrue(table.Press(VK_SHIFT));
+			table.Clear();
+			Assert::IsFalse(table.IsDown(VK_SHIFT));
+			Logger::WriteMessage("End TestKeyStateTable()");
+		}
+	};
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/KeystrokeSynthesizer.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	TEST_CLASS(TestKeystrokeSynthesizer)
+	{
+		inline static constexpr const short SMax = std::numeric_limits<SHORT>::max();
+	public:
+		TEST_METHOD(TestDownRepeatUp)
+		{
+			using namespace sds;
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestDownRepeatUp()");
+			KeystrokeSynthesizer synth(1);
+			std::vector<XINPUT_KEYSTROKE> strokes;
+			auto collect = [&strokes](const XINPUT_KEYSTROKE& s) { strokes.push_back(s); };
+			const auto start = KeystrokeSynthesizer::ClockType::now();
+			const auto repeatDelay = microseconds(KeyboardSettings::MICROSECONDS_DELAY_KEYREPEAT);
+			XINPUT_STATE state{};
+			state.Gamepad.wButtons = XINPUT_GAMEPAD_A;
+			//press
+			Assert::AreEqual(synth.ProcessState(state, start, collect), size_t{ 1 });
+			Assert::AreEqual(static_cast<int>(strokes.back().VirtualKey), VK_PAD_A);
+			Assert::AreEqual(static_cast<int>(strokes.back().Flags), XINPUT_KEYSTROKE_KEYDOWN);
+			Assert::AreEqual(static_cast<int>(strokes.back().UserIndex), 1);
+			//held, before the repeat delay nothing is emitted
+			Assert::AreEqual(synth.ProcessState(state, start + repeatDelay / 2, collect), size_t{ 0 });
+			//held past the repeat delay
+			Assert::AreEqual(synth.ProcessState(state, start + repeatDelay, collect), size_t{ 1 });
+			Assert::AreEqual(static_cast<int>(strokes.back().Flags), XINPUT_KEYSTROKE_KEYDOWN | XINPUT_KEYSTROKE_REPEAT);
+			//release
+			state.Gamepad.wButtons = 0;
+			Assert::AreEqual(synth.ProcessState(state, start + repeatDelay * 2, collect), size_t{ 1 });
+			Assert::AreEqual(static_cast<int>(strokes.back().VirtualKey), VK_PAD_A);
+			Assert::AreEqual(static_cast<int>(strokes.back().Flags), XINPUT_KEYSTROKE_KEYUP);
+			Logger::WriteMessage("End TestDownRepeatUp()");
+		}
+		TEST_METHOD(TestStickDirectionChange)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestStickDirectionChange()");
+			KeystrokeSynthesizer synth;
+			std::vector<XINPUT_KEYSTROKE> strokes;
+			auto collect = [&strokes](const XINPUT_KEYSTROKE& s) { strokes.push_back(s); };
+			const auto now = KeystrokeSynthesizer::ClockType::now();
+			XINPUT_STATE state{};
+			state.Gamepad.sThumbLY = SMax;
+			synth.ProcessState(state, now, collect);
+			state.Gamepad.sThumbLX = SMax;
+			strokes.clear();
+			//up to up-right is the release of up, then the press of up-right
+			Assert::AreEqual(synth.ProcessState(state, now, collect), size_t{ 2 });
+			Assert::AreEqual(static_cast<int>(strokes[0].VirtualKey), VK_PAD_LTHUMB_UP);
+			Assert::AreEqual(static_cast<int>(strokes[0].Flags), XINPUT_KEYSTROKE_KEYUP);
+			Assert::AreEqual(static_cast<int>(strokes[1].VirtualKey), VK_PAD_LTHUMB_UPRIGHT);
+			Assert::AreEqual(static_cast<int>(strokes[1].Flags), XINPUT_KEYSTROKE_KEYDOWN);
+			Logger::WriteMessage("End TestStickDirectionChange()");
+		}
+		TEST_METHOD(TestChordWindow)
+		{
+			using namespace sds;
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestChordWindow()");
+			const auto bit = [](const int vk) { return ControllerBits::ToMask(ControllerBits::GetBitIndex(vk)); };
+			auto table = std::make_shared<KeyboardChordTable>();
+			Assert::IsTrue(table->Compile({ bit(VK_PAD_LSHOULDER) | bit(VK_PAD_A) }).empty());
+			const int chordVk = ControllerBits::GetVirtualKey(ControllerBits::USED_BIT_COUNT);
+			const microseconds window{ KeyboardSettings::MICROSECONDS_CHORD_WINDOW };
+			KeystrokeSynthesizer synth;
+			synth.SetChordTable(table);
+			std::vector<std::pair<int, WORD>> strokes;
+			auto collect = [&strokes](const XINPUT_KEYSTROKE& s) { strokes.emplace_back(s.VirtualKey, s.Flags); };
+			const KeystrokeSynthesizer::PointInTime start{};
+			XINPUT_STATE state{};
+			//A pressed just before LB is held back, only the chord is sent
+			state.Gamepad.wButtons = XINPUT_GAMEPAD_A;
+			Assert::AreEqual(synth.ProcessState(state, start, collect), size_t{ 0 });
+			state.Gamepad.wButtons = XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_LEFT_SHOULDER;
+			synth.ProcessState(state, start + window / 2, collect);
+			state.Gamepad.wButtons = 0;
+			synth.ProcessState(state, start + window, collect);
+			const std::vector<std::pair<int, WORD>> chordOnly{ { chordVk, XINPUT_KEYSTROKE_KEYDOWN }, { chordVk, XINPUT_KEYSTROKE_KEYUP } };
+			Assert::IsTrue(strokes == chordOnly);
+			//A held alone is sent once the window has passed
+			strokes.clear();
+			const auto later = start + seconds(1);
+			state.Gamepad.wButtons = XINPUT_GAMEPAD_A;
+			Assert::AreEqual(synth.ProcessState(state, later, collect), size_t{ 0 });
+			Assert::AreEqual(synth.ProcessState(state, later + window, collect), size_t{ 1 });
+			Assert::IsTrue(strokes.back() == std::pair<int, WORD>{ VK_PAD_A, XINPUT_KEYSTROKE_KEYDOWN });
+			state.Gamepad.wButtons = 0;
+			synth.ProcessState(state, later + window * 2, collect);
+			//A tapped within the window is a press, then a release on the next state
+			strokes.clear();
+			const auto tap = start + seconds(2);
+			state.Gamepad.wButtons = XINPUT_GAMEPAD_A;
+			synth.ProcessState(state, tap, collect);
+			state.Gamepad.wButtons = 0;
+			synth.ProcessState(state, tap + window / 4, collect);
+			synth.ProcessState(state, tap + window / 2, collect);
+			const std::vector<std::pair<int, WORD>> tapped{ { VK_PAD_A, XINPUT_KEYSTROKE_KEYDOWN }, { VK_PAD_A, XINPUT_KEYSTROKE_KEYUP } };
+			Assert::IsTrue(strokes == tapped);
+			//without a window A is sent first, then released for the chord
+			strokes.clear();
+			synth.SetChordWindow(microseconds(0));
+			const auto noWindow = start + seconds(3);
+			state.Gamepad.wButtons = XINPUT_GAMEPAD_A;
+			synth.ProcessState(state, noWindow, collect);
+			state.Gamepad.wButtons = XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_LEFT_SHOULDER;
+			synth.ProcessState(state, noWindow + window / 2, collect);
+			const std::vector<std::pair<int, WORD>> aFirst{ { VK_PAD_A, XINPUT_KEYSTROKE_KEYDOWN }, { VK_PAD_A, XINPUT_KEYSTROKE_KEYUP }, { chordVk, XINPUT_KEYSTROKE_KEYDOWN } };
+			Assert::IsTrue(strokes == aFirst);
+			Logger::WriteMessage("End TestChordWindow()");
+		}
+	};
+}
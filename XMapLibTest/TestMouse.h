@@ -28,5 +28,82 @@ namespace XMapLibTest
 			Assert::IsFalse(mouse.SetSensitivity(IntMin).empty());
 
 		}
+		TEST_METHOD(TestRuntimeSettings)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestRuntimeSettings()");
+			MouseMapper mapper;
+			//the mover loop spins, it isn't given a raised priority unless asked for
+			Assert::IsTrue(mapper.GetMoverThreadPolicy().IsDefault());
+			mapper.SetStick(StickMap::RIGHT_STICK);
+			Assert::IsTrue(mapper.IsRunning());
+			//settings are published to the running worker, without a restart
+			Assert::IsTrue(mapper.SetAxisSensitivity(20, 80).empty());
+			Assert::AreEqual(mapper.GetSensitivity(), 20);
+			Assert::AreEqual(mapper.GetSensitivityY(), 80);
+			Assert::IsTrue(mapper.SetDeadzones(StickMap::RIGHT_STICK, 5000, 6000).empty());
+			Assert::AreEqual(mapper.GetPlayerInfo().right_y_dz.load(), 6000);
+			Assert::IsTrue(mapper.SetResponseCurve(ResponseCurve::Exponential(2.0f)).empty());
+			Assert::IsTrue(mapper.IsRunning());
+			//bad values are rejected and change nothing
+			Assert::IsFalse(mapper.SetAxisSensitivity(20, 101).empty());
+			Assert::AreEqual(mapper.GetSensitivityY(), 80);
+			Assert::IsFalse(mapper.SetDeadzones(StickMap::NEITHER_STICK, 5000, 5000).empty());
+			Assert::IsFalse(mapper.SetDeadzones(StickMap::LEFT_STICK, 0, 5000).empty());
+			Assert::IsFalse(mapper.SetResponseCurve(ResponseCurve::SCurve(0.0f)).empty());
+			Assert::IsTrue(WaitForMover(mapper, true), L"Expected the mover to run with a stick set.");
+			//no stick stops the mover thread, the poller and worker keep running for the state listener
+			mapper.SetStick(StickMap::NEITHER_STICK);
+			Assert::IsTrue(mapper.GetStick() == StickMap::NEITHER_STICK);
+			Assert::IsTrue(WaitForMover(mapper, false), L"Expected the mover to stop without a stick.");
+			Assert::IsTrue(mapper.IsRunning());
+			mapper.SetStick(StickMap::LEFT_STICK);
+			Assert::IsTrue(mapper.GetStick() == StickMap::LEFT_STICK);
+			Assert::IsTrue(WaitForMover(mapper, true));
+			mapper.Stop();
+			Assert::IsFalse(mapper.IsRunning());
+			Assert::IsFalse(mapper.IsMoverRunning());
+			Logger::WriteMessage("End TestRuntimeSettings()");
+		}
+		TEST_METHOD(TestAddedSticks)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestAddedSticks()");
+			MouseMapper mapper;
+			mapper.SetStick(StickMap::RIGHT_STICK);
+			MousePlayerInfo secondPlayer;
+			secondPlayer.player_id = 1;
+			//the other stick of the same player, and a stick of another player, in the same worker loop
+			Assert::IsTrue(mapper.AddStick(MousePlayerInfo{}, StickMap::LEFT_STICK, [](int, int) {}).empty());
+			Assert::IsTrue(mapper.AddStick(secondPlayer, StickMap::RIGHT_STICK, [](int, int) {}).empty());
+			Assert::IsFalse(mapper.AddStick(secondPlayer, StickMap::RIGHT_STICK).empty(), L"Expected a duplicate stick to be rejected.");
+			Assert::IsFalse(mapper.AddStick(MousePlayerInfo{}, StickMap::RIGHT_STICK).empty(), L"Expected the main stick to be rejected.");
+			Assert::IsFalse(mapper.AddStick(secondPlayer, StickMap::NEITHER_STICK).empty());
+			secondPlayer.left_y_dz = 0;
+			Assert::IsFalse(mapper.AddStick(secondPlayer, StickMap::LEFT_STICK).empty());
+			const auto added = mapper.GetAddedSticks();
+			Assert::AreEqual(added.size(), size_t{ 2 });
+			Assert::AreEqual(added[1].Player.player_id.load(), 1);
+			//settings changes and restarts apply to the added sticks too
+			Assert::IsTrue(mapper.SetSensitivity(70).empty());
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			mapper.Stop();
+			mapper.Start();
+			Assert::IsTrue(mapper.IsRunning());
+			mapper.ClearAddedSticks();
+			Assert::IsTrue(mapper.GetAddedSticks().empty());
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			mapper.Stop();
+			Logger::WriteMessage("End TestAddedSticks()");
+		}
+	private:
+		/// <summary>Waits for the worker to apply the stick setting, and start or stop the mover.</summary>
+		static bool WaitForMover(const sds::MouseMapper& mapper, const bool isRunning)
+		{
+			const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+			while (mapper.IsMoverRunning() != isRunning && std::chrono::steady_clock::now() < deadline)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			return mapper.IsMoverRunning() == isRunning;
+		}
 	};
 }
@@ -0,0 +1,121 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/ThumbstickFilter.h"
+#include "../XMapLib/PipelineSimulator.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	TEST_CLASS(TestOneEuroFilter)
+	{
+		using ParamType = sds::Utilities::OneEuroFilter::Parameters;
+		static constexpr float SampleSeconds{ 0.001f }; // 1 kHz
+	public:
+		TEST_METHOD(TestParameters)
+		{
+			Logger::WriteMessage("Begin TestParameters()");
+			Assert::IsTrue(sds::ThumbstickFilter::DefaultParameters().Validate().empty());
+			Assert::IsFalse(ParamType{ 0.0f, 1.0f, 1.0f }.Validate().empty());
+			Assert::IsFalse(ParamType{ 1.0f, -1.0f, 1.0f }.Validate().empty());
+			Assert::IsFalse(ParamType{ 1.0f, 1.0f, std::numeric_limits<float>::quiet_NaN() }.Validate().empty());
+			sds::Utilities::OneEuroFilter filter;
+			Assert::AreEqual(filter.Filter(0.5f, SampleSeconds), 0.5f, L"Expected the first sample to pass through.");
+			filter.Reset();
+			Assert::AreEqual(filter.Filter(-0.25f, SampleSeconds), -0.25f, L"Expected the first sample after a reset to pass through.");
+			Logger::WriteMessage("End TestParameters()");
+		}
+		TEST_METHOD(TestJitterReduced)
+		{
+			Logger::WriteMessage("Begin TestJitterReduced()");
+			//a still stick at the deadzone edge, with +-1% noise, the cursor twitch follows the sample to sample change
+			sds::Utilities::OneEuroFilter filter(sds::ThumbstickFilter::DefaultParameters());
+			constexpr float center{ 0.24f };
+			constexpr float noise{ 0.01f };
+			unsigned seed = 1;
+			float lastSample = center;
+			float lastOut = filter.Filter(center, SampleSeconds);
+			float sampleChange = 0.0f;
+			float outChange = 0.0f;
+			for (int i = 0; i < 2000; i++)
+			{
+				seed = seed * 1103515245u + 12345u;
+				const float sample = center + ((seed >> 16) & 1 ? noise : -noise);
+				const float out = filter.Filter(sample, SampleSeconds);
+				sampleChange += std::abs(sample - lastSample);
+				outChange += std::abs(out - lastOut);
+				lastSample = sample;
+				lastOut = out;
+			}
+			Assert::IsTrue(outChange < 0.05f * sampleChange, L"Expected the filter to remove most of the jitter.");
+			Assert::IsTrue(std::abs(lastOut - center) < noise);
+			Logger::WriteMessage("End TestJitterReduced()");
+		}
+		TEST_METHOD(TestFastMotionTracked)
+		{
+			Logger::WriteMessage("Begin TestFastMotionTracked()");
+			//a flick from rest to full deflection, the adaptive cutoff should follow much faster than a fixed one
+			const int adaptiveMs = MillisecondsToReach(sds::ThumbstickFilter::DefaultParameters(), 1.0f, 0.9f);
+			const int fixedMs = MillisecondsToReach(ParamType{ sds::MouseSettings::STICK_FILTER_MIN_CUTOFF_DEFAULT, 0.0f, sds::MouseSettings::STICK_FILTER_DCUTOFF_DEFAULT }, 1.0f, 0.9f);
+			Logger::WriteMessage(("Adaptive ms: " + std::to_string(adaptiveMs) + " fixed ms: " + std::to_string(fixedMs)).c_str());
+			Assert::IsTrue(adaptiveMs <= 25, L"Expected a flick to be tracked within a few frames.");
+			Assert::IsTrue(adaptiveMs * 4 < fixedMs);
+			Logger::WriteMessage("End TestFastMotionTracked()");
+		}
+		TEST_METHOD(TestStickRange)
+		{
+			Logger::WriteMessage("Begin TestStickRange()");
+			sds::ThumbstickFilter filter;
+			constexpr SHORT SMax = std::numeric_limits<SHORT>::max();
+			constexpr SHORT SMin = std::numeric_limits<SHORT>::min();
+			auto out = filter.Process(SMin, SMax, SampleSeconds);
+			Assert::AreEqual(out.X, SMin);
+			Assert::AreEqual(out.Y, SMax);
+			for (int i = 0; i < 1000; i++)
+				out = filter.Process(SMax, SMin, SampleSeconds);
+			Assert::AreEqual(out.X, SMax);
+			Assert::AreEqual(out.Y, SMin);
+			Logger::WriteMessage("End TestStickRange()");
+		}
+		TEST_METHOD(TestSimulatedDeadzoneEdge)
+		{
+			Logger::WriteMessage("Begin TestSimulatedDeadzoneEdge()");
+			//a stick resting at the deadzone edge with jitter across it moves the cursor unless filtered
+			const auto unfiltered = RunDeadzoneEdge(std::nullopt);
+			const auto filtered = RunDeadzoneEdge(sds::ThumbstickFilter::DefaultParameters());
+			Logger::WriteMessage(("Moves unfiltered: " + std::to_string(unfiltered) + " filtered: " + std::to_string(filtered)).c_str());
+			Assert::IsTrue(unfiltered > 0);
+			Assert::AreEqual(filtered, size_t{ 0 }, L"Expected the filtered stick to stay inside the deadzone.");
+			Logger::WriteMessage("End TestSimulatedDeadzoneEdge()");
+		}
+	private:
+		/// <summary>Steps the filter from rest to the target, returns the milliseconds until the output reaches the fraction of it.</summary>
+		static int MillisecondsToReach(const ParamType& params, const float target, const float fraction)
+		{
+			sds::Utilities::OneEuroFilter filter(params);
+			filter.Filter(0.0f, SampleSeconds);
+			for (int i = 1; i < 10000; i++)
+			{
+				if (filter.Filter(target, SampleSeconds) >= target * fraction)
+					return i;
+			}
+			return std::numeric_limits<int>::max();
+		}
+		/// <summary>Runs a second of jitter around the right stick's X deadzone, returns the mouse move count.</summary>
+		static size_t RunDeadzoneEdge(const std::optional<ParamType>& params)
+		{
+			using namespace std::chrono;
+			sds::PipelineSimulator sim;
+			Assert::IsTrue(sim.SetStickFilter(params).empty());
+			const int deadzone = sds::MousePlayerInfo{}.right_x_dz;
+			XINPUT_STATE state{};
+			for (int i = 0; i < 1000; i++)
+			{
+				state.Gamepad.sThumbRX = static_cast<SHORT>(i & 1 ? deadzone + 300 : deadzone - 500);
+				sim.SetState(state);
+				sim.RunFor(milliseconds(1));
+			}
+			return sim.GetMoveEventCount();
+		}
+	};
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/PipelineSimulator.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	TEST_CLASS(TestPipelineSimulator)
+	{
+		using EventType = sds::PipelineSimulator::OutputEvent::EventType;
+		static constexpr SHORT SMax = std::numeric_limits<SHORT>::max();
+	public:
+		TEST_METHOD(TestDeterministicRun)
+		{
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestDeterministicRun()");
+			//ten minutes of scripted input, twice
+			sds::PipelineSimulator first;
+			sds::PipelineSimulator second;
+			RunScript(first, minutes(10));
+			RunScript(second, minutes(10));
+			Assert::IsTrue(first.GetElapsed() == minutes(10));
+			Assert::IsTrue(first.GetKeyEventCount() > 0);
+			Assert::IsTrue(first.GetMoveEventCount() > 0);
+			Assert::AreEqual(first.GetKeyEventCount(), second.GetKeyEventCount());
+			Assert::AreEqual(first.GetMoveEventCount(), second.GetMoveEventCount());
+			Assert::AreEqual(first.GetOutputHash(), second.GetOutputHash(), L"Expected identical output for identical input.");
+			Logger::WriteMessage("End TestDeterministicRun()");
+		}
+		TEST_METHOD(TestKeyRepeatTiming)
+		{
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestKeyRepeatTiming()");
+			sds::PipelineSimulator sim({}, sds::MouseSettings::SENSITIVITY_DEFAULT, sds::StickMap::NEITHER_STICK);
+			Assert::IsTrue(sim.AddKeyMap(sds::KeyboardKeyMap{ VK_PAD_A, VK_SPACE, true }).empty());
+			std::vector<sds::PipelineSimulator::OutputEvent> events;
+			sim.SetOutputSink([&events](const auto& e) { events.push_back(e); });
+			XINPUT_STATE state{};
+			state.Gamepad.wButtons = XINPUT_GAMEPAD_A;
+			sim.SetState(state);
+			sim.RunFor(seconds(1));
+			sim.SetState(XINPUT_STATE{});
+			sim.RunFor(milliseconds(10));
+			Assert::IsTrue(events.size() > 2);
+			Assert::IsTrue(events.front().Type == EventType::KEY_DOWN && events.front().Time.count() == 0);
+			Assert::IsTrue(events.back().Type == EventType::KEY_UP && events.back().Time == seconds(1));
+			//repeats at the first poll past the repeat delay
+			const microseconds expectedInterval{ sds::KeyboardSettings::MICROSECONDS_DELAY_KEYREPEAT + sds::MouseSettings::MICROSECONDS_POLLER_FAST };
+			for (size_t i = 1; i + 1 < events.size(); i++)
+			{
+				Assert::IsTrue(events[i].Type == EventType::KEY_DOWN);
+				Assert::IsTrue(events[i].Time - events[i - 1].Time == expectedInterval);
+			}
+			Logger::WriteMessage("End TestKeyRepeatTiming()");
+		}
+		TEST_METHOD(TestMoverTiming)
+		{
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestMoverTiming()");
+			sds::PipelineSimulator sim;
+			sds::PipelineSimulator resetSim;
+			sim.SetMoverTimingMode(sds::MouseMoveThread::TimingMode::ADVANCE_DEADLINE);
+			std::vector<sds::PipelineSimulator::OutputEvent> events;
+			std::vector<sds::PipelineSimulator::OutputEvent> resetEvents;
+			sim.SetOutputSink([&events](const auto& e) { events.push_back(e); });
+			resetSim.SetOutputSink([&resetEvents](const auto& e) { resetEvents.push_back(e); });
+			XINPUT_STATE state{};
+			state.Gamepad.sThumbRX = SMax;
+			sim.SetState(state);
+			resetSim.SetState(state);
+			sim.RunFor(seconds(1));
+			resetSim.RunFor(seconds(1));
+			const sds::ThumbstickProcessor stick(sds::MouseSettings::SENSITIVITY_DEFAULT, sds::MouseSettings::SENSITIVITY_DEFAULT, {}, sds::StickMap::RIGHT_STICK);
+			const auto delay = static_cast<microseconds::rep>(stick.Process(state).XDelay);
+			//the mover's first delay starts with the mover
+			constexpr microseconds::rep firstMove{ sds::MouseSettings::MICROSECONDS_MAX };
+			Assert::AreEqual(events.size(), static_cast<size_t>((1'000'000 - firstMove + delay - 1) / delay), L"Expected one move per delay, independent of the poll interval.");
+			for (size_t i = 0; i < events.size(); i++)
+			{
+				Assert::IsTrue(events[i].Type == EventType::MOUSE_MOVE && events[i].X == 1 && events[i].Y == 0);
+				Assert::AreEqual(events[i].Time.count(), firstMove + static_cast<microseconds::rep>(i) * delay);
+			}
+			//restarting each delay when the move is sent is never early, and falls behind
+			Assert::IsTrue(!resetEvents.empty() && resetEvents.size() <= events.size());
+			Assert::IsTrue(resetEvents.front().Time == events.front().Time);
+			for (size_t i = 1; i < resetEvents.size(); i++)
+				Assert::IsTrue((resetEvents[i].Time - resetEvents[i - 1].Time).count() >= delay);
+			Logger::WriteMessage("End TestMoverTiming()");
+		}
+	private:
+		/// <summary>Cycles through button presses, chorded buttons and thumbstick sweeps.</summary>
+		static void RunScript(sds::PipelineSimulator& sim, const std::chrono::microseconds duration)
+		{
+			using namespace std::chrono;
+			Assert::IsTrue(sim.AddKeyMap(sds::KeyboardKeyMap{ VK_PAD_A, VK_SPACE, false }).empty());
+			Assert::IsTrue(sim.AddKeyMap(sds::KeyboardKeyMap{ VK_PAD_B, 0x42, true }).empty());
+			Assert::IsTrue(sim.AddKeyMap(sds::KeyboardKeyMap{ VK_PAD_LTHUMB_UP, 0x57, true }).empty());
+			Assert::IsTrue(sim.AddKeyMap(sds::KeyboardKeyMap{ VK_PAD_LTHUMB_RIGHT, 0x44, true }).empty());
+			constexpr milliseconds stepTime{ 250 };
+			constexpr int stepCount = 16;
+			for (int step = 0; sim.GetElapsed() < duration; step = (step + 1) % stepCount)
+			{
+				XINPUT_STATE state{};
+				state.Gamepad.wButtons = static_cast<WORD>((step & 1 ? XINPUT_GAMEPAD_A : 0) | (step & 4 ? XINPUT_GAMEPAD_B : 0));
+				state.Gamepad.sThumbLY = step & 2 ? SMax : 0;
+				state.Gamepad.sThumbLX = step & 8 ? SMax : 0;
+				state.Gamepad.sThumbRX = static_cast<SHORT>(SMax / stepCount * step);
+				state.Gamepad.sThumbRY = static_cast<SHORT>(-SMax / stepCount * (stepCount - step));
+				sim.SetState(state);
+				sim.RunFor(std::min<microseconds>(stepTime, duration - sim.GetElapsed()));
+			}
+		}
+	};
+}
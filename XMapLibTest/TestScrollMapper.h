@@ -0,0 +1,59 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/ScrollMapper.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	TEST_CLASS(TestScrollMapper)
+	{
+		static constexpr int Deadzone = XINPUT_GAMEPAD_RIGHT_THUMB_DEADZONE;
+		static constexpr SHORT SMax = std::numeric_limits<SHORT>::max();
+	public:
+		TEST_METHOD(TestAccumulateScroll)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestAccumulateScroll()");
+			//a quarter of a wheel unit per tick at full deflection
+			const std::vector<float> rateTable = ScrollMapper::BuildRateTable(ResponseCurve::Linear(), 0.25f);
+			Assert::AreEqual(rateTable.size(), ScrollMapper::RATE_TABLE_SIZE);
+			Assert::AreEqual(rateTable.front(), 0.0f, L"Expected no scrolling at the deadzone edge.");
+			Assert::AreEqual(rateTable.back(), 0.25f);
+			float accumulator = 0.0f;
+			int total = 0;
+			for (int i = 0; i < 8; i++)
+				total += ScrollMapper::AccumulateScroll(SMax, Deadzone, rateTable, accumulator);
+			Assert::AreEqual(total, 2, L"Expected fractional deltas to accumulate into whole units.");
+			//negative deflection scrolls the other way
+			total = 0;
+			for (int i = 0; i < 8; i++)
+				total += ScrollMapper::AccumulateScroll(-SMax, Deadzone, rateTable, accumulator);
+			Assert::AreEqual(total, -2);
+			//inside the deadzone nothing is sent and the remainder is dropped
+			accumulator = 0.75f;
+			Assert::AreEqual(ScrollMapper::AccumulateScroll(Deadzone / 2, Deadzone, rateTable, accumulator), 0);
+			Assert::AreEqual(accumulator, 0.0f);
+			//an empty table, as from a bad curve, never scrolls
+			Assert::AreEqual(ScrollMapper::AccumulateScroll(SMax, Deadzone, {}, accumulator), 0);
+			Logger::WriteMessage("End TestAccumulateScroll()");
+		}
+		TEST_METHOD(TestScrollSettings)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestScrollSettings()");
+			ScrollMapper scroller;
+			Assert::IsTrue(scroller.SetScrollSpeed(MouseSettings::SCROLL_SPEED_MAX).empty());
+			Assert::AreEqual(scroller.GetScrollSpeed(), MouseSettings::SCROLL_SPEED_MAX);
+			Assert::IsFalse(scroller.SetScrollSpeed(MouseSettings::SCROLL_SPEED_MIN - 1).empty());
+			Assert::IsFalse(scroller.SetResponseCurve(ResponseCurve::Exponential(0.0f)).empty());
+			//fed from another poller's state listener, no polling thread of its own
+			scroller.SetStick(StickMap::RIGHT_STICK);
+			Assert::IsTrue(scroller.IsRunning());
+			scroller.FeedState(XINPUT_STATE{});
+			scroller.SetStick(StickMap::NEITHER_STICK);
+			Assert::IsFalse(scroller.IsRunning());
+			Logger::WriteMessage("End TestScrollSettings()");
+		}
+	};
+}
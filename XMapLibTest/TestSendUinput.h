@@ -0,0 +1,191 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/SendUinput.h"
+#include "../XMapLib/KeyboardMapper.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	TEST_CLASS(TestSendUinput)
+	{
+		using EventType = sds::Evdev::EvdevEvent;
+	public:
+		TEST_METHOD(TestKeyTable)
+		{
+			using namespace sds::Evdev;
+			Logger::WriteMessage("Begin TestKeyTable()");
+			Assert::AreEqual(static_cast<int>(ToEvdevKeyCode(VK_SPACE)), 57);
+			Assert::AreEqual(static_cast<int>(ToEvdevKeyCode(VK_LEFT)), 105);
+			Assert::AreEqual(static_cast<int>(ToEvdevKeyCode(VK_LBUTTON)), static_cast<int>(BTN_CODE_LEFT));
+			Assert::AreEqual(static_cast<int>(ToEvdevKeyCode(0x51)), 16, L"Expected 'Q' to map to KEY_Q.");
+			Assert::AreEqual(static_cast<int>(ToEvdevKeyCode(-1)), 0);
+			Assert::AreEqual(static_cast<int>(ToEvdevKeyCode(0x1FF)), 0);
+			//no two keys send the same code, except the generic and left modifiers
+			std::map<uint16_t, int> seen;
+			for (int vk = 0; vk < 256; vk++)
+			{
+				const uint16_t code = ToEvdevKeyCode(vk);
+				if (code != 0)
+					seen[code]++;
+			}
+			for (const auto& [code, count] : seen)
+				Assert::IsTrue(count == 1 || code == 42 || code == 29 || code == 56);
+			Logger::WriteMessage("End TestKeyTable()");
+		}
+#ifdef __linux__
+		TEST_METHOD(TestBatchedWrite)
+		{
+			using namespace sds::Evdev;
+			Logger::WriteMessage("Begin TestBatchedWrite()");
+			const Pipe pipeEnds;
+			sds::Utilities::SendUinput sender(pipeEnds.Write);
+			//a move and key changes in one tick are one write, with one SYN_REPORT
+			sender.QueueMouseMove(3, -2);
+			sender.QueueKey(0x57, true);
+			sender.QueueKey(VK_SHIFT, false);
+			sender.QueueKey(0x07, true); //no evdev code, not sent
+			Assert::IsTrue(sender.Flush());
+			Assert::IsTrue(sender.Flush(), L"Expected an empty flush to succeed without writing.");
+			Assert::AreEqual(sender.GetWriteCount(), size_t{ 1 });
+			auto events = pipeEnds.ReadEvents(5);
+			Assert::AreEqual(events.size(), size_t{ 5 });
+			Assert::IsTrue(IsEvent(events[0], EV_TYPE_REL, REL_CODE_X, 3));
+			Assert::IsTrue(IsEvent(events[1], EV_TYPE_REL, REL_CODE_Y, -2));
+			Assert::IsTrue(IsEvent(events[2], EV_TYPE_KEY, 17, 1));
+			Assert::IsTrue(IsEvent(events[3], EV_TYPE_KEY, 42, 0));
+			Assert::IsTrue(IsEvent(events[4], EV_TYPE_SYN, SYN_CODE_REPORT, 0));
+			//a move on one axis only sends that axis
+			sender.SendMouseMove(0, 1);
+			events = pipeEnds.ReadEvents(2);
+			Assert::IsTrue(IsEvent(events[0], EV_TYPE_REL, REL_CODE_Y, 1));
+			Assert::AreEqual(sender.GetWriteCount(), size_t{ 2 });
+			//a full batch is written early
+			for (size_t i = 0; i < sds::Utilities::SendUinput::MAX_BATCH_EVENTS + 1; i++)
+				sender.QueueMouseMove(1, 0);
+			sender.Flush();
+			Assert::AreEqual(sender.GetWriteCount(), size_t{ 4 });
+			events = pipeEnds.ReadEvents(sds::Utilities::SendUinput::MAX_BATCH_EVENTS + 3);
+			Assert::IsTrue(IsEvent(events[sds::Utilities::SendUinput::MAX_BATCH_EVENTS], EV_TYPE_SYN, SYN_CODE_REPORT, 0));
+			Logger::WriteMessage("End TestBatchedWrite()");
+		}
+		TEST_METHOD(TestWheel)
+		{
+			using namespace sds::Evdev;
+			Logger::WriteMessage("Begin TestWheel()");
+			const Pipe pipeEnds;
+			sds::Utilities::SendUinput sender(pipeEnds.Write);
+			//high resolution units are sent as is, a notch event once a notch has accumulated
+			sender.SendMouseWheel(60);
+			auto events = pipeEnds.ReadEvents(2);
+			Assert::IsTrue(IsEvent(events[0], EV_TYPE_REL, REL_CODE_WHEEL_HI_RES, 60));
+			Assert::IsTrue(IsEvent(events[1], EV_TYPE_SYN, SYN_CODE_REPORT, 0));
+			sender.SendMouseWheel(60);
+			events = pipeEnds.ReadEvents(3);
+			Assert::IsTrue(IsEvent(events[1], EV_TYPE_REL, REL_CODE_WHEEL, 1));
+			sender.SendMouseWheel(-240, true);
+			events = pipeEnds.ReadEvents(3);
+			Assert::IsTrue(IsEvent(events[0], EV_TYPE_REL, REL_CODE_HWHEEL_HI_RES, -240));
+			Assert::IsTrue(IsEvent(events[1], EV_TYPE_REL, REL_CODE_HWHEEL, -2));
+			Logger::WriteMessage("End TestWheel()");
+		}
+		TEST_METHOD(TestMapperFlush)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestMapperFlush()");
+			const Pipe pipeEnds;
+			Utilities::SendUinput sender(pipeEnds.Write);
+			KeyboardMapper mapper(KeyboardPlayerInfo{}, KeystrokeSource::STATE_FEED);
+			Assert::IsTrue(mapper.AddMap(KeyboardKeyMap{ VK_PAD_A, 0x57, false }).empty());
+			Assert::IsTrue(mapper.AddMap(KeyboardKeyMap{ VK_PAD_B, 0x41, false }).empty());
+			//the sink is applied by the worker, install it while stopped so the first state fed is processed with it
+			mapper.Stop();
+			mapper.SetKeySink([&sender](const int vk, const bool down) { sender.QueueKey(vk, down); }, [&sender]() { sender.Flush(); });
+			mapper.Start();
+			XINPUT_STATE state{};
+			state.Gamepad.wButtons = XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_B;
+			mapper.FeedState(state);
+			//both key-downs of the tick in one write
+			const auto events = pipeEnds.ReadEvents(3);
+			Assert::AreEqual(events.size(), size_t{ 3 });
+			Assert::IsTrue(events[0].Type == Evdev::EV_TYPE_KEY && events[1].Type == Evdev::EV_TYPE_KEY);
+			Assert::IsTrue(IsEvent(events[2], Evdev::EV_TYPE_SYN, Evdev::SYN_CODE_REPORT, 0));
+			Assert::AreEqual(sender.GetWriteCount(), size_t{ 1 });
+			mapper.Stop();
+			Logger::WriteMessage("End TestMapperFlush()");
+		}
+		TEST_METHOD(TestMapperDefaultFlush)
+		{
+			using namespace sds;
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestMapperDefaultFlush()");
+			const auto& shared = Utilities::SendUinput::GetShared();
+			KeyboardMapper mapper(KeyboardPlayerInfo{}, KeystrokeSource::STATE_FEED);
+			//F23 and F24, harmless where the shared device exists
+			Assert::IsTrue(mapper.AddMap(KeyboardKeyMap{ VK_PAD_A, 0x86, false }).empty());
+			Assert::IsTrue(mapper.AddMap(KeyboardKeyMap{ VK_PAD_B, 0x87, false }).empty());
+			//restarted so the maps are applied before the first state fed
+			mapper.Stop();
+			mapper.Start();
+			const size_t before = shared.GetWriteCount();
+			XINPUT_STATE state{};
+			state.Gamepad.wButtons = XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_B;
+			mapper.FeedState(state);
+			const auto deadline = steady_clock::now() + seconds(5);
+			while (shared.GetWriteCount() == before && steady_clock::now() < deadline)
+				std::this_thread::sleep_for(milliseconds(1));
+			//a few more ticks, nothing else to write
+			std::this_thread::sleep_for(milliseconds(KeyboardSettings::THREAD_DELAY_POLLER * 3));
+			//both key-downs of the tick queued to the shared device and written together
+			Assert::AreEqual(shared.GetWriteCount(), before + 1);
+			//the key-ups sent when stopping are written together
+			mapper.Stop();
+			Assert::AreEqual(shared.GetWriteCount(), before + 2);
+			Logger::WriteMessage("End TestMapperDefaultFlush()");
+		}
+	private:
+		/// <summary>A pipe standing in for the uinput device, the read end is non-blocking.</summary>
+		struct Pipe
+		{
+			int Read{ -1 };
+			int Write{ -1 };
+			Pipe()
+			{
+				std::array<int, 2> ends{};
+				Assert::IsTrue(pipe(ends.data()) == 0);
+				Read = ends[0];
+				Write = ends[1];
+				fcntl(Read, F_SETFL, O_NONBLOCK);
+			}
+			Pipe(const Pipe& other) = delete;
+			Pipe& operator=(const Pipe& other) = delete;
+			~Pipe()
+			{
+				close(Read);
+				close(Write);
+			}
+			[[nodiscard]] std::vector<EventType> ReadEvents(const size_t count) const
+			{
+				std::vector<EventType> events(count);
+				auto* bytes = reinterpret_cast<char*>(events.data());
+				size_t received = 0;
+				const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+				while (received < count * sizeof(EventType) && std::chrono::steady_clock::now() < deadline)
+				{
+					const ssize_t n = read(Read, bytes + received, count * sizeof(EventType) - received);
+					if (n > 0)
+						received += static_cast<size_t>(n);
+					else
+						std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+				events.resize(received / sizeof(EventType));
+				return events;
+			}
+		};
+#endif
+		static bool IsEvent(const EventType& ev, const uint16_t type, const uint16_t code, const int32_t value) noexcept
+		{
+			return ev.Type == type && ev.Code == code && ev.Value == value;
+		}
+	};
+}
@@ -55,6 +55,34 @@ namespace XMapLibTest
 			TestAndPrint(1, DELAY_MAX, L"[TEST3]");
 			Logger::WriteMessage("End TestSensitivityMinimum()");
 		}
+		TEST_METHOD(TestBuildTable)
+		{
+			using namespace sds;
+			using namespace std;
+			Logger::WriteMessage("Begin TestBuildTable()");
+			SensitivityMapper mp;
+			//linear table matches the map
+			const map<int, int> sensMap = mp.BuildSensitivityMap(50, SENS_MIN, SENS_MAX, DELAY_MIN, DELAY_MAX, DELAY_MINMAX);
+			const vector<int> linear = mp.BuildSensitivityTable(50, ResponseCurve::Linear(), SENS_MIN, SENS_MAX, DELAY_MIN, DELAY_MAX, DELAY_MINMAX);
+			Assert::AreEqual(linear.size(), static_cast<size_t>(SENS_MAX - SENS_MIN + 1));
+			for (const auto& [key, delay] : sensMap)
+				Assert::AreEqual(linear[static_cast<size_t>(key - SENS_MIN)], delay);
+			const vector<ResponseCurve> curves{ ResponseCurve::Exponential(2.0f), ResponseCurve::SCurve(8.0f),
+				ResponseCurve::Piecewise({ {0.5f, 0.2f}, {0.8f, 0.5f} }) };
+			for (const auto& curve : curves)
+			{
+				const vector<int> table = mp.BuildSensitivityTable(50, curve, SENS_MIN, SENS_MAX, DELAY_MIN, DELAY_MAX, DELAY_MINMAX);
+				Assert::AreEqual(table.front(), DELAY_MAX);
+				Assert::AreEqual(table.back(), mp.SensitivityToMinimum(50, SENS_MIN, SENS_MAX, DELAY_MIN, DELAY_MINMAX), L"Expected the adjusted minimum at full deflection.");
+				//slower than linear at quarter deflection, and never faster as the stick moves further
+				Assert::IsTrue(table[SENS_MAX / 4] > linear[SENS_MAX / 4]);
+				Assert::IsTrue(std::ranges::is_sorted(table, std::greater<>{}), L"Expected a non-increasing delay table.");
+			}
+			Assert::AreEqual(ResponseCurve::Piecewise({ {0.5f, 0.2f} }).Evaluate(0.75f), 0.6f, 0.0001f);
+			Assert::IsFalse(ResponseCurve::Piecewise({ {0.5f, 0.2f}, {0.4f, 0.5f} }).Validate().empty());
+			Assert::IsFalse(ResponseCurve::Exponential(-1.0f).Validate().empty());
+			Logger::WriteMessage("End TestBuildTable()");
+		}
 	};
 }
 
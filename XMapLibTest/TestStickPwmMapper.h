@@ -0,0 +1,213 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/StickPwmMapper.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	TEST_CLASS(TestStickPwmMapper)
+	{
+		using ClockType = std::chrono::steady_clock;
+		struct KeyEvent
+		{
+			int VK{ 0 };
+			bool IsDown{ false };
+			ClockType::time_point Time{};
+		};
+		/// <summary>Records the key events sent on the timer thread.</summary>
+		struct KeyRecorder
+		{
+			std::mutex Mutex{};
+			std::vector<KeyEvent> Events{};
+			[[nodiscard]] sds::StickPwmMapper::KeySinkType GetSink()
+			{
+				return [this](const int vk, const bool isDown)
+				{
+					std::lock_guard eventsLock(Mutex);
+					Events.push_back(KeyEvent{ vk, isDown, ClockType::now() });
+				};
+			}
+			[[nodiscard]] std::vector<KeyEvent> GetEvents()
+			{
+				std::lock_guard eventsLock(Mutex);
+				return Events;
+			}
+		};
+	public:
+		TEST_METHOD(TestDutyTable)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestDutyTable()");
+			StickPwmMap map;
+			map.PositiveVK = 0x57;
+			map.Deadzone = 8000;
+			map.DutySteps = 100;
+			const auto duty = StickPwmMapper::BuildDutyTable(map);
+			Assert::AreEqual(StickPwmMapper::GetDutyStep(duty, 0), 0);
+			Assert::AreEqual(StickPwmMapper::GetDutyStep(duty, -7900), 0, L"Expected no output inside the deadzone.");
+			Assert::AreEqual(StickPwmMapper::GetDutyStep(duty, 8100), 1, L"Expected one step just past the deadzone.");
+			Assert::AreEqual(StickPwmMapper::GetDutyStep(duty, 32767), 100);
+			Assert::AreEqual(StickPwmMapper::GetDutyStep(duty, -32768), 100);
+			Assert::IsTrue(std::abs(StickPwmMapper::GetDutyStep(duty, 20384) - 50) <= 1);
+			Assert::IsTrue(std::is_sorted(duty.begin(), duty.end()), L"Expected the duty to rise with the deflection.");
+			//a curve gives finer control at slight deflection
+			map.Curve = ResponseCurve::Exponential(2.0f);
+			const auto curved = StickPwmMapper::BuildDutyTable(map);
+			Assert::IsTrue(std::abs(StickPwmMapper::GetDutyStep(curved, 20384) - 25) <= 1);
+			Logger::WriteMessage("End TestDutyTable()");
+		}
+		TEST_METHOD(TestPwmMapErrors)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestPwmMapErrors()");
+			StickPwmMapper mapper(nullptr, [](int, bool) {});
+			StickPwmMap map;
+			Assert::IsFalse(mapper.AddMap(map).empty(), L"Expected a map without a VK to be rejected.");
+			map.NegativeVK = 0x53;
+			map.DutySteps = 1;
+			Assert::IsFalse(mapper.AddMap(map).empty());
+			map.DutySteps = KeyboardSettings::PWM_DUTY_STEPS;
+			map.PeriodMicroseconds = KeyboardSettings::PWM_PERIOD_MIN_MICROSECONDS - 1;
+			Assert::IsFalse(mapper.AddMap(map).empty());
+			map.PeriodMicroseconds = KeyboardSettings::PWM_PERIOD_MICROSECONDS;
+			Assert::IsTrue(mapper.AddMap(map).empty());
+			Assert::IsFalse(mapper.AddMap(map).empty(), L"Expected a second map of the axis to be rejected.");
+			Assert::AreEqual(mapper.GetMaps().size(), size_t{ 1 });
+			mapper.ClearMaps();
+			Assert::IsTrue(mapper.GetMaps().empty());
+			Logger::WriteMessage("End TestPwmMapErrors()");
+		}
+		TEST_METHOD(TestDutyCycle)
+		{
+			using namespace sds;
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestDutyCycle()");
+			KeyRecorder recorder;
+			StickPwmMapper mapper(nullptr, recorder.GetSink());
+			StickPwmMap map;
+			map.Axis = StickPwmMap::AxisType::LEFT_Y;
+			map.PositiveVK = 0x57;
+			map.NegativeVK = 0x53;
+			map.Deadzone = 0;
+			map.PeriodMicroseconds = 20000;
+			map.DutySteps = 100;
+			Assert::IsTrue(mapper.AddMap(map).empty());
+			//a quarter deflection up holds 'w' for a quarter of each period
+			XINPUT_STATE state{};
+			state.Gamepad.sThumbLY = 8192;
+			mapper.FeedState(state);
+			std::this_thread::sleep_for(milliseconds(205));
+			state.Gamepad.sThumbLY = 0;
+			mapper.FeedState(state);
+			WaitForIdle(mapper);
+			const auto events = recorder.GetEvents();
+			Assert::IsTrue(events.size() >= 8 && events.size() % 2 == 0);
+			double heldUs = 0;
+			for (size_t i = 0; i + 1 < events.size(); i += 2)
+			{
+				Assert::IsTrue(events[i].VK == 0x57 && events[i].IsDown && events[i + 1].VK == 0x57 && !events[i + 1].IsDown);
+				heldUs += static_cast<double>(duration_cast<microseconds>(events[i + 1].Time - events[i].Time).count());
+			}
+			const double meanHeldUs = heldUs / static_cast<double>(events.size() / 2);
+			Assert::IsTrue(meanHeldUs > 3000.0 && meanHeldUs < 8000.0, L"Expected a hold near 5ms.");
+			//the periods are deadline based, the presses are a period apart on average
+			const double meanPeriodUs = static_cast<double>(duration_cast<microseconds>(events[events.size() - 2].Time - events[0].Time).count())
+				/ static_cast<double>(events.size() / 2 - 1);
+			Assert::IsTrue(std::abs(meanPeriodUs - 20000.0) < 2000.0);
+			Logger::WriteMessage("End TestDutyCycle()");
+		}
+		TEST_METHOD(TestFullDutyAndDirection)
+		{
+			using namespace sds;
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestFullDutyAndDirection()");
+			KeyRecorder recorder;
+			StickPwmMapper mapper(nullptr, recorder.GetSink());
+			StickPwmMap map;
+			map.Axis = StickPwmMap::AxisType::RIGHT_X;
+			map.PositiveVK = 0x44;
+			map.NegativeVK = 0x41;
+			map.PeriodMicroseconds = KeyboardSettings::PWM_PERIOD_MIN_MICROSECONDS;
+			Assert::IsTrue(mapper.AddMap(map).empty());
+			//full deflection holds the key through the periods
+			XINPUT_STATE state{};
+			state.Gamepad.sThumbRX = 32767;
+			mapper.FeedState(state);
+			std::this_thread::sleep_for(milliseconds(50));
+			Assert::AreEqual(recorder.GetEvents().size(), size_t{ 1 });
+			//the other direction releases the key first
+			state.Gamepad.sThumbRX = -32768;
+			mapper.FeedState(state);
+			std::this_thread::sleep_for(milliseconds(30));
+			state.Gamepad.sThumbRX = 0;
+			mapper.FeedState(state);
+			WaitForIdle(mapper);
+			const auto events = recorder.GetEvents();
+			Assert::AreEqual(events.size(), size_t{ 4 });
+			Assert::IsTrue(events[0].VK == 0x44 && events[0].IsDown);
+			Assert::IsTrue(events[1].VK == 0x44 && !events[1].IsDown);
+			Assert::IsTrue(events[2].VK == 0x41 && events[2].IsDown);
+			Assert::IsTrue(events[3].VK == 0x41 && !events[3].IsDown);
+			Logger::WriteMessage("End TestFullDutyAndDirection()");
+		}
+		TEST_METHOD(TestFourAxesScheduling)
+		{
+			using namespace sds;
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestFourAxesScheduling()");
+			KeyRecorder recorder;
+			StickPwmMapper mapper(nullptr, recorder.GetSink());
+			constexpr int PeriodUs{ KeyboardSettings::PWM_PERIOD_MIN_MICROSECONDS };
+			const std::array<StickPwmMap::AxisType, 4> axes{ StickPwmMap::AxisType::LEFT_X, StickPwmMap::AxisType::LEFT_Y, StickPwmMap::AxisType::RIGHT_X, StickPwmMap::AxisType::RIGHT_Y };
+			for (size_t i = 0; i < axes.size(); i++)
+			{
+				StickPwmMap map;
+				map.Axis = axes[i];
+				map.PositiveVK = 0x41 + static_cast<int>(i);
+				map.Deadzone = 0;
+				map.PeriodMicroseconds = PeriodUs;
+				map.DutySteps = KeyboardSettings::PWM_DUTY_STEPS_MAX;
+				Assert::IsTrue(mapper.AddMap(map).empty());
+			}
+			//a deflection toward a direction without a VK schedules nothing, checked while the timer thread is held
+			XINPUT_STATE state{};
+			state.Gamepad.sThumbLX = -30000;
+			state.Gamepad.sThumbRY = -30000;
+			size_t pendingUnmapped = 1;
+			mapper.GetTimerQueue()->RunAndWait(0, [&]()
+			{
+				mapper.FeedState(state);
+				pendingUnmapped = mapper.GetTimerQueue()->GetPendingCount();
+			});
+			Assert::AreEqual(pendingUnmapped, size_t{ 0 });
+			//the finest duty resolution still costs a press and a release per axis per period, and an idle axis costs nothing
+			state.Gamepad.sThumbLX = 12345;
+			state.Gamepad.sThumbLY = 23456;
+			state.Gamepad.sThumbRX = 3456;
+			state.Gamepad.sThumbRY = 30000;
+			const auto start = steady_clock::now();
+			mapper.FeedState(state);
+			std::this_thread::sleep_for(milliseconds(200));
+			mapper.FeedState(XINPUT_STATE{});
+			WaitForIdle(mapper);
+			const auto elapsedUs = duration_cast<microseconds>(steady_clock::now() - start).count();
+			const auto periods = static_cast<size_t>(elapsedUs / PeriodUs) + 2;
+			const auto events = recorder.GetEvents();
+			Assert::IsTrue(events.size() <= axes.size() * 2 * periods);
+			Assert::IsTrue(events.size() >= axes.size() * 2 * 10);
+			Assert::AreEqual(mapper.GetTimerQueue()->GetPendingCount(), size_t{ 0 });
+			Logger::WriteMessage("End TestFourAxesScheduling()");
+		}
+	private:
+		/// <summary>Waits for the outputs to stop and the keys to be released.</summary>
+		static void WaitForIdle(sds::StickPwmMapper& mapper)
+		{
+			const auto deadline = ClockType::now() + std::chrono::seconds(5);
+			while (mapper.GetTimerQueue()->GetPendingCount() != 0 && ClockType::now() < deadline)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			//the last period start may still be running
+			mapper.GetTimerQueue()->RunAndWait(0, []() {});
+		}
+	};
+}
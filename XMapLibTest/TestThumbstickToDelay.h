@@ -3,6 +3,7 @@
 #include "CppUnitTest.h"
 #include "TemplatesForTest.h"
 #include "../XMapLib/ThumbstickToDelay.h"
+#include "../XMapLib/ThumbstickProcessor.h"
 #include "../XMapLib/MouseSettings.h"
 
 namespace XMapLibTest
@@ -87,6 +88,58 @@ namespace XMapLibTest
 			testValues(temp, 0, true, usTemp,1500);
 			Logger::WriteMessage(std::wstring(L"End " + TestName).c_str());
 		}
+		TEST_METHOD(TestSeparateStickState)
+		{
+			const std::wstring TestName = L"TestSeparateStickState()";
+			Logger::WriteMessage(std::wstring(L"Begin " + TestName).c_str());
+			const sds::MousePlayerInfo pl;
+			const sds::ThumbstickProcessor first(Sens, Sens, pl, sds::StickMap::RIGHT_STICK);
+			const sds::ThumbstickProcessor second(Sens, Sens, pl, sds::StickMap::RIGHT_STICK);
+			//between the alternate and the normal deadzone, moves only once the deadzone is activated
+			const SHORT betweenDz = static_cast<SHORT>(DefaultDeadzone * 0.9);
+			Assert::IsTrue(first.Process(SMax, 0).IsXMoving);
+			Assert::IsTrue(first.IsDeadzoneActivated());
+			Assert::IsFalse(second.IsDeadzoneActivated(), L"Expected deadzone state to be per stick.");
+			Assert::IsTrue(first.Process(betweenDz, 0).IsXMoving);
+			Assert::IsFalse(second.Process(betweenDz, 0).IsXMoving);
+			//the X and Y axis share the state of their stick
+			Assert::IsTrue(first.Process(0, betweenDz).IsYMoving);
+			Assert::IsFalse(first.Process(0, 0).IsYMoving);
+			Assert::IsFalse(first.IsDeadzoneActivated());
+			Logger::WriteMessage(std::wstring(L"End " + TestName).c_str());
+		}
+		TEST_METHOD(TestSharedTables)
+		{
+			const std::wstring TestName = L"TestSharedTables()";
+			Logger::WriteMessage(std::wstring(L"Begin " + TestName).c_str());
+			sds::MousePlayerInfo pl;
+			const sds::ThumbstickToDelay xAxis(Sens, pl, sds::StickMap::RIGHT_STICK, true);
+			const sds::ThumbstickToDelay yAxis(Sens, pl, sds::StickMap::LEFT_STICK, false);
+			Assert::IsTrue(xAxis.GetSensitivityTable() == yAxis.GetSensitivityTable(), L"Expected equal settings to share one table.");
+			//deadzones don't change the table, a sensitivity or curve does
+			pl.right_x_dz = DefaultDeadzone / 2;
+			const sds::ThumbstickToDelay otherDeadzone(Sens, pl, sds::StickMap::RIGHT_STICK, true);
+			const sds::ThumbstickToDelay otherSens(Sens - 1, pl, sds::StickMap::RIGHT_STICK, true);
+			const sds::ThumbstickToDelay otherCurve(Sens, pl, sds::StickMap::RIGHT_STICK, true, sds::ResponseCurve::Exponential(2.0f));
+			Assert::IsTrue(otherDeadzone.GetSensitivityTable() == xAxis.GetSensitivityTable());
+			Assert::IsTrue(otherSens.GetSensitivityTable() != xAxis.GetSensitivityTable());
+			Assert::IsTrue(otherCurve.GetSensitivityTable() != xAxis.GetSensitivityTable());
+			Assert::IsTrue(*otherCurve.GetSensitivityTable() != *xAxis.GetSensitivityTable());
+			//a hit doesn't build, and an unused table is freed
+			auto& cache = sds::GetSensitivityTableCache();
+			const size_t builds = cache.GetBuildCount();
+			{
+				const sds::ThumbstickProcessor stick(Sens, Sens, pl, sds::StickMap::RIGHT_STICK);
+				Assert::AreEqual(cache.GetBuildCount(), builds);
+			}
+			std::weak_ptr<const sds::SensitivityTableCache::SensTableType> unused;
+			{
+				const sds::ThumbstickToDelay temporary(Sens - 2, pl, sds::StickMap::RIGHT_STICK, true);
+				unused = temporary.GetSensitivityTable();
+			}
+			Assert::IsTrue(unused.expired());
+			Logger::WriteMessage(std::wstring(L"End " + TestName).c_str());
+		}
 	};
 }
 
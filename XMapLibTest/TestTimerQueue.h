@@ -0,0 +1,83 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/TimerQueue.h"
+#include "../XMapLib/KeyboardMacroPlayer.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	TEST_CLASS(TestTimerQueue)
+	{
+	public:
+		TEST_METHOD(TestDeadlineOrder)
+		{
+			using namespace sds::Utilities;
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestDeadlineOrder()");
+			TimerQueue timer;
+			std::vector<int> order;
+			const auto start = TimerQueue::ClockType::now() + milliseconds(20);
+			//scheduled out of order, callbacks run one at a time so the vector needs no lock
+			timer.Schedule(start + milliseconds(10), 1, [&order]() { order.push_back(3); });
+			timer.Schedule(start, 1, [&order]() { order.push_back(1); });
+			timer.Schedule(start, 1, [&order]() { order.push_back(2); });
+			WaitForIdle(timer);
+			Assert::AreEqual(order.size(), size_t{ 3 });
+			Assert::AreEqual(order[0], 1);
+			Assert::AreEqual(order[1], 2, L"Expected equal deadlines to run in scheduling order.");
+			Assert::AreEqual(order[2], 3);
+			Logger::WriteMessage("End TestDeadlineOrder()");
+		}
+		TEST_METHOD(TestCancelGroup)
+		{
+			using namespace sds::Utilities;
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestCancelGroup()");
+			TimerQueue timer;
+			std::atomic<int> groupOneRuns{ 0 };
+			std::atomic<int> groupTwoRuns{ 0 };
+			for (int i = 0; i < 4; i++)
+			{
+				timer.ScheduleAfter(milliseconds(30), 1, [&groupOneRuns]() { ++groupOneRuns; });
+				timer.ScheduleAfter(milliseconds(30), 2, [&groupTwoRuns]() { ++groupTwoRuns; });
+			}
+			Assert::AreEqual(timer.Cancel(1), size_t{ 4 });
+			Assert::AreEqual(timer.Cancel(1), size_t{ 0 });
+			WaitForIdle(timer);
+			Assert::AreEqual(groupOneRuns.load(), 0);
+			Assert::AreEqual(groupTwoRuns.load(), 4);
+			Assert::AreEqual(timer.GetPendingCount(), size_t{ 0 });
+			Logger::WriteMessage("End TestCancelGroup()");
+		}
+		TEST_METHOD(TestMacroMapErrors)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestMacroMapErrors()");
+			KeyboardMacroPlayer player;
+			Assert::IsFalse(player.AddMacroMap(KeyboardMacroMap{ 0, { MacroStep::Down(0x43) } }).empty());
+			Assert::IsFalse(player.AddMacroMap(KeyboardMacroMap{ VK_PAD_Y, { MacroStep::Wait(1000) } }).empty(), L"Expected a macro without key steps to be rejected.");
+			Assert::IsFalse(player.AddMacroMap(KeyboardMacroMap{ VK_PAD_Y, { MacroStep::Down(0x1FF) } }).empty());
+			const KeyboardMacroMap ctrlC{ VK_PAD_Y, { MacroStep::Down(VK_CONTROL), MacroStep::Down(0x43), MacroStep::Wait(20000), MacroStep::Up(0x43), MacroStep::Up(VK_CONTROL) } };
+			Assert::IsTrue(player.AddMacroMap(ctrlC).empty());
+			Assert::IsFalse(player.AddMacroMap(ctrlC).empty(), L"Expected a second macro on the same button to be rejected.");
+			Assert::AreEqual(ctrlC.GetDurationUs(), size_t{ 20000 });
+			Assert::IsTrue(player.GetMacroMaps().front() == ctrlC);
+			//no timer queue set, one is created on the next use
+			player.SetTimerQueue(nullptr);
+			Assert::IsTrue(player.GetTimerQueue() != nullptr);
+			player.ClearMacroMaps();
+			Assert::IsTrue(player.GetMacroMaps().empty());
+			Logger::WriteMessage("End TestMacroMapErrors()");
+		}
+	private:
+		/// <summary>Waits for the pending entries to run, and for the last one to return.</summary>
+		static void WaitForIdle(sds::Utilities::TimerQueue& timer)
+		{
+			const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+			while (timer.GetPendingCount() != 0 && std::chrono::steady_clock::now() < deadline)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			timer.RunAndWait(0, []() {});
+		}
+	};
+}
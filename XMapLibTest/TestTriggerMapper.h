@@ -0,0 +1,119 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/TriggerMapper.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	TEST_CLASS(TestTriggerMapper)
+	{
+		/// <summary>Records the key events sent on the timer thread.</summary>
+		struct KeyRecorder
+		{
+			std::mutex Mutex{};
+			std::vector<std::pair<int, bool>> Events{};
+			[[nodiscard]] sds::TriggerMapper::KeySinkType GetSink()
+			{
+				return [this](const int vk, const bool isDown)
+				{
+					std::lock_guard eventsLock(Mutex);
+					Events.emplace_back(vk, isDown);
+				};
+			}
+			[[nodiscard]] std::vector<std::pair<int, bool>> GetEvents()
+			{
+				std::lock_guard eventsLock(Mutex);
+				return Events;
+			}
+		};
+		/// <returns>true if every event is of the key, alternating from a key-down, and ending released.</returns>
+		static bool IsBalancedTaps(const std::vector<std::pair<int, bool>>& events, const int vk)
+		{
+			for (size_t i = 0; i < events.size(); i++)
+			{
+				if (events[i].first != vk || events[i].second != (i % 2 == 0))
+					return false;
+			}
+			return events.size() % 2 == 0;
+		}
+	public:
+		TEST_METHOD(TestIntervalTable)
+		{
+			using namespace sds;
+			using namespace std::chrono;
+			Logger::WriteMessage("Begin TestIntervalTable()");
+			TriggerMap map;
+			map.MappedToVK = VK_LBUTTON;
+			map.Threshold = 30;
+			map.MinRate = 2.0f;
+			map.MaxRate = 20.0f;
+			map.Curve = ResponseCurve::Exponential(2.0f);
+			Assert::IsTrue(map.Validate().empty());
+			const auto intervals = TriggerMapper::BuildIntervalTable(map);
+			Assert::AreEqual(intervals[29].count(), microseconds::rep{ 0 }, L"Expected no output below the threshold.");
+			Assert::AreEqual(intervals[30].count(), microseconds::rep{ 500000 });
+			Assert::AreEqual(intervals[255].count(), microseconds::rep{ 50000 });
+			Assert::IsTrue(std::is_sorted(intervals.begin() + 30, intervals.end(), std::greater<>{}), L"Expected the rate to rise with the pull.");
+			Logger::WriteMessage("End TestIntervalTable()");
+		}
+		TEST_METHOD(TestTriggerMapErrors)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestTriggerMapErrors()");
+			KeyRecorder recorder;
+			TriggerMapper mapper(nullptr, recorder.GetSink());
+			TriggerMap map;
+			Assert::IsFalse(mapper.AddMap(map).empty(), L"Expected a key tap without a VK to be rejected.");
+			map.MappedToVK = 0x51;
+			map.MaxRate = KeyboardSettings::TRIGGER_RATE_MAX * 2.0f;
+			Assert::IsFalse(mapper.AddMap(map).empty());
+			map.MaxRate = 10.0f;
+			map.Threshold = 255;
+			Assert::IsFalse(mapper.AddMap(map).empty());
+			map.Threshold = 30;
+			Assert::IsTrue(mapper.AddMap(map).empty());
+			Assert::IsFalse(mapper.AddMap(map).empty(), L"Expected a second map on the same trigger to be rejected.");
+			//a pulled trigger starts the output, clearing stops it
+			XINPUT_STATE pulled{};
+			pulled.Gamepad.bRightTrigger = 255;
+			mapper.FeedState(pulled);
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			Assert::IsTrue(mapper.GetTimerQueue()->GetPendingCount() > 0);
+			mapper.ClearMaps();
+			Assert::AreEqual(mapper.GetTimerQueue()->GetPendingCount(), size_t{ 0 });
+			Assert::IsTrue(mapper.GetMaps().empty());
+			//the taps went to the sink, and the clear released the key
+			const auto events = recorder.GetEvents();
+			Assert::IsFalse(events.empty());
+			Assert::IsTrue(IsBalancedTaps(events, 0x51));
+			Logger::WriteMessage("End TestTriggerMapErrors()");
+		}
+		TEST_METHOD(TestClearWhileFiring)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestClearWhileFiring()");
+			KeyRecorder recorder;
+			TriggerMapper mapper(nullptr, recorder.GetSink());
+			TriggerMap map;
+			map.MappedToVK = 0x51;
+			map.Threshold = 30;
+			map.MinRate = KeyboardSettings::TRIGGER_RATE_MAX;
+			map.MaxRate = KeyboardSettings::TRIGGER_RATE_MAX;
+			XINPUT_STATE pulled{};
+			pulled.Gamepad.bRightTrigger = 255;
+			//a clear landing while the output fires leaves nothing scheduled for the removed map
+			for (int i = 0; i < 40; i++)
+			{
+				Assert::IsTrue(mapper.AddMap(map).empty());
+				mapper.FeedState(pulled);
+				std::this_thread::sleep_for(std::chrono::microseconds(500 * (i % 25)));
+				mapper.ClearMaps();
+				Assert::AreEqual(mapper.GetTimerQueue()->GetPendingCount(), size_t{ 0 });
+				Assert::IsTrue(IsBalancedTaps(recorder.GetEvents(), 0x51), L"Expected no key left down by a clear.");
+			}
+			Assert::IsFalse(recorder.GetEvents().empty());
+			Logger::WriteMessage("End TestClearWhileFiring()");
+		}
+	};
+}
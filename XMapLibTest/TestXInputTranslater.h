@@ -0,0 +1,93 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib/XInputTranslater.h"
+
+namespace XMapLibTest
+{
+	using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+	TEST_CLASS(TestXInputTranslater)
+	{
+		inline static constexpr const short SMax = std::numeric_limits<SHORT>::max();
+		inline static constexpr const short SMin = std::numeric_limits<SHORT>::min();
+		static XINPUT_STATE MakeState(const WORD buttons, const BYTE lt, const BYTE rt, const SHORT lx, const SHORT ly, const SHORT rx = 0, const SHORT ry = 0)
+		{
+			XINPUT_STATE state{};
+			state.Gamepad.wButtons = buttons;
+			state.Gamepad.bLeftTrigger = lt;
+			state.Gamepad.bRightTrigger = rt;
+			state.Gamepad.sThumbLX = lx;
+			state.Gamepad.sThumbLY = ly;
+			state.Gamepad.sThumbRX = rx;
+			state.Gamepad.sThumbRY = ry;
+			return state;
+		}
+		static bool HasVk(const sds::ControllerBits::MaskType mask, const int vk)
+		{
+			return (mask & sds::ControllerBits::ToMask(sds::ControllerBits::GetBitIndex(vk))) != 0;
+		}
+	public:
+		TEST_METHOD(TestProcessState)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestProcessState()");
+			const XInputTranslater translater;
+			//idle controller produces an empty mask
+			Assert::IsTrue(translater.ProcessState(MakeState(0, 0, 0, 0, 0)) == 0);
+			//buttons and triggers
+			const auto buttonMask = translater.ProcessState(MakeState(XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_LEFT_SHOULDER, 255, 10, 0, 0));
+			Assert::IsTrue(HasVk(buttonMask, VK_PAD_A));
+			Assert::IsTrue(HasVk(buttonMask, VK_PAD_LSHOULDER));
+			Assert::IsTrue(HasVk(buttonMask, VK_PAD_LTRIGGER));
+			Assert::IsFalse(HasVk(buttonMask, VK_PAD_RTRIGGER), L"Trigger below threshold should not be down.");
+			//thumbstick, one direction bit per stick
+			auto testDirection = [&translater](const SHORT x, const SHORT y, const int vk)
+			{
+				const auto mask = translater.ProcessState(MakeState(0, 0, 0, x, y, x, y));
+				const std::wstring msg = L"Tested X:" + std::to_wstring(x) + L" Y:" + std::to_wstring(y);
+				Assert::IsTrue(HasVk(mask, vk), msg.c_str());
+				Assert::IsTrue(std::popcount(mask & ControllerBits::LTHUMB_MASK) == 1, msg.c_str());
+				Assert::IsTrue(std::popcount(mask & ControllerBits::RTHUMB_MASK) == 1, msg.c_str());
+			};
+			testDirection(0, SMax, VK_PAD_LTHUMB_UP);
+			testDirection(0, SMin, VK_PAD_LTHUMB_DOWN);
+			testDirection(SMax, 0, VK_PAD_LTHUMB_RIGHT);
+			testDirection(SMin, 0, VK_PAD_LTHUMB_LEFT);
+			testDirection(SMin, SMax, VK_PAD_LTHUMB_UPLEFT);
+			testDirection(SMax, SMax, VK_PAD_LTHUMB_UPRIGHT);
+			testDirection(SMax, SMin, VK_PAD_LTHUMB_DOWNRIGHT);
+			testDirection(SMin, SMin, VK_PAD_LTHUMB_DOWNLEFT);
+			//within the deadzone
+			Assert::IsTrue(translater.ProcessState(MakeState(0, 0, 0, 1000, -1000, 1000, 1000)) == 0);
+			Logger::WriteMessage("End TestProcessState()");
+		}
+		TEST_METHOD(TestUpdateStateEdges)
+		{
+			using namespace sds;
+			Logger::WriteMessage("Begin TestUpdateStateEdges()");
+			XInputTranslater translater;
+			auto diff = translater.UpdateState(MakeState(XINPUT_GAMEPAD_A, 0, 0, 0, SMax));
+			Assert::IsTrue(HasVk(diff.Pressed, VK_PAD_A));
+			Assert::IsTrue(HasVk(diff.Pressed, VK_PAD_LTHUMB_UP));
+			Assert::IsTrue(diff.Released == 0);
+			//same state, no edges
+			diff = translater.UpdateState(MakeState(XINPUT_GAMEPAD_A, 0, 0, 0, SMax));
+			Assert::IsFalse(diff.IsChanged());
+			//stick moves to a diagonal, A released, B pressed
+			diff = translater.UpdateState(MakeState(XINPUT_GAMEPAD_B, 0, 0, SMax, SMax));
+			Assert::IsTrue(HasVk(diff.Released, VK_PAD_A));
+			Assert::IsTrue(HasVk(diff.Released, VK_PAD_LTHUMB_UP));
+			Assert::IsTrue(HasVk(diff.Pressed, VK_PAD_B));
+			Assert::IsTrue(HasVk(diff.Pressed, VK_PAD_LTHUMB_UPRIGHT));
+			Assert::IsTrue((diff.Pressed & diff.Released) == 0);
+			//bit to vk round trip for every used bit
+			for (int i = 0; i < ControllerBits::USED_BIT_COUNT; i++)
+			{
+				const int vk = ControllerBits::GetVirtualKey(i);
+				if (vk != 0)
+					Assert::AreEqual(ControllerBits::GetBitIndex(vk), i);
+			}
+			Logger::WriteMessage("End TestUpdateStateEdges()");
+		}
+	};
+}
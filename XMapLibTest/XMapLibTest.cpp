@@ -8,6 +8,23 @@
 #include "TestMouse.h"
 #include "TestThumbstickToDelay.h"
 #include "TestMapFunctions.h"
+#include "TestAdaptivePollDelay.h"
+#include "TestXInputTranslater.h"
+#include "TestKeystrokeSynthesizer.h"
+#include "TestKeyboardChordTable.h"
+#include "TestTimerQueue.h"
+#include "TestScrollMapper.h"
+#include "TestTriggerMapper.h"
+#include "TestAsyncLog.h"
+#include "TestAllocations.h"
+#include "TestKeyboardTranslator.h"
+#include "TestPipelineSimulator.h"
+#include "TestOneEuroFilter.h"
+#include "TestCPPRunner.h"
+#include "TestCommandQueue.h"
+#include "TestEvdev.h"
+#include "TestSendUinput.h"
+#include "TestStickPwmMapper.h"
 #include "../XMapLib/MouseSettings.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;